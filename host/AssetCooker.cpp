@@ -0,0 +1,242 @@
+#include "AssetPack.hpp"
+
+#include <png.h>
+
+#include <chrono>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+struct Asset {
+    std::string name;
+    Gfx::Texture* decoded;
+    AssetPack::Entry entry;
+};
+
+// Decode into an RGBA8 texture, RGB gets an opaque alpha
+static Gfx::Texture* DecodePNG(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return nullptr;
+    }
+
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png ? png_create_info_struct(png) : nullptr;
+    if (!info) {
+        png_destroy_read_struct(&png, nullptr, nullptr);
+        fclose(f);
+        return nullptr;
+    }
+
+    Gfx::Texture* tex = nullptr;
+    if (setjmp(png_jmpbuf(png))) {
+        if (tex) {
+            tex->Delete();
+        }
+        png_destroy_read_struct(&png, &info, nullptr);
+        fclose(f);
+        return nullptr;
+    }
+
+    png_init_io(png, f);
+    png_read_info(png, info);
+
+    png_uint_32 width = png_get_image_width(png, info);
+    png_uint_32 height = png_get_image_height(png, info);
+    if (png_get_color_type(png, info) == PNG_COLOR_TYPE_RGB) {
+        png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+    }
+
+    tex = Gfx::NewTexture(glm::uvec2(width, height));
+    if (tex) {
+        uint8_t* pixels = (uint8_t*) tex->Lock();
+        for (png_uint_32 y = 0; y < height; ++y) {
+            png_read_row(png, pixels + (y * tex->GetPitch() * 4), nullptr);
+        }
+        tex->Unlock();
+    }
+
+    png_destroy_read_struct(&png, &info, nullptr);
+    fclose(f);
+    return tex;
+}
+
+// File name without directory and extension
+static std::string AssetName(const char* path)
+{
+    std::string name = path;
+    size_t slash = name.find_last_of('/');
+    if (slash != std::string::npos) {
+        name = name.substr(slash + 1);
+    }
+
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos) {
+        name = name.substr(0, dot);
+    }
+    return name;
+}
+
+static uint32_t AlignUp(uint32_t value, uint32_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Map the pack like the game would and compare every texture against the decoded PNG
+static bool Verify(const char* path, std::vector<Asset> const& assets)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    fstat(fd, &st);
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    AssetPack pack;
+    auto start = std::chrono::steady_clock::now();
+    bool ok = pack.Open(data, st.st_size);
+    auto end = std::chrono::steady_clock::now();
+    if (!ok) {
+        fprintf(stderr, "Failed to open %s\n", path);
+    }
+
+    for (uint32_t i = 0; ok && i < assets.size(); ++i) {
+        Gfx::Texture* decoded = assets[i].decoded;
+        Gfx::Texture* tex = pack.GetTexture(assets[i].name.c_str());
+        if (!tex || tex->GetSize() != decoded->GetSize()) {
+            fprintf(stderr, "%s is missing from the pack\n", assets[i].name.c_str());
+            ok = false;
+            break;
+        }
+
+        // Textures point into the mapping
+        const uint8_t* pixels = (const uint8_t*) tex->Lock();
+        const uint8_t* expected = (const uint8_t*) decoded->Lock();
+        if (pixels != (const uint8_t*) data + AssetPack::SwapBE(assets[i].entry.offset)) {
+            fprintf(stderr, "%s was copied\n", assets[i].name.c_str());
+            ok = false;
+        }
+
+        for (uint32_t y = 0; ok && y < tex->GetSize().y; ++y) {
+            if (memcmp(pixels + y * tex->GetPitch() * 4, expected + y * decoded->GetPitch() * 4, tex->GetSize().x * 4) != 0) {
+                fprintf(stderr, "%s differs in row %u\n", assets[i].name.c_str(), y);
+                ok = false;
+            }
+        }
+    }
+
+    if (ok) {
+        printf("opened %u textures in %.1f us\n", pack.GetNumTextures(),
+            std::chrono::duration<double, std::micro>(end - start).count());
+    }
+
+    pack.Close();
+    munmap(data, st.st_size);
+    return ok;
+}
+
+// Cooks PNGs into a pack of surfaces in their final layout, see source/AssetPack.hpp
+int main(int argc, char const* argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <output.pak> <image.png>...\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Asset> assets;
+    for (int i = 2; i < argc; ++i) {
+        Asset asset;
+        asset.name = AssetName(argv[i]);
+        if (asset.name.size() >= AssetPack::MAX_NAME_LENGTH) {
+            fprintf(stderr, "Asset name %s is too long\n", asset.name.c_str());
+            return 1;
+        }
+
+        if (!(asset.decoded = DecodePNG(argv[i]))) {
+            fprintf(stderr, "Failed to decode %s\n", argv[i]);
+            return 1;
+        }
+        assets.push_back(asset);
+    }
+
+    // Header and index, then every surface aligned
+    uint32_t offset = AlignUp(sizeof(AssetPack::Header) + assets.size() * sizeof(AssetPack::Entry), AssetPack::SURFACE_ALIGNMENT);
+    for (Asset& asset : assets) {
+        glm::uvec2 size = asset.decoded->GetSize();
+        uint32_t pitch = AssetPack::CalcPitch(size.x);
+        uint32_t imageSize = pitch * size.y * 4;
+
+        AssetPack::Entry& entry = asset.entry;
+        memset(&entry, 0, sizeof(entry));
+        strncpy(entry.name, asset.name.c_str(), sizeof(entry.name) - 1);
+        entry.offset = AssetPack::SwapBE(offset);
+        entry.imageSize = AssetPack::SwapBE(imageSize);
+        entry.width = AssetPack::SwapBE(size.x);
+        entry.height = AssetPack::SwapBE(size.y);
+        entry.pitch = AssetPack::SwapBE(pitch);
+        entry.format = AssetPack::SwapBE(AssetPack::FORMAT_RGBA8);
+        entry.tileMode = AssetPack::SwapBE(AssetPack::TILE_MODE_LINEAR_ALIGNED);
+        entry.alignment = AssetPack::SwapBE(AssetPack::SURFACE_ALIGNMENT);
+
+        offset = AlignUp(offset + imageSize, AssetPack::SURFACE_ALIGNMENT);
+    }
+
+    std::vector<uint8_t> pack(offset, 0);
+    AssetPack::Header* header = (AssetPack::Header*) pack.data();
+    header->magic = AssetPack::SwapBE(AssetPack::MAGIC);
+    header->version = AssetPack::SwapBE(AssetPack::VERSION);
+    header->numEntries = AssetPack::SwapBE(assets.size());
+    header->size = AssetPack::SwapBE(pack.size());
+
+    AssetPack::Entry* entries = (AssetPack::Entry*) (header + 1);
+    for (uint32_t i = 0; i < assets.size(); ++i) {
+        entries[i] = assets[i].entry;
+
+        // Copy the rows into the surface pitch, padding stays zero
+        Gfx::Texture* decoded = assets[i].decoded;
+        uint8_t* dst = pack.data() + AssetPack::SwapBE(entries[i].offset);
+        const uint8_t* src = (const uint8_t*) decoded->Lock();
+        uint32_t pitch = AssetPack::SwapBE(entries[i].pitch);
+        for (uint32_t y = 0; y < decoded->GetSize().y; ++y) {
+            memcpy(dst + y * pitch * 4, src + y * decoded->GetPitch() * 4, decoded->GetSize().x * 4);
+        }
+
+        printf("%-24s %4ux%-4u pitch %4u %8u bytes\n", assets[i].name.c_str(),
+            decoded->GetSize().x, decoded->GetSize().y, pitch, AssetPack::SwapBE(entries[i].imageSize));
+    }
+
+    FILE* f = fopen(argv[1], "wb");
+    if (!f || fwrite(pack.data(), 1, pack.size(), f) != pack.size()) {
+        fprintf(stderr, "Failed to write %s\n", argv[1]);
+        if (f) {
+            fclose(f);
+        }
+        return 1;
+    }
+    fclose(f);
+    printf("wrote %s, %zu bytes\n", argv[1], pack.size());
+
+    bool ok = Verify(argv[1], assets);
+    for (Asset& asset : assets) {
+        asset.decoded->Delete();
+    }
+
+    if (!ok) {
+        unlink(argv[1]);
+        return 1;
+    }
+
+    return 0;
+}
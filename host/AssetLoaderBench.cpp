@@ -0,0 +1,142 @@
+#include "AssetLoader.hpp"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static const uint32_t ITERATIONS = 20;
+
+static double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool Check(bool condition, const char* what)
+{
+    printf("%-48s %s\n", what, condition ? "ok" : "FAILED");
+    return condition;
+}
+
+// Plain blocking reads of every file, what loading on the render thread would cost
+static double ReadBlocking(std::vector<std::string> const& paths, uint32_t* bytes)
+{
+    auto start = std::chrono::steady_clock::now();
+    *bytes = 0;
+    for (std::string const& path : paths) {
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) {
+            continue;
+        }
+
+        fseek(f, 0, SEEK_END);
+        std::vector<uint8_t> data(ftell(f));
+        fseek(f, 0, SEEK_SET);
+        *bytes += fread(data.data(), 1, data.size(), f);
+        fclose(f);
+    }
+    return Milliseconds(start);
+}
+
+// Streams the files given on the command line, usually the cooked pack and the source images
+int main(int argc, char const* argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <large file> <small file>...\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> paths(argv + 1, argv + argc);
+
+    AssetLoader loader;
+    if (!loader.Initialize()) {
+        fprintf(stderr, "Failed to start the loader\n");
+        return 1;
+    }
+
+    // Throughput against blocking reads, the files are in the page cache after the first pass
+    uint32_t bytes = 0;
+    double blockingMs = 0.0;
+    double streamingMs = 0.0;
+    double issueMs = 0.0;
+    for (uint32_t i = 0; i < ITERATIONS; ++i) {
+        blockingMs += ReadBlocking(paths, &bytes);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<AssetLoader::Request*> requests;
+        for (std::string const& path : paths) {
+            requests.push_back(loader.Load(path.c_str(), AssetLoader::PRIORITY_NORMAL));
+        }
+        issueMs += Milliseconds(start);
+
+        for (AssetLoader::Request* request : requests) {
+            loader.Wait(request);
+        }
+        streamingMs += Milliseconds(start);
+
+        for (AssetLoader::Request* request : requests) {
+            loader.Release(request);
+        }
+    }
+
+    double mb = bytes / (1024.0 * 1024.0);
+    printf("%u files, %.1f MB, %u iterations\n", argc - 1, mb, ITERATIONS);
+    printf("blocking reads   %8.2f ms  %8.1f MB/s\n", blockingMs / ITERATIONS, mb * ITERATIONS * 1000.0 / blockingMs);
+    printf("streaming        %8.2f ms  %8.1f MB/s, %.3f ms on the calling thread\n",
+        streamingMs / ITERATIONS, mb * ITERATIONS * 1000.0 / streamingMs, issueMs / ITERATIONS);
+
+    bool ok = true;
+
+    // A small high priority load overtakes a large low priority one queued before it
+    AssetLoader::Request* large = loader.Load(paths[0].c_str(), AssetLoader::PRIORITY_LOW);
+    AssetLoader::Request* small = loader.Load(paths[1].c_str(), AssetLoader::PRIORITY_HIGH);
+    auto start = std::chrono::steady_clock::now();
+    loader.Wait(small);
+    double smallMs = Milliseconds(start);
+    bool overtaken = !large->IsFinished();
+    loader.Wait(large);
+    double largeMs = Milliseconds(start);
+    ok &= Check(large->GetState() == AssetLoader::Request::STATE_DONE && small->GetState() == AssetLoader::Request::STATE_DONE,
+        "both priorities loaded");
+    ok &= Check(overtaken, "high priority finished first");
+    printf("  high priority after %.2f ms, low priority after %.2f ms\n", smallMs, largeMs);
+    loader.Release(small);
+    loader.Release(large);
+
+    // Canceling stops the read
+    AssetLoader::Stats before = loader.GetStats();
+    AssetLoader::Request* canceled = loader.Load(paths[0].c_str(), AssetLoader::PRIORITY_LOW);
+    loader.Cancel(canceled);
+    loader.Wait(canceled);
+    AssetLoader::Stats after = loader.GetStats();
+    ok &= Check(canceled->GetState() == AssetLoader::Request::STATE_CANCELED && !canceled->GetData(), "canceled load has no data");
+    printf("  read %u bytes before it stopped\n", after.bytesRead - before.bytesRead);
+    loader.Release(canceled);
+
+    // Missing files use the embedded data
+    static const char embedded[] = "embedded";
+    AssetLoader::Request* missing = loader.Load("/nonexistent/assets.pak", AssetLoader::PRIORITY_NORMAL, embedded, sizeof(embedded));
+    AssetLoader::Request* failed = loader.Load("/nonexistent/assets.pak", AssetLoader::PRIORITY_NORMAL);
+    loader.Wait(missing);
+    loader.Wait(failed);
+    ok &= Check(missing->IsFallback() && missing->GetData() == embedded, "missing file falls back to embedded data");
+    ok &= Check(failed->GetState() == AssetLoader::Request::STATE_FAILED, "missing file without fallback fails");
+    loader.Release(missing);
+    loader.Release(failed);
+
+    // Buffers are reused, so loading again doesn't grow the pool
+    uint32_t poolBytes = loader.GetStats().poolBytes;
+    AssetLoader::Request* again = loader.Load(paths[0].c_str(), AssetLoader::PRIORITY_NORMAL);
+    loader.Wait(again);
+    ok &= Check(loader.GetStats().poolBytes == poolBytes, "pool doesn't grow when loading again");
+    ok &= Check(((uintptr_t) again->GetData() & (AssetLoader::BUFFER_ALIGNMENT - 1)) == 0, "buffers are aligned");
+    loader.Release(again);
+
+    AssetLoader::Stats stats = loader.GetStats();
+    printf("loaded %u, fallbacks %u, failed %u, canceled %u, pool %.1f MB\n", stats.loaded, stats.fallbacks,
+        stats.failed, stats.canceled, stats.poolBytes / (1024.0 * 1024.0));
+
+    loader.Finalize();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include "BulletPool.hpp"
+
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+static const uint32_t TICKS = 600;
+static const uint32_t NUM_SHIPS = 8;
+static const float FIELD_SIZE = 3072.0f;
+static const float BOUNDS = FIELD_SIZE / 2 + 1024.0f;
+static const float SHIP_RADIUS = 32.0f;
+static const float BULLET_RADIUS = 16.0f;
+
+static double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool Check(bool condition, const char* what)
+{
+    printf("%-48s %s\n", what, condition ? "ok" : "FAILED");
+    return condition;
+}
+
+// Every ship fires every tick while flying around, like the game under heavy spam
+int main(int argc, char const* argv[])
+{
+    static BulletPool pool(glm::vec2(-BOUNDS), glm::vec2(BOUNDS));
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    glm::vec2 ships[NUM_SHIPS];
+    for (glm::vec2& ship : ships) {
+        ship = glm::vec2(unit(random), unit(random)) * (FIELD_SIZE / 2);
+    }
+
+    std::vector<BulletPool::Pair> pairs(BulletPool::CAPACITY);
+
+    uint64_t gridTests = 0, bruteTests = 0;
+    uint64_t cellMoves = 0, retired = 0, peakBullets = 0;
+    double gridMs = 0.0, bruteMs = 0.0;
+    bool shipsMatch = true, pairsMatch = true;
+
+    for (uint32_t tick = 0; tick < TICKS; ++tick) {
+        for (uint32_t i = 0; i < NUM_SHIPS; ++i) {
+            ships[i] = glm::clamp(ships[i] + glm::vec2(unit(random), unit(random)) * 8.0f, -FIELD_SIZE / 2, FIELD_SIZE / 2);
+            float angle = unit(random) * 180.0f;
+            glm::vec2 forward = glm::vec2(sin(glm::radians(angle)), -cos(glm::radians(angle)));
+            pool.Spawn(ships[i], forward * 16.0f, angle, i, 600);
+        }
+
+        pool.Update();
+        BulletPool::Stats const& stats = pool.GetStats();
+        cellMoves += stats.cellMoves;
+        retired += stats.retired;
+        peakBullets = std::max<uint64_t>(peakBullets, pool.GetCount());
+
+        // Test every bullet first
+        auto start = std::chrono::steady_clock::now();
+        uint32_t count = pool.GetCount();
+        bool bruteHits[NUM_SHIPS] = {};
+        for (uint32_t i = 0; i < NUM_SHIPS; ++i) {
+            for (uint32_t j = 0; j < count; ++j) {
+                if (pool.GetOwner(j) == i) {
+                    continue;
+                }
+
+                bruteTests++;
+                glm::vec2 d = pool.GetPosition(j) - ships[i];
+                if (glm::dot(d, d) < SHIP_RADIUS * SHIP_RADIUS) {
+                    bruteHits[i] = true;
+                    break;
+                }
+            }
+        }
+
+        uint32_t bruteNumPairs = 0;
+        for (uint32_t a = 0; a < count; ++a) {
+            for (uint32_t b = a + 1; b < count; ++b) {
+                if (pool.GetOwner(a) == pool.GetOwner(b)) {
+                    continue;
+                }
+
+                bruteTests++;
+                glm::vec2 d = pool.GetPosition(a) - pool.GetPosition(b);
+                if (glm::dot(d, d) < BULLET_RADIUS * BULLET_RADIUS) {
+                    bruteNumPairs++;
+                }
+            }
+        }
+        bruteMs += Milliseconds(start);
+
+        // Then ships against the bullets of everyone else with the grid
+        start = std::chrono::steady_clock::now();
+        int hits[NUM_SHIPS];
+        for (uint32_t i = 0; i < NUM_SHIPS; ++i) {
+            hits[i] = pool.FindHit(ships[i], SHIP_RADIUS, i);
+        }
+        uint32_t numPairs = pool.FindPairs(BULLET_RADIUS, pairs.data(), pairs.size());
+        gridMs += Milliseconds(start);
+        // Includes the tests of the queries, the stats are only reset by Update
+        gridTests += stats.pairTests;
+
+        for (uint32_t i = 0; i < NUM_SHIPS; ++i) {
+            shipsMatch &= (hits[i] >= 0) == bruteHits[i];
+        }
+        pairsMatch &= numPairs == bruteNumPairs;
+
+        // Like the game, a bullet which hit a ship is used up
+        if (hits[0] >= 0) {
+            pool.Remove(hits[0]);
+        }
+    }
+
+    printf("%u ticks, %u ships, peak %lu bullets, %lu retired, %lu cell moves\n", TICKS, NUM_SHIPS,
+        (unsigned long) peakBullets, (unsigned long) retired, (unsigned long) cellMoves);
+    printf("grid     %10.3f ms per tick, %12lu tests\n", gridMs / TICKS, (unsigned long) gridTests);
+    printf("brute    %10.3f ms per tick, %12lu tests\n", bruteMs / TICKS, (unsigned long) bruteTests);
+
+    bool ok = true;
+    ok &= Check(shipsMatch, "ship hits match testing every bullet");
+    ok &= Check(pairsMatch, "bullet pairs match testing every pair");
+    ok &= Check(retired > 0, "bullets leaving the field are retired");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,364 @@
+#include "Gfx.hpp"
+#include "SoftRaster.hpp"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Same limits as the GX2 backend
+#define TRANSIENT_BUFFER_SIZE (1024 * 1024)
+
+// Same as textures, see SoftTexture.cpp
+#define TEXTURE_ALIGNMENT 0x100
+
+// File name suffixes of captured targets
+static const char* const captureTargetNames[] = { "tv", "drc0", "drc1" };
+
+// Every fragment adds to a black body heatmap in rgb and counts in alpha
+static const glm::vec4 overdrawColor = glm::vec4(0.25f, 0.125f, 0.0625f, 1.0f / 255.0f);
+
+static int64_t GetTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Gfx::Gfx()
+{
+    raster = nullptr;
+    frameCount = 0;
+    lastSwapEndUs = 0;
+    drawStartUs = 0;
+
+    currentTarget = TARGET_TV;
+    currentBlendMode = BLEND_ALPHA;
+    alphaTestEnabled = false;
+    alphaTestRef = 0.0f;
+
+    bloomEnabled = true;
+    overdrawEnabled = false;
+
+    captureRequested = false;
+    captureCount = 0;
+
+    memset(&frameStats, 0, sizeof(frameStats));
+    memset(&pendingStats, 0, sizeof(pendingStats));
+
+    modelMatrix = glm::mat4(1.0f);
+    viewMatrix = glm::mat4(1.0f);
+    projectionMatrix = glm::mat4(1.0f);
+}
+
+Gfx::~Gfx()
+{
+}
+
+bool Gfx::Initialize()
+{
+    // 720p TV and two GamePads
+    targetSizes[TARGET_TV] = glm::uvec2(1280, 720);
+    targetSizes[TARGET_DRC0] = glm::uvec2(854, 480);
+    targetSizes[TARGET_DRC1] = glm::uvec2(854, 480);
+    for (int i = 0; i < NUM_TARGETS; ++i) {
+        targetPixels[i].assign(targetSizes[i].x * targetSizes[i].y * 4, 0);
+    }
+
+    raster = new SoftRaster();
+
+    if (!transientBuffer.Initialize(TRANSIENT_BUFFER_SIZE)) {
+        return false;
+    }
+
+    if (!frameCapture.Initialize()) {
+        return false;
+    }
+
+    // Initialize projection
+    projectionMatrix = glm::ortho(0.0f, screenSpace.x, screenSpace.y, 0.0f, -1.0f, 1.0f);
+    matrixUpdated = true;
+
+    return true;
+}
+
+void Gfx::Finalize()
+{
+    delete raster;
+    raster = nullptr;
+
+    transientBuffer.Finalize();
+    frameCapture.Finalize();
+}
+
+void Gfx::SetModel(glm::mat4& model)
+{
+    modelMatrix = model;
+    matrixUpdated = true;
+}
+
+void Gfx::SetView(glm::mat4& view)
+{
+    viewMatrix = view;
+    matrixUpdated = true;
+}
+
+void Gfx::SetBlendMode(BlendMode mode)
+{
+    // Overdraw counting needs every fragment to add up
+    if (overdrawEnabled) {
+        mode = BLEND_ADDITIVE_PREMULTIPLIED;
+    }
+
+    if (currentBlendMode == mode) {
+        return;
+    }
+
+    currentBlendMode = mode;
+    pendingStats.blendChanges++;
+}
+
+void Gfx::SetAlphaTest(bool enabled, float ref)
+{
+    // Overdraw counting needs every fragment
+    if (overdrawEnabled) {
+        enabled = false;
+    }
+
+    if (alphaTestEnabled == enabled && (!enabled || alphaTestRef == ref)) {
+        return;
+    }
+
+    alphaTestEnabled = enabled;
+    alphaTestRef = ref;
+    pendingStats.blendChanges++;
+}
+
+void Gfx::BeginDraw(Target target, glm::vec4 color)
+{
+    currentTarget = target;
+    drawStartUs = GetTimeUs();
+
+    // Overdraw counting starts from zero
+    if (overdrawEnabled) {
+        color = glm::vec4(0.0f);
+    }
+
+    raster->Begin(targetPixels[target].data(), targetSizes[target], color);
+
+    // Every target starts with regular alpha blending
+    SetBlendMode(BLEND_ALPHA);
+    SetAlphaTest(false);
+}
+
+void Gfx::EndDraw()
+{
+    raster->Flush();
+
+    // There is no GPU, report the time spent rasterizing instead
+    frameStats.targetGpuMs[currentTarget] = (GetTimeUs() - drawStartUs) / 1000.0f;
+
+    if (overdrawEnabled) {
+        // The count of every pixel is in the alpha channel
+        const std::vector<uint8_t>& pixels = targetPixels[currentTarget];
+        uint64_t sum = 0;
+        uint32_t max = 0;
+        for (size_t i = 3; i < pixels.size(); i += 4) {
+            sum += pixels[i];
+            if (pixels[i] > max) {
+                max = pixels[i];
+            }
+        }
+
+        frameStats.overdrawAverage[currentTarget] = (float) sum / (pixels.size() / 4);
+        frameStats.overdrawMax[currentTarget] = max;
+    }
+
+    if (captureRequested) {
+        CaptureTarget();
+    }
+}
+
+bool Gfx::BeginEmissive()
+{
+    // Post processing isn't supported by the software backend
+    return false;
+}
+
+void Gfx::EndEmissive()
+{
+}
+
+void Gfx::SetBloomEnabled(bool enabled)
+{
+    bloomEnabled = enabled;
+}
+
+bool Gfx::IsOverdrawMode() const
+{
+    return overdrawEnabled;
+}
+
+bool Gfx::SetOverdrawMode(bool enabled)
+{
+    overdrawEnabled = enabled;
+
+    // Force the blend state to be reapplied
+    currentBlendMode = NUM_BLEND_MODES;
+    SetBlendMode(BLEND_ALPHA);
+
+    return true;
+}
+
+bool Gfx::RequestCapture(const char* prefix)
+{
+    // Only one capture per frame
+    if (captureRequested) {
+        return false;
+    }
+
+    // Buffers for every target
+    uint32_t sizes[NUM_TARGETS];
+    for (int i = 0; i < NUM_TARGETS; ++i) {
+        sizes[i] = targetSizes[i].x * targetSizes[i].y * 4;
+    }
+    if (!frameCapture.AllocateBuffers(sizes, NUM_TARGETS, TEXTURE_ALIGNMENT)) {
+        return false;
+    }
+
+    capturePrefix = prefix;
+    captureRequested = true;
+    captureCount++;
+    return true;
+}
+
+FrameCapture::Stats Gfx::GetCaptureStats() const
+{
+    return frameCapture.GetStats();
+}
+
+void Gfx::CaptureTarget()
+{
+    const glm::uvec2 size = targetSizes[currentTarget];
+    FrameCapture::Buffer* buffer = frameCapture.Acquire(size.x * size.y * 4);
+    if (!buffer) {
+        return;
+    }
+
+    // The targets are already linear
+    memcpy(buffer->pixels, targetPixels[currentTarget].data(), size.x * size.y * 4);
+
+    buffer->size = size;
+    buffer->pitch = size.x;
+    snprintf(buffer->path, sizeof(buffer->path), "%s_%04u_%s.png", capturePrefix.c_str(), captureCount, captureTargetNames[currentTarget]);
+    frameCapture.Submit(buffer);
+}
+
+void Gfx::Draw(Texture* tex, const void* vertices, uint32_t numVertices, glm::vec4 color, bool quads, const SamplerState* state)
+{
+    SoftRaster::Sampler sampler;
+    if (tex) {
+        sampler.image = tex->image;
+        sampler.size = tex->size;
+        sampler.pitch = tex->pitch;
+        if (state) {
+            sampler.clamp = state->clamp;
+            sampler.linearFilter = state->linearFilter;
+            sampler.texCoordParams[0] = state->uvOffset.x;
+            sampler.texCoordParams[1] = state->uvOffset.y;
+            sampler.texCoordParams[2] = state->uvScale.x;
+            sampler.texCoordParams[3] = state->uvScale.y;
+        } else {
+            sampler.clamp = tex->clamp;
+            sampler.linearFilter = tex->linearFilter;
+            memcpy(sampler.texCoordParams, tex->texCoordParams, sizeof(sampler.texCoordParams));
+        }
+    }
+
+    // Vertex layout of the caller, position is always first
+    const uint32_t stride = tex ? 16 : 8;
+
+    // Only count the covered fragments while visualizing overdraw
+    if (overdrawEnabled) {
+        tex = nullptr;
+        color = overdrawColor;
+    }
+
+    glm::mat4 mvpMatrix = projectionMatrix * viewMatrix * modelMatrix;
+    raster->AddTriangles(mvpMatrix, vertices, stride, numVertices, quads, color, tex ? &sampler : nullptr,
+        (SoftRaster::BlendMode) currentBlendMode, alphaTestEnabled ? alphaTestRef : 0.0f);
+
+    pendingStats.drawCalls[currentTarget]++;
+    pendingStats.vertices[currentTarget] += numVertices;
+}
+
+void Gfx::SwapBuffers(void)
+{
+    int64_t swapStartUs = GetTimeUs();
+
+    transientBuffer.EndFrame(frameCount);
+    transientBuffer.Reclaim();
+
+    // Rendering is done once the frame ends, captures can be encoded right away
+    frameCapture.EndFrame(frameCount + 1);
+    frameCapture.Dispatch();
+    captureRequested = false;
+
+    // Publish the counters of this frame
+    for (int i = 0; i < NUM_TARGETS; ++i) {
+        frameStats.drawCalls[i] = pendingStats.drawCalls[i];
+        frameStats.vertices[i] = pendingStats.vertices[i];
+    }
+    frameStats.shaderChanges = pendingStats.shaderChanges;
+    frameStats.blendChanges = pendingStats.blendChanges;
+    frameStats.cpuFrameMs = lastSwapEndUs ? (swapStartUs - lastSwapEndUs) / 1000.0f : 0.0f;
+    frameStats.swapWaitMs = 0.0f;
+    frameStats.gpuFrameMs = 0.0f;
+    for (int i = 0; i < NUM_TARGETS; ++i) {
+        frameStats.gpuFrameMs += frameStats.targetGpuMs[i];
+    }
+    memset(&pendingStats, 0, sizeof(pendingStats));
+
+    frameCount++;
+    lastSwapEndUs = GetTimeUs();
+}
+
+void* Gfx::AllocTransient(uint32_t size, uint32_t align)
+{
+    return transientBuffer.Alloc(size, align);
+}
+
+RingBuffer::Stats const& Gfx::GetTransientStats() const
+{
+    return transientBuffer.GetStats();
+}
+
+Gfx::FrameStats const& Gfx::GetFrameStats() const
+{
+    return frameStats;
+}
+
+bool Gfx::SaveTarget(Target target, const char* path)
+{
+    return SoftRaster::WritePNG(targetPixels[target].data(), targetSizes[target], path);
+}
+
+Gfx::Texture* Gfx::NewPreservedTexture(glm::uvec2 size, bool clamp, bool linearFilter)
+{
+    // Host memory is never lost
+    return NewTexture(size, nullptr, clamp, linearFilter);
+}
+
+void* Gfx::AllocVertices(uint32_t size)
+{
+    return aligned_alloc(GX2_VERTEX_BUFFER_ALIGNMENT, (size + GX2_VERTEX_BUFFER_ALIGNMENT - 1) & ~(GX2_VERTEX_BUFFER_ALIGNMENT - 1));
+}
+
+void Gfx::FlushVertices(void* vertices, uint32_t size)
+{
+    // The rasterizer reads from the CPU cache
+}
+
+void Gfx::FreeVertices(void* vertices)
+{
+    free(vertices);
+}
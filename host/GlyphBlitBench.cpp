@@ -0,0 +1,170 @@
+#include "GlyphBlit.hpp"
+
+#include <coreinit/memory.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Strings and sizes of every Text in the game, 64 is also the size of the distance field glyphs
+static const char* uiStrings[] = {
+    "Pairing second GamePad", "Pin: 1234", "120 seconds remaining", "Paired second GamePad",
+    "Failed to pair GamePad", "Press the console's SYNC button to cancel", "Game is paused",
+    "Game Over", "Player 1 won!", "Start Game", "Pair second GamePad", "Exit",
+    "No second GamePad connected!", "Waiting for host to start game...", "Multi DRC Space Demo",
+};
+static const uint32_t uiSizes[] = { 32, 48, 64, 96 };
+
+static const uint32_t ITERATIONS = 200;
+
+struct Glyph {
+    std::vector<uint8_t> coverage;
+    GlyphBlit::Bitmap bitmap;
+    glm::ivec2 pos;
+};
+
+enum Kernel {
+    KERNEL_COPY,
+    KERNEL_BLEND,
+    KERNEL_SHADOWED,
+    KERNEL_OUTLINED,
+
+    NUM_KERNELS,
+};
+
+static const char* kernelNames[NUM_KERNELS] = { "copy", "blend", "shadowed", "outlined" };
+
+// Lay out all strings below each other like the game does
+static std::vector<Glyph> LayoutStrings(FT_Face face, uint32_t size, glm::uvec2 surfaceSize)
+{
+    FT_Set_Pixel_Sizes(face, 0, size);
+
+    std::vector<Glyph> glyphs;
+    glm::ivec2 pen = glm::ivec2(8, size);
+    for (const char* str : uiStrings) {
+        for (const char* c = str; *c; ++c) {
+            if (FT_Load_Char(face, *c, FT_LOAD_RENDER) != 0) {
+                continue;
+            }
+
+            FT_GlyphSlot slot = face->glyph;
+            Glyph glyph;
+            glyph.coverage.resize(slot->bitmap.width * slot->bitmap.rows);
+            for (uint32_t y = 0; y < slot->bitmap.rows; ++y) {
+                memcpy(glyph.coverage.data() + y * slot->bitmap.width, slot->bitmap.buffer + y * slot->bitmap.pitch, slot->bitmap.width);
+            }
+            glyph.bitmap.size = glm::uvec2(slot->bitmap.width, slot->bitmap.rows);
+            glyph.bitmap.pitch = slot->bitmap.width;
+            glyph.pos = pen + glm::ivec2(slot->bitmap_left, -slot->bitmap_top);
+            glyphs.push_back(std::move(glyph));
+
+            pen.x += slot->advance.x >> 6;
+        }
+
+        // Strings wider than the surface are clipped, which is part of the work
+        pen.x = 8;
+        pen.y = (pen.y + size * 5 / 4) % surfaceSize.y;
+    }
+
+    for (Glyph& glyph : glyphs) {
+        glyph.bitmap.coverage = glyph.coverage.data();
+    }
+    return glyphs;
+}
+
+static void Run(Kernel kernel, GlyphBlit::Surface const& surface, std::vector<Glyph> const& glyphs)
+{
+    const glm::u8vec4 color = glm::u8vec4(255, 200, 64, 255);
+    const glm::u8vec4 shadow = glm::u8vec4(0, 0, 0, 160);
+
+    for (const Glyph& glyph : glyphs) {
+        switch (kernel) {
+        case KERNEL_COPY:
+            GlyphBlit::Copy(surface, glyph.pos, glyph.bitmap);
+            break;
+        case KERNEL_BLEND:
+            GlyphBlit::Blend(surface, glyph.pos, glyph.bitmap, color);
+            break;
+        case KERNEL_SHADOWED:
+            GlyphBlit::BlendShadowed(surface, glyph.pos, glyph.bitmap, color, glm::ivec2(2, 2), shadow);
+            break;
+        case KERNEL_OUTLINED:
+            GlyphBlit::BlendOutlined(surface, glyph.pos, glyph.bitmap, color, 2, shadow);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Average time of one pass over all glyphs in microseconds, leaves the result of one pass in pixels
+static double Measure(Kernel kernel, bool simd, GlyphBlit::Surface const& surface, std::vector<Glyph> const& glyphs)
+{
+    GlyphBlit::SetSimdEnabled(simd);
+
+    uint32_t bytes = surface.pitch * surface.size.y * 4;
+    memset(surface.pixels, 0, bytes);
+    Run(kernel, surface, glyphs);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < ITERATIONS; ++i) {
+        Run(kernel, surface, glyphs);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    memset(surface.pixels, 0, bytes);
+    Run(kernel, surface, glyphs);
+
+    return std::chrono::duration<double, std::micro>(end - start).count() / ITERATIONS;
+}
+
+// Compares the plain loops against the vectorized kernels for every text size of the game
+int main(int argc, char const* argv[])
+{
+    void* font = nullptr;
+    uint32_t fontSize = 0;
+    if (!OSGetSharedData(OS_SHAREDDATATYPE_FONT_STANDARD, 0, &font, &fontSize)) {
+        fprintf(stderr, "Failed to load the font, set HOST_FONT\n");
+        return 1;
+    }
+
+    FT_Library library;
+    FT_Face face;
+    if (FT_Init_FreeType(&library) != 0 || FT_New_Memory_Face(library, (const FT_Byte*) font, fontSize, 0, &face) != 0) {
+        fprintf(stderr, "Failed to open the font\n");
+        return 1;
+    }
+
+    const glm::uvec2 surfaceSize = glm::uvec2(1024, 1024);
+    std::vector<uint8_t> plainPixels(surfaceSize.x * surfaceSize.y * 4);
+    std::vector<uint8_t> simdPixels(plainPixels.size());
+    GlyphBlit::Surface plain = { plainPixels.data(), surfaceSize.x, surfaceSize };
+    GlyphBlit::Surface simd = { simdPixels.data(), surfaceSize.x, surfaceSize };
+
+    printf("%6s %8s %8s %10s %10s %8s %6s\n", "size", "kernel", "glyphs", "plain us", "simd us", "speedup", "match");
+
+    bool allMatch = true;
+    for (uint32_t size : uiSizes) {
+        std::vector<Glyph> glyphs = LayoutStrings(face, size, surfaceSize);
+
+        for (int kernel = 0; kernel < NUM_KERNELS; ++kernel) {
+            double plainUs = Measure((Kernel) kernel, false, plain, glyphs);
+            double simdUs = Measure((Kernel) kernel, true, simd, glyphs);
+            bool match = plainPixels == simdPixels;
+            allMatch = allMatch && match;
+
+            printf("%6u %8s %8zu %10.1f %10.1f %7.2fx %6s\n", size, kernelNames[kernel], glyphs.size(),
+                plainUs, simdUs, plainUs / simdUs, match ? "yes" : "NO");
+        }
+    }
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+#include "InputLog.hpp"
+
+#include <vpad/input.h>
+
+#include <chrono>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const uint32_t ITERATIONS = 100;
+
+// Buttons the host input scripts know, the emulated stick buttons follow from the sticks
+static const struct {
+    const char* name;
+    uint32_t button;
+} buttonNames[] = {
+    { "A", VPAD_BUTTON_A },
+    { "B", VPAD_BUTTON_B },
+    { "X", VPAD_BUTTON_X },
+    { "Y", VPAD_BUTTON_Y },
+    { "LEFT", VPAD_BUTTON_LEFT },
+    { "RIGHT", VPAD_BUTTON_RIGHT },
+    { "UP", VPAD_BUTTON_UP },
+    { "DOWN", VPAD_BUTTON_DOWN },
+    { "ZL", VPAD_BUTTON_ZL },
+    { "ZR", VPAD_BUTTON_ZR },
+    { "L", VPAD_BUTTON_L },
+    { "R", VPAD_BUTTON_R },
+    { "PLUS", VPAD_BUTTON_PLUS },
+    { "MINUS", VPAD_BUTTON_MINUS },
+    { "HOME", VPAD_BUTTON_HOME },
+    { "STICK_L", VPAD_BUTTON_STICK_L },
+    { "STICK_R", VPAD_BUTTON_STICK_R },
+    { "TV", VPAD_BUTTON_TV },
+};
+
+static double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static uint32_t GetScriptButtons(uint32_t hold)
+{
+    uint32_t buttons = 0;
+    for (auto const& entry : buttonNames) {
+        buttons |= hold & entry.button;
+    }
+    return buttons;
+}
+
+static void PrintButtons(FILE* f, uint32_t buttons)
+{
+    if (!buttons) {
+        fputs("-", f);
+        return;
+    }
+
+    bool first = true;
+    for (auto const& entry : buttonNames) {
+        if (buttons & entry.button) {
+            fprintf(f, "%s%s", first ? "" : "|", entry.name);
+            first = false;
+        }
+    }
+}
+
+// Turn the log into a script for HOST_INPUT, the host game runs one step per frame so ticks are frames.
+// Sticks are written with enough digits to round to the same logged values again.
+static bool WriteScript(const void* data, uint32_t size, const char* path)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+
+    InputLog::Reader reader;
+    reader.Open(data, size);
+    fprintf(f, "# %u steps at %u Hz, seed %u\n", reader.GetTickCount(), reader.GetStepRate(), reader.GetSeed());
+
+    InputLog::Sample samples[InputLog::MAX_CHANNELS];
+    InputLog::Sample last[InputLog::MAX_CHANNELS] = {};
+    while (reader.Next(samples)) {
+        uint32_t frame = reader.GetTick() - 1;
+        for (uint32_t i = 0; i < reader.GetNumChannels(); ++i) {
+            uint32_t buttons = GetScriptButtons(samples[i].hold);
+            bool sticksChanged = false;
+            for (uint32_t j = 0; j < 4; ++j) {
+                sticksChanged |= samples[i].sticks[j] != last[i].sticks[j];
+            }
+
+            if (buttons == GetScriptButtons(last[i].hold) && !sticksChanged) {
+                continue;
+            }
+
+            fprintf(f, "%u pad %u ", frame, i);
+            PrintButtons(f, buttons);
+            for (uint32_t j = 0; j < 4; ++j) {
+                fprintf(f, " %.9g", InputLog::GetStickValue(samples[i].sticks[j]));
+            }
+            fputs("\n", f);
+            last[i] = samples[i];
+        }
+    }
+
+    fprintf(f, "%u exit\n", reader.GetTick());
+    return fclose(f) == 0;
+}
+
+// Prints what a recorded input log contains and how fast it decodes, optionally converting it into a host input script
+int main(int argc, char const* argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <input log> [script]\n", argv[0]);
+        return 1;
+    }
+
+    // Logs are read in place, like benchmarks replaying them would
+    int fd = open(argv[1], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0) {
+        fprintf(stderr, "Failed to open %s\n", argv[1]);
+        return 1;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Failed to map %s\n", argv[1]);
+        return 1;
+    }
+
+    InputLog::Reader reader;
+    if (!reader.Open(data, st.st_size)) {
+        fprintf(stderr, "%s isn't an input log\n", argv[1]);
+        return 1;
+    }
+
+    // Count what happened on every channel
+    uint32_t numChannels = reader.GetNumChannels();
+    uint32_t presses[InputLog::MAX_CHANNELS] = {};
+    uint32_t connectedTicks[InputLog::MAX_CHANNELS] = {};
+    InputLog::Sample samples[InputLog::MAX_CHANNELS];
+    while (reader.Next(samples)) {
+        for (uint32_t i = 0; i < numChannels; ++i) {
+            presses[i] += __builtin_popcount(samples[i].trigger);
+            connectedTicks[i] += samples[i].connected;
+        }
+    }
+
+    bool complete = reader.GetTick() == reader.GetTickCount();
+    printf("%u steps at %u Hz (%.1f s), seed %u, %u channels\n", reader.GetTickCount(), reader.GetStepRate(),
+        reader.GetStepRate() ? (double) reader.GetTickCount() / reader.GetStepRate() : 0.0, reader.GetSeed(), numChannels);
+    printf("%u bytes, %.3f bytes per step\n", (uint32_t) st.st_size,
+        reader.GetTickCount() ? (double) st.st_size / reader.GetTickCount() : 0.0);
+    if (!complete) {
+        printf("  broken, decoding stopped after step %u\n", reader.GetTick());
+    }
+    for (uint32_t i = 0; i < numChannels; ++i) {
+        printf("  channel %u: connected for %u steps, %u presses\n", i, connectedTicks[i], presses[i]);
+    }
+
+    // Decoding has to stay far below the cost of a step
+    auto start = std::chrono::steady_clock::now();
+    uint64_t ticks = 0;
+    for (uint32_t i = 0; i < ITERATIONS; ++i) {
+        reader.Open(data, st.st_size);
+        while (reader.Next(samples)) {
+            ticks++;
+        }
+    }
+    double ms = Milliseconds(start);
+    printf("decoding %8.1f ns per step\n", ticks ? ms * 1000000.0 / ticks : 0.0);
+
+    if (argc > 2 && !WriteScript(data, st.st_size, argv[2])) {
+        fprintf(stderr, "Failed to write %s\n", argv[2]);
+        return 1;
+    }
+
+    munmap(data, st.st_size);
+    return complete ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+#include "Gfx.hpp"
+#include "SceneMgr.hpp"
+#include "Sprite.hpp"
+#include "Text.hpp"
+#include "Input.hpp"
+#include "Random.hpp"
+#include "AssetPack.hpp"
+
+#include <png.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Steps simulated before a scene is compared, long enough for every glyph to be rendered
+static const uint32_t SETTLE_FRAMES = 60;
+// DrawScene is timed over this many draws of each target
+static const uint32_t DRAW_ITERATIONS = 20;
+static const uint32_t SEED = 1234;
+
+// A channel may differ by this much, and this share of the pixels by more, to absorb font and
+// compiler differences between hosts
+static const int CHANNEL_TOLERANCE = 16;
+static const double PIXEL_TOLERANCE = 0.01;
+
+static const char* const targetNames[] = { "tv", "drc0", "drc1" };
+
+static double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool Check(bool condition, const char* what)
+{
+    printf("%-48s %s\n", what, condition ? "ok" : "FAILED");
+    return condition;
+}
+
+static bool ReadPNG(const char* path, std::vector<uint8_t>& rgb, glm::uvec2* size)
+{
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&image, path)) {
+        return false;
+    }
+
+    image.format = PNG_FORMAT_RGB;
+    rgb.resize(PNG_IMAGE_SIZE(image));
+    *size = glm::uvec2(image.width, image.height);
+    return png_image_finish_read(&image, nullptr, rgb.data(), 0, nullptr) != 0;
+}
+
+// Share of the pixels which differ by more than the tolerance, 1 if the images can't be compared
+static double ComparePNG(const char* path, const char* referencePath)
+{
+    std::vector<uint8_t> pixels, reference;
+    glm::uvec2 size, referenceSize;
+    if (!ReadPNG(path, pixels, &size) || !ReadPNG(referencePath, reference, &referenceSize) || size != referenceSize) {
+        return 1.0;
+    }
+
+    uint32_t differing = 0;
+    for (size_t i = 0; i < pixels.size(); i += 3) {
+        for (size_t c = 0; c < 3; ++c) {
+            if (abs(pixels[i + c] - reference[i + c]) > CHANNEL_TOLERANCE) {
+                differing++;
+                break;
+            }
+        }
+    }
+    return (double) differing / (size.x * size.y);
+}
+
+static void DrawFrame(Gfx* gfx, SceneMgr* sceneMgr)
+{
+    for (int i = 0; i < Gfx::NUM_TARGETS; ++i) {
+        gfx->BeginDraw((Gfx::Target) i);
+        sceneMgr->DrawScene(gfx, (Gfx::Target) i);
+        gfx->EndDraw();
+    }
+
+    gfx->SwapBuffers();
+    Text::EndFrame();
+}
+
+// Renders every target of the current scene after it settled, compares the frames against the
+// references and times DrawScene
+static bool CheckScene(Gfx* gfx, SceneMgr* sceneMgr, const char* name, bool update)
+{
+    // One step per frame, as if every frame took exactly a vsync
+    for (uint32_t i = 0; i < SETTLE_FRAMES; ++i) {
+        Input::Update();
+        sceneMgr->Advance(OSSecondsToTicks(1) / SceneMgr::STEP_RATE);
+        DrawFrame(gfx, sceneMgr);
+    }
+
+    bool ok = true;
+    for (int i = 0; i < Gfx::NUM_TARGETS; ++i) {
+        Gfx::Target target = (Gfx::Target) i;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t j = 0; j < DRAW_ITERATIONS; ++j) {
+            gfx->BeginDraw(target);
+            sceneMgr->DrawScene(gfx, target);
+            gfx->EndDraw();
+        }
+        double drawMs = Milliseconds(start) / DRAW_ITERATIONS;
+
+        std::string file = std::string(name) + "_" + targetNames[i] + ".png";
+        std::string referencePath = std::string(REFERENCE_DIR) + "/" + file;
+        std::string path = update ? referencePath : "scenecheck_" + file;
+        if (!gfx->SaveTarget(target, path.c_str())) {
+            fprintf(stderr, "Failed to write %s\n", path.c_str());
+            return false;
+        }
+
+        std::string what = std::string(name) + " " + targetNames[i];
+        if (update) {
+            printf("%-16s %8.3f ms DrawScene, wrote %s\n", what.c_str(), drawMs, referencePath.c_str());
+            continue;
+        }
+
+        double differing = ComparePNG(path.c_str(), referencePath.c_str());
+        printf("%-16s %8.3f ms DrawScene, %6.3f%% of the pixels differ\n", what.c_str(), drawMs, differing * 100.0);
+        ok &= Check(differing <= PIXEL_TOLERANCE, (what + " matches " + file).c_str());
+    }
+
+    // Keep the frame counters of the checked frames out of the next scene
+    gfx->SwapBuffers();
+    return ok;
+}
+
+static void* ReadPack(const char* path, uint32_t* size)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return nullptr;
+    }
+
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    // Textures are used in place
+    void* data = aligned_alloc(AssetPack::SURFACE_ALIGNMENT, (*size + AssetPack::SURFACE_ALIGNMENT - 1) & ~(AssetPack::SURFACE_ALIGNMENT - 1));
+    if (data && fread(data, 1, *size, f) != *size) {
+        free(data);
+        data = nullptr;
+    }
+    fclose(f);
+    return data;
+}
+
+// Renders fixed frames of the menu and the game with the software backend and compares them
+// against the references in host/reference, "update" rewrites the references instead
+int main(int argc, char const* argv[])
+{
+    bool update = argc > 1 && strcmp(argv[1], "update") == 0;
+
+    // Same seed and no input, so every run sees the same match
+    Random::SetSeed(SEED);
+
+    Gfx gfx;
+    if (!gfx.Initialize()) {
+        fprintf(stderr, "Failed to initialize the software backend\n");
+        return 1;
+    }
+
+    uint32_t packSize = 0;
+    void* pack = ReadPack(ASSET_PATH, &packSize);
+    if (!pack || !Sprite::OpenAssets(pack, packSize)) {
+        fprintf(stderr, "Failed to open %s\n", ASSET_PATH);
+        return 1;
+    }
+
+    Text::InitializeFont(&gfx);
+
+    bool ok = true;
+    {
+        SceneMgr sceneMgr;
+        ok &= CheckScene(&gfx, &sceneMgr, "menu", update);
+
+        sceneMgr.SetScene(SceneMgr::SCENE_GAME);
+        ok &= CheckScene(&gfx, &sceneMgr, "game", update);
+    }
+
+    Text::DeinitializeFont();
+    Sprite::CloseAssets();
+    free(pack);
+    gfx.Finalize();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,355 @@
+#include "SoftRaster.hpp"
+
+#include <png.h>
+
+#include <cmath>
+#include <string.h>
+
+// Signed area of the parallelogram spanned by a->b and a->p, positive if p is inside of the edge
+static inline float EdgeFunction(glm::vec2 const& a, glm::vec2 const& b, glm::vec2 const& p)
+{
+    return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+// Pixels exactly on an edge only belong to top and left edges, so shared edges aren't drawn twice
+static inline bool IsTopLeft(glm::vec2 const& a, glm::vec2 const& b)
+{
+    return (a.y == b.y && b.x > a.x) || (b.y < a.y);
+}
+
+static inline int64_t AddressTexel(int64_t coord, uint32_t size, bool clamp)
+{
+    if (clamp) {
+        return coord < 0 ? 0 : (coord >= (int64_t) size ? size - 1 : coord);
+    }
+
+    int64_t wrapped = coord % (int64_t) size;
+    return wrapped < 0 ? wrapped + size : wrapped;
+}
+
+static inline glm::vec4 FetchTexel(SoftRaster::Sampler const& sampler, int64_t x, int64_t y)
+{
+    x = AddressTexel(x, sampler.size.x, sampler.clamp);
+    y = AddressTexel(y, sampler.size.y, sampler.clamp);
+
+    const uint8_t* texel = sampler.image + (y * sampler.pitch + x) * 4;
+    return glm::vec4(texel[0], texel[1], texel[2], texel[3]) * (1.0f / 255.0f);
+}
+
+static glm::vec4 SampleTexture(SoftRaster::Sampler const& sampler, glm::vec2 uv)
+{
+    // Same as the textureShader: (uv + offset) * scale
+    uv = (uv + glm::vec2(sampler.texCoordParams[0], sampler.texCoordParams[1])) *
+        glm::vec2(sampler.texCoordParams[2], sampler.texCoordParams[3]);
+
+    float u = uv.x * sampler.size.x;
+    float v = uv.y * sampler.size.y;
+
+    if (!sampler.linearFilter) {
+        return FetchTexel(sampler, (int64_t) std::floor(u), (int64_t) std::floor(v));
+    }
+
+    // Bilinear filtering between the four closest texel centers
+    u -= 0.5f;
+    v -= 0.5f;
+    float x0 = std::floor(u);
+    float y0 = std::floor(v);
+    float tx = u - x0;
+    float ty = v - y0;
+
+    glm::vec4 top = glm::mix(FetchTexel(sampler, (int64_t) x0, (int64_t) y0), FetchTexel(sampler, (int64_t) x0 + 1, (int64_t) y0), tx);
+    glm::vec4 bottom = glm::mix(FetchTexel(sampler, (int64_t) x0, (int64_t) y0 + 1), FetchTexel(sampler, (int64_t) x0 + 1, (int64_t) y0 + 1), tx);
+    return glm::mix(top, bottom, ty);
+}
+
+static inline uint8_t PackChannel(float value)
+{
+    value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    return (uint8_t) (value * 255.0f + 0.5f);
+}
+
+SoftRaster::SoftRaster(uint32_t numThreads) :
+    pixels(nullptr),
+    generation(0),
+    busyWorkers(0),
+    stopping(false),
+    nextTile(0)
+{
+    if (numThreads == 0) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+
+    // The thread calling Flush also rasterizes tiles
+    for (uint32_t i = 1; i < numThreads; ++i) {
+        workers.emplace_back(&SoftRaster::WorkerThread, this);
+    }
+}
+
+SoftRaster::~SoftRaster()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCondition.notify_all();
+
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+void SoftRaster::Begin(uint8_t* pixels, glm::uvec2 size, glm::vec4 clearColor)
+{
+    this->pixels = pixels;
+    this->size = size;
+    numTiles = (size + glm::uvec2(TILE_SIZE - 1)) / TILE_SIZE;
+
+    states.clear();
+    triangles.clear();
+
+    // Clear the surface
+    uint8_t clear[4] = { PackChannel(clearColor.r), PackChannel(clearColor.g), PackChannel(clearColor.b), PackChannel(clearColor.a) };
+    for (uint32_t i = 0; i < size.x * size.y; ++i) {
+        memcpy(pixels + i * 4, clear, 4);
+    }
+}
+
+void SoftRaster::AddTriangles(glm::mat4 const& mvp, const void* vertices, uint32_t stride, uint32_t numVertices, bool quads,
+    glm::vec4 color, const Sampler* sampler, BlendMode blend, float alphaRef)
+{
+    // Capture the state at the time of the draw, textures might change their parameters afterwards
+    uint32_t state = states.size();
+    DrawState drawState{};
+    drawState.color = color;
+    drawState.textured = sampler != nullptr;
+    drawState.blend = blend;
+    drawState.alphaRef = alphaRef;
+    if (sampler) {
+        drawState.sampler = *sampler;
+    }
+    states.push_back(drawState);
+
+    const uint8_t* data = (const uint8_t*) vertices;
+
+    // Transform into pixel coordinates, top left is (0, 0)
+    auto fetch = [&](uint32_t index, glm::vec2& pos, glm::vec2& uv) {
+        const float* v = (const float*) (data + index * stride);
+        glm::vec4 clip = mvp * glm::vec4(v[0], v[1], 0.0f, 1.0f);
+        pos = glm::vec2((clip.x / clip.w * 0.5f + 0.5f) * size.x, (0.5f - clip.y / clip.w * 0.5f) * size.y);
+        uv = sampler ? glm::vec2(v[2], v[3]) : glm::vec2(0.0f);
+    };
+
+    const uint32_t primSize = quads ? 4 : 3;
+    for (uint32_t i = 0; i + primSize <= numVertices; i += primSize) {
+        Triangle tri;
+        tri.state = state;
+        fetch(i, tri.pos[0], tri.uv[0]);
+        fetch(i + 1, tri.pos[1], tri.uv[1]);
+        fetch(i + 2, tri.pos[2], tri.uv[2]);
+        triangles.push_back(tri);
+
+        // Quads are split into (0, 1, 2) and (0, 2, 3)
+        if (quads) {
+            tri.pos[1] = tri.pos[2];
+            tri.uv[1] = tri.uv[2];
+            fetch(i + 3, tri.pos[2], tri.uv[2]);
+            triangles.push_back(tri);
+        }
+    }
+}
+
+void SoftRaster::Flush()
+{
+    if (triangles.empty()) {
+        return;
+    }
+
+    // Bin the triangles into all tiles their bounds overlap
+    bins.resize(numTiles.x * numTiles.y);
+    for (std::vector<uint32_t>& bin : bins) {
+        bin.clear();
+    }
+
+    for (uint32_t i = 0; i < triangles.size(); ++i) {
+        Triangle const& tri = triangles[i];
+        glm::vec2 min = glm::min(tri.pos[0], glm::min(tri.pos[1], tri.pos[2]));
+        glm::vec2 max = glm::max(tri.pos[0], glm::max(tri.pos[1], tri.pos[2]));
+        if (max.x < 0.0f || max.y < 0.0f || min.x >= size.x || min.y >= size.y) {
+            continue;
+        }
+
+        uint32_t tx0 = (uint32_t) std::max(min.x, 0.0f) / TILE_SIZE;
+        uint32_t ty0 = (uint32_t) std::max(min.y, 0.0f) / TILE_SIZE;
+        uint32_t tx1 = std::min((uint32_t) max.x / TILE_SIZE, numTiles.x - 1);
+        uint32_t ty1 = std::min((uint32_t) max.y / TILE_SIZE, numTiles.y - 1);
+        for (uint32_t ty = ty0; ty <= ty1; ++ty) {
+            for (uint32_t tx = tx0; tx <= tx1; ++tx) {
+                bins[ty * numTiles.x + tx].push_back(i);
+            }
+        }
+    }
+
+    // Kick off the workers and help out
+    nextTile = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        busyWorkers = workers.size();
+        generation++;
+    }
+    startCondition.notify_all();
+
+    RasterizeTiles();
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCondition.wait(lock, [this] { return busyWorkers == 0; });
+    }
+
+    states.clear();
+    triangles.clear();
+}
+
+bool SoftRaster::WritePNG(const uint8_t* pixels, glm::uvec2 size, const char* path)
+{
+    // Alpha is ignored on scanout, so only store the color
+    std::vector<uint8_t> rgb(size.x * size.y * 3);
+    for (uint32_t i = 0; i < size.x * size.y; ++i) {
+        memcpy(&rgb[i * 3], pixels + i * 4, 3);
+    }
+
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    image.width = size.x;
+    image.height = size.y;
+    image.format = PNG_FORMAT_RGB;
+
+    return png_image_write_to_file(&image, path, 0, rgb.data(), size.x * 3, nullptr) != 0;
+}
+
+void SoftRaster::WorkerThread()
+{
+    uint64_t seenGeneration = 0;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        startCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+        if (stopping) {
+            return;
+        }
+        seenGeneration = generation;
+
+        lock.unlock();
+        RasterizeTiles();
+        lock.lock();
+
+        if (--busyWorkers == 0) {
+            doneCondition.notify_all();
+        }
+    }
+}
+
+void SoftRaster::RasterizeTiles()
+{
+    uint32_t tile;
+    while ((tile = nextTile++) < bins.size()) {
+        RasterizeTile(tile);
+    }
+}
+
+void SoftRaster::RasterizeTile(uint32_t tile)
+{
+    const int32_t tileX0 = (tile % numTiles.x) * TILE_SIZE;
+    const int32_t tileY0 = (tile / numTiles.x) * TILE_SIZE;
+    const int32_t tileX1 = std::min(tileX0 + (int32_t) TILE_SIZE, (int32_t) size.x);
+    const int32_t tileY1 = std::min(tileY0 + (int32_t) TILE_SIZE, (int32_t) size.y);
+
+    for (uint32_t index : bins[tile]) {
+        Triangle const& tri = triangles[index];
+        DrawState const& state = states[tri.state];
+
+        glm::vec2 v0 = tri.pos[0];
+        glm::vec2 v1 = tri.pos[1];
+        glm::vec2 v2 = tri.pos[2];
+        glm::vec2 uv0 = tri.uv[0];
+        glm::vec2 uv1 = tri.uv[1];
+        glm::vec2 uv2 = tri.uv[2];
+
+        // Culling is disabled, so bring every triangle into the same winding
+        float area = EdgeFunction(v0, v1, v2);
+        if (area == 0.0f) {
+            continue;
+        }
+        if (area < 0.0f) {
+            std::swap(v1, v2);
+            std::swap(uv1, uv2);
+            area = -area;
+        }
+
+        const bool topLeft0 = IsTopLeft(v1, v2);
+        const bool topLeft1 = IsTopLeft(v2, v0);
+        const bool topLeft2 = IsTopLeft(v0, v1);
+
+        // Bounds of the triangle inside of this tile
+        glm::vec2 min = glm::min(v0, glm::min(v1, v2));
+        glm::vec2 max = glm::max(v0, glm::max(v1, v2));
+        int32_t x0 = std::max((int32_t) std::floor(min.x), tileX0);
+        int32_t y0 = std::max((int32_t) std::floor(min.y), tileY0);
+        int32_t x1 = std::min((int32_t) std::ceil(max.x), tileX1);
+        int32_t y1 = std::min((int32_t) std::ceil(max.y), tileY1);
+
+        for (int32_t y = y0; y < y1; ++y) {
+            uint8_t* row = pixels + (y * size.x) * 4;
+            for (int32_t x = x0; x < x1; ++x) {
+                // Sample at the pixel center
+                glm::vec2 p = glm::vec2(x + 0.5f, y + 0.5f);
+                float w0 = EdgeFunction(v1, v2, p);
+                float w1 = EdgeFunction(v2, v0, p);
+                float w2 = EdgeFunction(v0, v1, p);
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f ||
+                    (w0 == 0.0f && !topLeft0) || (w1 == 0.0f && !topLeft1) || (w2 == 0.0f && !topLeft2)) {
+                    continue;
+                }
+
+                // Pixel shader
+                glm::vec4 src = state.color;
+                if (state.textured) {
+                    glm::vec2 uv = (uv0 * w0 + uv1 * w1 + uv2 * w2) / area;
+                    src = SampleTexture(state.sampler, uv) * state.color;
+                }
+                if (src.a < state.alphaRef) {
+                    continue;
+                }
+                src = glm::clamp(src, 0.0f, 1.0f);
+
+                // Blending
+                uint8_t* dstPixel = row + x * 4;
+                glm::vec4 dst = glm::vec4(dstPixel[0], dstPixel[1], dstPixel[2], dstPixel[3]) * (1.0f / 255.0f);
+                glm::vec4 out;
+                switch (state.blend) {
+                case BLEND_ALPHA:
+                    out = src * src.a + dst * (1.0f - src.a);
+                    break;
+                case BLEND_PREMULTIPLIED:
+                    out = src + dst * (1.0f - src.a);
+                    break;
+                case BLEND_ADDITIVE:
+                    out = src * src.a + dst;
+                    break;
+                case BLEND_OPAQUE:
+                    out = src;
+                    break;
+                case BLEND_ADDITIVE_PREMULTIPLIED:
+                default:
+                    out = src + dst;
+                    break;
+                }
+
+                dstPixel[0] = PackChannel(out.r);
+                dstPixel[1] = PackChannel(out.g);
+                dstPixel[2] = PackChannel(out.b);
+                dstPixel[3] = PackChannel(out.a);
+            }
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Tile based software rasterizer which reproduces the colorShader and textureShader pipelines.
+// Triangles are collected until Flush, binned into tiles and the tiles are rasterized in parallel.
+// Every tile processes its triangles in submission order, so the output is deterministic.
+class SoftRaster {
+public:
+    // Same order as Gfx::BlendMode
+    enum BlendMode {
+        BLEND_ALPHA,
+        BLEND_PREMULTIPLIED,
+        BLEND_ADDITIVE,
+        BLEND_ADDITIVE_PREMULTIPLIED,
+        BLEND_OPAQUE,
+    };
+
+    struct Sampler {
+        const uint8_t* image;
+        glm::uvec2 size;
+        uint32_t pitch;
+        bool clamp;
+        bool linearFilter;
+        // xy: offset, zw: scale
+        float texCoordParams[4];
+    };
+
+    SoftRaster(uint32_t numThreads = 0);
+    virtual ~SoftRaster();
+
+    // Start rendering into an RGBA8 surface
+    void Begin(uint8_t* pixels, glm::uvec2 size, glm::vec4 clearColor);
+
+    // Vertices start with a position (vec2) followed by a texture coordinate (vec2) if sampler is set.
+    // Fragments with an alpha below alphaRef are discarded.
+    void AddTriangles(glm::mat4 const& mvp, const void* vertices, uint32_t stride, uint32_t numVertices, bool quads,
+        glm::vec4 color, const Sampler* sampler, BlendMode blend, float alphaRef = 0.0f);
+
+    // Rasterize everything added since Begin
+    void Flush();
+
+    static bool WritePNG(const uint8_t* pixels, glm::uvec2 size, const char* path);
+
+private:
+    static constexpr uint32_t TILE_SIZE = 64;
+
+    struct DrawState {
+        glm::vec4 color;
+        Sampler sampler;
+        bool textured;
+        BlendMode blend;
+        float alphaRef;
+    };
+
+    struct Triangle {
+        glm::vec2 pos[3];
+        glm::vec2 uv[3];
+        uint32_t state;
+    };
+
+    void WorkerThread();
+    void RasterizeTiles();
+    void RasterizeTile(uint32_t tile);
+
+    uint8_t* pixels;
+    glm::uvec2 size;
+    glm::uvec2 numTiles;
+
+    std::vector<DrawState> states;
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<uint32_t>> bins;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+    uint64_t generation;
+    uint32_t busyWorkers;
+    bool stopping;
+    std::atomic<uint32_t> nextTile;
+};
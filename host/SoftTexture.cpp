@@ -0,0 +1,143 @@
+#include "Gfx.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Textures of the software backend, kept apart from GfxSoft.cpp so tools which only lay out
+// textures don't need the rasterizer or the wut stubs.
+
+// Linear aligned GX2 surfaces have a pitch aligned to 64 pixels, keep that so callers see the same layout
+#define TEXTURE_PITCH_ALIGNMENT 64
+#define TEXTURE_ALIGNMENT 0x100
+
+Gfx::Texture* Gfx::NewTexture(glm::uvec2 size, void* rgba, bool clamp, bool linearFilter)
+{
+    Texture* tex = new Texture();
+    if (!tex) {
+        return nullptr;
+    }
+
+    tex->size = size;
+    tex->pitch = (size.x + TEXTURE_PITCH_ALIGNMENT - 1) & ~(TEXTURE_PITCH_ALIGNMENT - 1);
+
+    size_t imageSize = ((tex->pitch * size.y * 4) + TEXTURE_ALIGNMENT - 1) & ~(TEXTURE_ALIGNMENT - 1);
+    tex->image = (uint8_t*) aligned_alloc(TEXTURE_ALIGNMENT, imageSize);
+    if (!tex->image) {
+        delete tex;
+        return nullptr;
+    }
+    memset(tex->image, 0, imageSize);
+
+    if (rgba) {
+        tex->Update(rgba);
+    }
+
+    tex->clamp = clamp;
+    tex->linearFilter = linearFilter;
+
+    // No offset by default, 1x scaling
+    tex->texCoordParams[0] = 0.0f;
+    tex->texCoordParams[1] = 0.0f;
+    tex->texCoordParams[2] = 1.0f;
+    tex->texCoordParams[3] = 1.0f;
+    tex->wrapped = false;
+
+    return tex;
+}
+
+Gfx::Texture* Gfx::WrapTexture(glm::uvec2 size, uint32_t pitch, void* image, uint32_t imageSize)
+{
+    // Same layout as textures created by NewTexture
+    uint32_t expectedPitch = (size.x + TEXTURE_PITCH_ALIGNMENT - 1) & ~(TEXTURE_PITCH_ALIGNMENT - 1);
+    if (pitch != expectedPitch || pitch * size.y * 4 > imageSize || ((uintptr_t) image & (TEXTURE_ALIGNMENT - 1)) != 0) {
+        return nullptr;
+    }
+
+    Texture* tex = new Texture();
+    if (!tex) {
+        return nullptr;
+    }
+
+    tex->size = size;
+    tex->pitch = pitch;
+    tex->image = (uint8_t*) image;
+    tex->clamp = false;
+    tex->linearFilter = true;
+
+    // No offset by default, 1x scaling
+    tex->texCoordParams[0] = 0.0f;
+    tex->texCoordParams[1] = 0.0f;
+    tex->texCoordParams[2] = 1.0f;
+    tex->texCoordParams[3] = 1.0f;
+    tex->wrapped = true;
+
+    return tex;
+}
+
+void Gfx::Texture::Update(void* rgba)
+{
+    uint8_t* dstPtr = (uint8_t*) Lock();
+    uint8_t* srcPtr = (uint8_t*) rgba;
+
+    // Copy the texture row by row
+    for (uint32_t y = 0; y < size.y; ++y) {
+        memcpy(dstPtr + (y * pitch * 4), srcPtr + (y * size.x * 4), size.x * 4);
+    }
+
+    Unlock();
+}
+
+uint32_t Gfx::Texture::GetPitch()
+{
+    return pitch;
+}
+
+glm::uvec2 Gfx::Texture::GetSize()
+{
+    return size;
+}
+
+void Gfx::Texture::SetClamp(bool clamp)
+{
+    this->clamp = clamp;
+}
+
+void Gfx::Texture::SetLinearFilter(bool linear)
+{
+    linearFilter = linear;
+}
+
+void Gfx::Texture::SetUVOffset(glm::vec2 offset)
+{
+    texCoordParams[0] = offset.x;
+    texCoordParams[1] = offset.y;
+}
+
+void Gfx::Texture::SetUVScale(glm::vec2 scale)
+{
+    texCoordParams[2] = scale.x;
+    texCoordParams[3] = scale.y;
+}
+
+void* Gfx::Texture::Lock()
+{
+    return image;
+}
+
+void Gfx::Texture::Unlock()
+{
+    // Textures are read directly from memory, nothing to invalidate
+}
+
+void Gfx::Texture::Unlock(uint32_t firstRow, uint32_t numRows)
+{
+    Unlock();
+}
+
+void Gfx::Texture::Delete()
+{
+    if (!wrapped) {
+        free(image);
+    }
+    delete this;
+}
@@ -0,0 +1,155 @@
+#include "HostStub.hpp"
+
+#include <coreinit/time.h>
+#include <coreinit/memfrmheap.h>
+#include <coreinit/memory.h>
+#include <coreinit/title.h>
+
+#include <chrono>
+#include <vector>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALIGN_UP(x, align) (((x) + ((align) - 1)) & ~((align) - 1))
+
+// Same title ID as the Homebrew Launcher so exiting returns from main instead of launching the Wii U Menu
+#define HOST_TITLE_ID 0x0005000013374842
+
+// Sizes of the foreground heaps on the console
+#define MEM1_HEAP_SIZE (32 * 1024 * 1024)
+#define FG_HEAP_SIZE (40 * 1024 * 1024)
+
+#define DEFAULT_FONT_PATH "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf"
+
+struct MEMHeapHeader {
+    uint8_t* base;
+    uint32_t size;
+    uint32_t head;
+};
+
+static MEMHeapHeader mem1Heap = { nullptr, MEM1_HEAP_SIZE, 0 };
+static MEMHeapHeader fgHeap = { nullptr, FG_HEAP_SIZE, 0 };
+
+static std::vector<uint8_t> fontData;
+
+OSTime OSGetTime()
+{
+    uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return (OSTime) OSMicrosecondsToTicks(us);
+}
+
+OSTime OSGetSystemTime()
+{
+    return OSGetTime();
+}
+
+OSTick OSGetTick()
+{
+    return (OSTick) OSGetTime();
+}
+
+uint64_t OSGetTitleID()
+{
+    return HOST_TITLE_ID;
+}
+
+BOOL OSGetSharedData(OSSharedDataType type, uint32_t unk_r4, void** outPtr, uint32_t* outSize)
+{
+    // Load the font from the host once and keep it around like the shared area on the console
+    if (fontData.empty()) {
+        const char* path = getenv("HOST_FONT");
+        FILE* f = fopen(path ? path : DEFAULT_FONT_PATH, "rb");
+        if (!f) {
+            return FALSE;
+        }
+
+        fseek(f, 0, SEEK_END);
+        fontData.resize(ftell(f));
+        fseek(f, 0, SEEK_SET);
+        size_t read = fread(fontData.data(), 1, fontData.size(), f);
+        fclose(f);
+
+        if (read != fontData.size()) {
+            fontData.clear();
+            return FALSE;
+        }
+    }
+
+    *outPtr = fontData.data();
+    *outSize = fontData.size();
+    return TRUE;
+}
+
+void OSReport(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+}
+
+void DCFlushRange(void* addr, uint32_t size)
+{
+}
+
+void DCStoreRange(void* addr, uint32_t size)
+{
+}
+
+void DCInvalidateRange(void* addr, uint32_t size)
+{
+}
+
+MEMHeapHandle MEMGetBaseHeapHandle(MEMBaseHeapType type)
+{
+    MEMHeapHandle heap;
+    switch (type) {
+    case MEM_BASE_HEAP_MEM1:
+        heap = &mem1Heap;
+        break;
+    case MEM_BASE_HEAP_FG:
+        heap = &fgHeap;
+        break;
+    default:
+        return nullptr;
+    }
+
+    // Reserve the heap on first use
+    if (!heap->base) {
+        heap->base = (uint8_t*) aligned_alloc(0x1000, heap->size);
+    }
+
+    return heap;
+}
+
+void* MEMAllocFromFrmHeapEx(MEMHeapHandle heap, uint32_t size, int alignment)
+{
+    // Negative alignments allocate from the tail on the console, the stub only has a head
+    uint32_t align = alignment < 0 ? -alignment : alignment;
+    uint32_t offset = ALIGN_UP(heap->head, align);
+    if (!heap->base || offset + size > heap->size) {
+        return nullptr;
+    }
+
+    heap->head = offset + size;
+    return heap->base + offset;
+}
+
+void MEMFreeToFrmHeap(MEMHeapHandle heap, MEMFrameHeapFreeMode mode)
+{
+    if (mode & MEM_FRM_HEAP_FREE_HEAD) {
+        // Other processes use the memory in the background, make lost contents obvious
+        memset(heap->base, 0xCD, heap->head);
+        heap->head = 0;
+    }
+}
+
+uint32_t MEMGetAllocatableSizeForFrmHeapEx(MEMHeapHandle heap, int alignment)
+{
+    uint32_t align = alignment < 0 ? -alignment : alignment;
+    uint32_t offset = ALIGN_UP(heap->head, align);
+    return offset < heap->size ? heap->size - offset : 0;
+}
@@ -0,0 +1,564 @@
+#include "HostStub.hpp"
+
+#include <gx2/draw.h>
+#include <whb/gfx.h>
+
+#include <chrono>
+#include <initializer_list>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Same clock as the GPU timestamps on the console
+#define GPU_CLOCK_RATE 27000000ull
+
+#define ALIGN_UP(x, align) (((x) + ((align) - 1)) & ~((align) - 1))
+
+// Generic uniform layout of the stub shaders, every uniform takes one vec4 register block
+#define STUB_NUM_UNIFORMS 4
+#define STUB_UNIFORM_STRIDE 4
+
+static FILE* traceFile = nullptr;
+static std::vector<uint8_t> frameRecords;
+
+static HostStub::FrameCounters currentFrame;
+static HostStub::FrameCounters lastFrame;
+static uint32_t frameNumber = 0;
+
+static uint64_t submittedTimeStamp = 0;
+static uint32_t swapCount = 0;
+static OSTime lastFlip = 0;
+
+static const char* const callNames[] = {
+#define GX2_TRACE_NAME(name) #name,
+    GX2_TRACE_CALLS(GX2_TRACE_NAME)
+#undef GX2_TRACE_NAME
+};
+
+const char* GX2TraceGetCallName(GX2TraceCall call)
+{
+    if (call >= GX2_TRACE_NUM_CALLS) {
+        return "Unknown";
+    }
+
+    return callNames[call];
+}
+
+bool GX2TraceIsStateChange(GX2TraceCall call)
+{
+    switch (call) {
+    case GX2_TRACE_SetContextState:
+    case GX2_TRACE_SetColorBuffer:
+    case GX2_TRACE_SetViewport:
+    case GX2_TRACE_SetScissor:
+    case GX2_TRACE_SetDepthOnlyControl:
+    case GX2_TRACE_SetColorControl:
+    case GX2_TRACE_SetBlendControl:
+    case GX2_TRACE_SetAlphaTest:
+    case GX2_TRACE_SetFetchShader:
+    case GX2_TRACE_SetVertexShader:
+    case GX2_TRACE_SetPixelShader:
+    case GX2_TRACE_SetPixelTexture:
+    case GX2_TRACE_SetPixelSampler:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static uint32_t FloatBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static void Record(GX2TraceCall call, std::initializer_list<uint32_t> args, const void* data = nullptr, uint32_t dataWords = 0)
+{
+    uint32_t numWords = args.size() + dataWords;
+    uint32_t size = sizeof(GX2TraceRecord) + numWords * sizeof(uint32_t);
+
+    currentFrame.calls++;
+    currentFrame.bytes += size;
+    currentFrame.callCounts[call]++;
+    if (GX2TraceIsStateChange(call)) {
+        currentFrame.stateChanges++;
+    }
+
+    if (!traceFile) {
+        return;
+    }
+
+    GX2TraceRecord record = { call, (uint8_t) numWords };
+    const uint8_t* recordPtr = (const uint8_t*) &record;
+    frameRecords.insert(frameRecords.end(), recordPtr, recordPtr + sizeof(record));
+    for (uint32_t arg : args) {
+        const uint8_t* argPtr = (const uint8_t*) &arg;
+        frameRecords.insert(frameRecords.end(), argPtr, argPtr + sizeof(arg));
+    }
+    if (data) {
+        const uint8_t* dataPtr = (const uint8_t*) data;
+        frameRecords.insert(frameRecords.end(), dataPtr, dataPtr + dataWords * sizeof(uint32_t));
+    }
+}
+
+// Surfaces are described by their layout instead of their address
+#define SURFACE_ARGS(s) (s)->width, (s)->height, (uint32_t) (s)->format, (uint32_t) (s)->tileMode
+
+static void EndFrame()
+{
+    Record(GX2_TRACE_FrameEnd, { frameNumber, currentFrame.calls + 1, (uint32_t) (currentFrame.bytes + sizeof(GX2TraceRecord) + 3 * sizeof(uint32_t)) });
+
+    if (traceFile) {
+        fwrite(frameRecords.data(), 1, frameRecords.size(), traceFile);
+        frameRecords.clear();
+    }
+
+    currentFrame.frame = frameNumber;
+    lastFrame = currentFrame;
+    memset(&currentFrame, 0, sizeof(currentFrame));
+    frameNumber++;
+
+    HostStub::OnFrameEnd();
+}
+
+static uint32_t GetBytesPerPixel(GX2SurfaceFormat format)
+{
+    switch (format) {
+    case GX2_SURFACE_FORMAT_UNORM_R8:
+        return 1;
+    case GX2_SURFACE_FORMAT_FLOAT_R16_G16_B16_A16:
+        return 8;
+    default:
+        return 4;
+    }
+}
+
+static OSTime GetGpuCycles()
+{
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return (ns / 1000) * (GPU_CLOCK_RATE / 1000000);
+}
+
+bool HostStub::OpenTrace(const char* path)
+{
+    CloseTrace();
+
+    traceFile = fopen(path, "wb");
+    if (!traceFile) {
+        return false;
+    }
+
+    GX2TraceHeader header = { GX2_TRACE_MAGIC, GX2_TRACE_VERSION };
+    fwrite(&header, sizeof(header), 1, traceFile);
+
+    return true;
+}
+
+void HostStub::CloseTrace()
+{
+    if (!traceFile) {
+        return;
+    }
+
+    // Keep the calls of an unfinished frame
+    fwrite(frameRecords.data(), 1, frameRecords.size(), traceFile);
+    frameRecords.clear();
+
+    fclose(traceFile);
+    traceFile = nullptr;
+}
+
+HostStub::FrameCounters const& HostStub::GetLastFrame()
+{
+    return lastFrame;
+}
+
+uint32_t HostStub::GetFrame()
+{
+    return frameNumber;
+}
+
+void GX2Init(uint32_t* attributes)
+{
+    Record(GX2_TRACE_Init, {});
+}
+
+void GX2Shutdown()
+{
+    Record(GX2_TRACE_Shutdown, {});
+}
+
+void GX2Flush()
+{
+    Record(GX2_TRACE_Flush, {});
+
+    // Commands are retired as soon as they are submitted
+    submittedTimeStamp++;
+}
+
+void GX2DrawDone()
+{
+    Record(GX2_TRACE_DrawDone, {});
+    submittedTimeStamp++;
+}
+
+GX2TVScanMode GX2GetSystemTVScanMode()
+{
+    Record(GX2_TRACE_GetSystemTVScanMode, {});
+    return GX2_TV_SCAN_MODE_720P;
+}
+
+GX2DrcRenderMode GX2GetSystemDRCMode()
+{
+    Record(GX2_TRACE_GetSystemDRCMode, {});
+    return HostStub::GetConnectedDrcs() > 1 ? GX2_DRC_RENDER_MODE_DOUBLE : GX2_DRC_RENDER_MODE_SINGLE;
+}
+
+void GX2CalcTVSize(GX2TVRenderMode tvRenderMode, GX2SurfaceFormat surfaceFormat, GX2BufferingMode bufferingMode, uint32_t* size, uint32_t* unkOut)
+{
+    Record(GX2_TRACE_CalcTVSize, { (uint32_t) tvRenderMode, (uint32_t) surfaceFormat, (uint32_t) bufferingMode });
+
+    uint32_t width = 1280;
+    uint32_t height = 720;
+    if (tvRenderMode == GX2_TV_RENDER_MODE_WIDE_1080P) {
+        width = 1920;
+        height = 1080;
+    } else if (tvRenderMode != GX2_TV_RENDER_MODE_WIDE_720P) {
+        width = 854;
+        height = 480;
+    }
+
+    *size = ALIGN_UP(width, 64) * height * GetBytesPerPixel(surfaceFormat) * bufferingMode;
+    *unkOut = 0;
+}
+
+void GX2CalcDRCSize(GX2DrcRenderMode drcRenderMode, GX2SurfaceFormat surfaceFormat, GX2BufferingMode bufferingMode, uint32_t* size, uint32_t* unkOut)
+{
+    Record(GX2_TRACE_CalcDRCSize, { (uint32_t) drcRenderMode, (uint32_t) surfaceFormat, (uint32_t) bufferingMode });
+
+    // Double render mode has scan buffers for both GamePads
+    *size = ALIGN_UP(854, 64) * 480 * GetBytesPerPixel(surfaceFormat) * bufferingMode * (uint32_t) drcRenderMode;
+    *unkOut = 0;
+}
+
+void GX2SetTVBuffer(void* buffer, uint32_t size, GX2TVRenderMode tvRenderMode, GX2SurfaceFormat surfaceFormat, GX2BufferingMode bufferingMode)
+{
+    Record(GX2_TRACE_SetTVBuffer, { size, (uint32_t) tvRenderMode, (uint32_t) surfaceFormat, (uint32_t) bufferingMode });
+}
+
+void GX2SetDRCBuffer(void* buffer, uint32_t size, GX2DrcRenderMode drcRenderMode, GX2SurfaceFormat surfaceFormat, GX2BufferingMode bufferingMode)
+{
+    Record(GX2_TRACE_SetDRCBuffer, { size, (uint32_t) drcRenderMode, (uint32_t) surfaceFormat, (uint32_t) bufferingMode });
+}
+
+void GX2SetTVScale(uint32_t x, uint32_t y)
+{
+    Record(GX2_TRACE_SetTVScale, { x, y });
+}
+
+void GX2SetDRCScale(uint32_t x, uint32_t y)
+{
+    Record(GX2_TRACE_SetDRCScale, { x, y });
+}
+
+void GX2SetTVEnable(BOOL enable)
+{
+    Record(GX2_TRACE_SetTVEnable, { (uint32_t) enable });
+}
+
+void GX2SetDRCEnable(BOOL enable)
+{
+    Record(GX2_TRACE_SetDRCEnable, { (uint32_t) enable });
+}
+
+void GX2SetSwapInterval(uint32_t interval)
+{
+    Record(GX2_TRACE_SetSwapInterval, { interval });
+}
+
+void GX2SwapScanBuffers()
+{
+    Record(GX2_TRACE_SwapScanBuffers, {});
+
+    // There is no display, every swap flips immediately on the next vsync of a virtual 60Hz
+    // display. The game then runs one step per frame however fast the host renders.
+    if (!lastFlip) {
+        lastFlip = OSGetTime();
+    } else {
+        lastFlip += OSSecondsToTicks(1) / 60;
+    }
+    swapCount++;
+
+    EndFrame();
+}
+
+void GX2GetSwapStatus(uint32_t* swapCount, uint32_t* flipCount, OSTime* lastFlip, OSTime* lastVsync)
+{
+    Record(GX2_TRACE_GetSwapStatus, {});
+
+    *swapCount = ::swapCount;
+    *flipCount = ::swapCount;
+    *lastFlip = ::lastFlip;
+    *lastVsync = ::lastFlip;
+}
+
+void GX2WaitForVsync()
+{
+    Record(GX2_TRACE_WaitForVsync, {});
+}
+
+void GX2CopyColorBufferToScanBuffer(const GX2ColorBuffer* buffer, GX2ScanTarget scanTarget)
+{
+    Record(GX2_TRACE_CopyColorBufferToScanBuffer, { SURFACE_ARGS(&buffer->surface), (uint32_t) scanTarget });
+}
+
+void GX2CalcSurfaceSizeAndAlignment(GX2Surface* surface)
+{
+    // Tiled surfaces use whole 8x8 micro tiles, the pitch is always a multiple of 64 pixels
+    if (surface->tileMode == GX2_TILE_MODE_DEFAULT) {
+        surface->tileMode = GX2_TILE_MODE_TILED_2D_THIN1;
+    }
+
+    bool linear = surface->tileMode == GX2_TILE_MODE_LINEAR_ALIGNED || surface->tileMode == GX2_TILE_MODE_LINEAR_SPECIAL;
+    uint32_t height = linear ? surface->height : ALIGN_UP(surface->height, 8);
+
+    surface->pitch = ALIGN_UP(surface->width, 64);
+    surface->alignment = linear ? 0x100 : 0x800;
+    surface->imageSize = surface->pitch * height * surface->depth * GetBytesPerPixel(surface->format);
+    surface->mipmapSize = 0;
+
+    Record(GX2_TRACE_CalcSurfaceSizeAndAlignment, { SURFACE_ARGS(surface), surface->imageSize });
+}
+
+void GX2InitColorBufferRegs(GX2ColorBuffer* colorBuffer)
+{
+    Record(GX2_TRACE_InitColorBufferRegs, { SURFACE_ARGS(&colorBuffer->surface) });
+}
+
+void GX2InitTextureRegs(GX2Texture* texture)
+{
+    Record(GX2_TRACE_InitTextureRegs, { SURFACE_ARGS(&texture->surface), texture->compMap });
+}
+
+void GX2InitSampler(GX2Sampler* sampler, GX2TexClampMode clampMode, GX2TexXYFilterMode minMagFilterMode)
+{
+    Record(GX2_TRACE_InitSampler, { (uint32_t) clampMode, (uint32_t) minMagFilterMode });
+
+    sampler->regs[0] = clampMode;
+    sampler->regs[1] = minMagFilterMode;
+    sampler->regs[2] = 0;
+}
+
+void GX2InitSamplerClamping(GX2Sampler* sampler, GX2TexClampMode clampX, GX2TexClampMode clampY, GX2TexClampMode clampZ)
+{
+    Record(GX2_TRACE_InitSamplerClamping, { (uint32_t) clampX, (uint32_t) clampY, (uint32_t) clampZ });
+
+    sampler->regs[0] = clampX;
+}
+
+void GX2InitSamplerXYFilter(GX2Sampler* sampler, GX2TexXYFilterMode filterMag, GX2TexXYFilterMode filterMin, GX2TexAnisoRatio maxAniso)
+{
+    Record(GX2_TRACE_InitSamplerXYFilter, { (uint32_t) filterMag, (uint32_t) filterMin, (uint32_t) maxAniso });
+
+    sampler->regs[1] = filterMag;
+}
+
+void GX2CopySurface(const GX2Surface* src, uint32_t srcLevel, uint32_t srcDepth, GX2Surface* dst, uint32_t dstLevel, uint32_t dstDepth)
+{
+    Record(GX2_TRACE_CopySurface, { SURFACE_ARGS(src), SURFACE_ARGS(dst) });
+
+    // Nothing is rendered, the copy reads back an empty surface
+    if (dst->image) {
+        memset(dst->image, 0, dst->imageSize);
+    }
+}
+
+void GX2Invalidate(GX2InvalidateMode mode, void* buffer, uint32_t size)
+{
+    Record(GX2_TRACE_Invalidate, { (uint32_t) mode, size });
+}
+
+void GX2SetupContextStateEx(GX2ContextState* state, BOOL unk1)
+{
+    Record(GX2_TRACE_SetupContextStateEx, { (uint32_t) unk1 });
+}
+
+void GX2SetContextState(GX2ContextState* state)
+{
+    Record(GX2_TRACE_SetContextState, {});
+}
+
+void GX2SetColorBuffer(const GX2ColorBuffer* colorBuffer, GX2RenderTarget target)
+{
+    Record(GX2_TRACE_SetColorBuffer, { SURFACE_ARGS(&colorBuffer->surface), (uint32_t) target });
+}
+
+void GX2SetViewport(float x, float y, float width, float height, float nearZ, float farZ)
+{
+    Record(GX2_TRACE_SetViewport, { FloatBits(x), FloatBits(y), FloatBits(width), FloatBits(height), FloatBits(nearZ), FloatBits(farZ) });
+}
+
+void GX2SetScissor(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+    Record(GX2_TRACE_SetScissor, { x, y, width, height });
+}
+
+void GX2SetDepthOnlyControl(BOOL depthTest, BOOL depthWrite, GX2CompareFunction depthCompare)
+{
+    Record(GX2_TRACE_SetDepthOnlyControl, { (uint32_t) depthTest, (uint32_t) depthWrite, (uint32_t) depthCompare });
+}
+
+void GX2SetColorControl(GX2LogicOp rop3, uint8_t targetBlendEnable, BOOL multiWriteEnable, BOOL colorWriteEnable)
+{
+    Record(GX2_TRACE_SetColorControl, { (uint32_t) rop3, targetBlendEnable, (uint32_t) multiWriteEnable, (uint32_t) colorWriteEnable });
+}
+
+void GX2SetBlendControl(GX2RenderTarget target, GX2BlendMode colorSrcBlend, GX2BlendMode colorDstBlend, GX2BlendCombineMode colorCombine,
+    BOOL useAlphaBlend, GX2BlendMode alphaSrcBlend, GX2BlendMode alphaDstBlend, GX2BlendCombineMode alphaCombine)
+{
+    Record(GX2_TRACE_SetBlendControl, { (uint32_t) target, (uint32_t) colorSrcBlend, (uint32_t) colorDstBlend, (uint32_t) colorCombine,
+        (uint32_t) useAlphaBlend, (uint32_t) alphaSrcBlend, (uint32_t) alphaDstBlend, (uint32_t) alphaCombine });
+}
+
+void GX2SetAlphaTest(BOOL alphaTest, GX2CompareFunction func, float ref)
+{
+    Record(GX2_TRACE_SetAlphaTest, { (uint32_t) alphaTest, (uint32_t) func, FloatBits(ref) });
+}
+
+void GX2ClearColor(GX2ColorBuffer* colorBuffer, float red, float green, float blue, float alpha)
+{
+    Record(GX2_TRACE_ClearColor, { SURFACE_ARGS(&colorBuffer->surface), FloatBits(red), FloatBits(green), FloatBits(blue), FloatBits(alpha) });
+}
+
+void GX2SetFetchShader(const GX2FetchShader* shader)
+{
+    Record(GX2_TRACE_SetFetchShader, { shader->size });
+}
+
+void GX2SetVertexShader(const GX2VertexShader* shader)
+{
+    Record(GX2_TRACE_SetVertexShader, { shader->numUniforms });
+}
+
+void GX2SetPixelShader(const GX2PixelShader* shader)
+{
+    Record(GX2_TRACE_SetPixelShader, { shader->numUniforms, shader->numSamplerVars });
+}
+
+void GX2SetVertexUniformReg(uint32_t offset, uint32_t count, const void* data)
+{
+    Record(GX2_TRACE_SetVertexUniformReg, { offset, count }, data, count);
+    currentFrame.dataBytes += count * sizeof(uint32_t);
+}
+
+void GX2SetPixelUniformReg(uint32_t offset, uint32_t count, const void* data)
+{
+    Record(GX2_TRACE_SetPixelUniformReg, { offset, count }, data, count);
+    currentFrame.dataBytes += count * sizeof(uint32_t);
+}
+
+void GX2SetPixelTexture(const GX2Texture* texture, uint32_t unit)
+{
+    Record(GX2_TRACE_SetPixelTexture, { SURFACE_ARGS(&texture->surface), unit });
+}
+
+void GX2SetPixelSampler(const GX2Sampler* sampler, uint32_t unit)
+{
+    Record(GX2_TRACE_SetPixelSampler, { sampler->regs[0], sampler->regs[1], unit });
+}
+
+void GX2SetAttribBuffer(uint32_t index, uint32_t size, uint32_t stride, const void* buffer)
+{
+    Record(GX2_TRACE_SetAttribBuffer, { index, size, stride });
+    currentFrame.dataBytes += size;
+}
+
+void GX2DrawEx(GX2PrimitiveMode mode, uint32_t count, uint32_t offset, uint32_t numInstances)
+{
+    Record(GX2_TRACE_DrawEx, { (uint32_t) mode, count, offset, numInstances });
+    currentFrame.drawCalls++;
+}
+
+uint64_t GX2GetLastSubmittedTimeStamp()
+{
+    Record(GX2_TRACE_GetLastSubmittedTimeStamp, {});
+    return submittedTimeStamp;
+}
+
+uint64_t GX2GetRetiredTimeStamp()
+{
+    Record(GX2_TRACE_GetRetiredTimeStamp, {});
+    return submittedTimeStamp;
+}
+
+BOOL GX2WaitTimeStamp(uint64_t time)
+{
+    Record(GX2_TRACE_WaitTimeStamp, {});
+    return TRUE;
+}
+
+void GX2SampleBottomGPUCycle(uint64_t* cycle)
+{
+    Record(GX2_TRACE_SampleBottomGPUCycle, {});
+
+    // The GPU finishes instantly, sample the CPU clock instead
+    *cycle = GetGpuCycles();
+}
+
+BOOL WHBGfxLoadGFDShaderGroup(WHBGfxShaderGroup* group, uint32_t index, const void* file)
+{
+    memset(group, 0, sizeof(WHBGfxShaderGroup));
+    if (!file) {
+        return FALSE;
+    }
+
+    // The shaders are never executed, give them a generic uniform layout
+    group->vertexShader = (GX2VertexShader*) calloc(1, sizeof(GX2VertexShader));
+    group->vertexShader->numUniforms = STUB_NUM_UNIFORMS;
+    group->vertexShader->uniformVars = (GX2UniformVar*) calloc(STUB_NUM_UNIFORMS, sizeof(GX2UniformVar));
+
+    group->pixelShader = (GX2PixelShader*) calloc(1, sizeof(GX2PixelShader));
+    group->pixelShader->numUniforms = STUB_NUM_UNIFORMS;
+    group->pixelShader->uniformVars = (GX2UniformVar*) calloc(STUB_NUM_UNIFORMS, sizeof(GX2UniformVar));
+    group->pixelShader->numSamplerVars = 1;
+    group->pixelShader->samplerVars = (GX2SamplerVar*) calloc(1, sizeof(GX2SamplerVar));
+
+    for (uint32_t i = 0; i < STUB_NUM_UNIFORMS; ++i) {
+        group->vertexShader->uniformVars[i].offset = i * STUB_UNIFORM_STRIDE;
+        group->pixelShader->uniformVars[i].offset = i * STUB_UNIFORM_STRIDE;
+    }
+
+    return TRUE;
+}
+
+BOOL WHBGfxInitShaderAttribute(WHBGfxShaderGroup* group, const char* name, uint32_t buffer, uint32_t offset, GX2AttribFormat format)
+{
+    group->numAttributes++;
+    return TRUE;
+}
+
+BOOL WHBGfxInitFetchShader(WHBGfxShaderGroup* group)
+{
+    group->fetchShader.size = group->numAttributes;
+    return TRUE;
+}
+
+BOOL WHBGfxFreeShaderGroup(WHBGfxShaderGroup* group)
+{
+    if (group->vertexShader) {
+        free(group->vertexShader->uniformVars);
+        free(group->vertexShader);
+    }
+
+    if (group->pixelShader) {
+        free(group->pixelShader->uniformVars);
+        free(group->pixelShader->samplerVars);
+        free(group->pixelShader);
+    }
+
+    memset(group, 0, sizeof(WHBGfxShaderGroup));
+    return TRUE;
+}
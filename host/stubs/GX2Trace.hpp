@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+
+// Binary trace of every GX2 call made through the host stubs.
+// A trace starts with a GX2TraceHeader followed by records. Every record is a GX2TraceRecord
+// followed by numWords little endian 32-bit arguments. Pointers are never written, objects
+// are described by their contents (surface size and format, uniform values, buffer sizes)
+// so traces of the same input compare equal between runs.
+// Every frame ends with a GX2_TRACE_FRAME_END record holding the frame number, the number of calls
+// and the number of trace bytes of the frame.
+
+#define GX2_TRACE_MAGIC 0x54325847 // "GX2T"
+#define GX2_TRACE_VERSION 1
+
+#define GX2_TRACE_CALLS(X) \
+    X(Init) \
+    X(Shutdown) \
+    X(Flush) \
+    X(DrawDone) \
+    X(GetSystemTVScanMode) \
+    X(GetSystemDRCMode) \
+    X(CalcTVSize) \
+    X(CalcDRCSize) \
+    X(SetTVBuffer) \
+    X(SetDRCBuffer) \
+    X(SetTVScale) \
+    X(SetDRCScale) \
+    X(SetTVEnable) \
+    X(SetDRCEnable) \
+    X(SetSwapInterval) \
+    X(SwapScanBuffers) \
+    X(GetSwapStatus) \
+    X(WaitForVsync) \
+    X(CopyColorBufferToScanBuffer) \
+    X(CalcSurfaceSizeAndAlignment) \
+    X(InitColorBufferRegs) \
+    X(InitTextureRegs) \
+    X(InitSampler) \
+    X(InitSamplerClamping) \
+    X(InitSamplerXYFilter) \
+    X(CopySurface) \
+    X(Invalidate) \
+    X(SetupContextStateEx) \
+    X(SetContextState) \
+    X(SetColorBuffer) \
+    X(SetViewport) \
+    X(SetScissor) \
+    X(SetDepthOnlyControl) \
+    X(SetColorControl) \
+    X(SetBlendControl) \
+    X(SetAlphaTest) \
+    X(ClearColor) \
+    X(SetFetchShader) \
+    X(SetVertexShader) \
+    X(SetPixelShader) \
+    X(SetVertexUniformReg) \
+    X(SetPixelUniformReg) \
+    X(SetPixelTexture) \
+    X(SetPixelSampler) \
+    X(SetAttribBuffer) \
+    X(DrawEx) \
+    X(GetLastSubmittedTimeStamp) \
+    X(GetRetiredTimeStamp) \
+    X(WaitTimeStamp) \
+    X(SampleBottomGPUCycle) \
+    X(FrameEnd)
+
+enum GX2TraceCall : uint8_t {
+#define GX2_TRACE_ENUM(name) GX2_TRACE_##name,
+    GX2_TRACE_CALLS(GX2_TRACE_ENUM)
+#undef GX2_TRACE_ENUM
+
+    GX2_TRACE_NUM_CALLS,
+};
+
+struct GX2TraceHeader {
+    uint32_t magic;
+    uint32_t version;
+};
+
+struct GX2TraceRecord {
+    GX2TraceCall call;
+    uint8_t numWords;
+};
+
+// Name of a call without the GX2 prefix
+const char* GX2TraceGetCallName(GX2TraceCall call);
+
+// Calls which change GPU state, used for state change budgets
+bool GX2TraceIsStateChange(GX2TraceCall call);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "GX2Trace.hpp"
+
+// Control interface of the host stubs for tools, tests and benchmarks.
+// WHBProcInit also reads the configuration from the environment:
+//   HOST_TRACE   path of the binary GX2 trace to write
+//   HOST_INPUT   path of a scripted VPAD input file
+//   HOST_FRAMES  number of frames until WHBProcIsRunning returns false
+//   HOST_FONT    font returned by OSGetSharedData
+//   HOST_DRCS    number of connected GamePads (1 or 2)
+class HostStub {
+public:
+    struct FrameCounters {
+        uint32_t frame;
+        // GX2 calls and encoded trace bytes of the frame
+        uint32_t calls;
+        uint32_t bytes;
+        // Vertex and uniform data passed to the GPU
+        uint32_t dataBytes;
+        uint32_t drawCalls;
+        uint32_t stateChanges;
+        uint32_t callCounts[GX2_TRACE_NUM_CALLS];
+    };
+
+    // Record all following GX2 calls into a file, returns false if the file can't be created
+    static bool OpenTrace(const char* path);
+
+    static void CloseTrace();
+
+    // Counters of the last finished frame
+    static FrameCounters const& GetLastFrame();
+
+    // Number of frames swapped so far
+    static uint32_t GetFrame();
+
+    // Stop running after this many frames, 0 runs until WHBProcStopRunning
+    static void SetFrameLimit(uint32_t frames);
+
+    // Load a script for the VPAD and system events, see InputStub.cpp for the format
+    static bool LoadInputScript(const char* path);
+
+    // Frame of the last event in the input script
+    static uint32_t GetInputScriptLength();
+
+    static void SetConnectedDrcs(uint32_t count);
+
+    static uint32_t GetConnectedDrcs();
+
+    // Send the foreground release and acquire callbacks as if the HOME Menu was opened and closed
+    static void SimulateHomeMenu();
+
+    // Finish a pending CCRSys pairing
+    static void SimulatePairing(bool success);
+
+    // Press the SYNC button on the console
+    static void SimulateSyncButton();
+
+    // Called by GX2SwapScanBuffers to advance the input script
+    static void OnFrameEnd();
+};
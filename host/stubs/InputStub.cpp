@@ -0,0 +1,267 @@
+#include "HostStub.hpp"
+
+#include <vpad/input.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <string.h>
+#include <strings.h>
+
+// Scripted input for the host stubs.
+// Every line of a script is "<frame> <command> [arguments]", empty lines and lines starting with # are ignored.
+// Commands take effect at the start of their frame, GamePad state is held until it changes again:
+//   pad <chan> <buttons> [lx ly [rx ry]]  buttons are names joined with | (A|ZR) or - for none
+//   home                                  open and close the HOME Menu
+//   pair ok|fail                          finish a pending pairing
+//   sync                                  press the SYNC button on the console
+//   exit                                  stop running
+
+#define NUM_CHANNELS 2
+
+// Stick position which triggers the emulated d-pad buttons
+#define STICK_EMULATION_THRESHOLD 0.5f
+
+struct ScriptEvent {
+    enum Type {
+        EVENT_PAD,
+        EVENT_HOME,
+        EVENT_PAIR,
+        EVENT_SYNC,
+        EVENT_EXIT,
+    };
+
+    uint32_t frame;
+    Type type;
+    uint32_t chan;
+    uint32_t buttons;
+    VPADVec2D leftStick;
+    VPADVec2D rightStick;
+    bool success;
+};
+
+static const struct {
+    const char* name;
+    uint32_t button;
+} buttonNames[] = {
+    { "A", VPAD_BUTTON_A },
+    { "B", VPAD_BUTTON_B },
+    { "X", VPAD_BUTTON_X },
+    { "Y", VPAD_BUTTON_Y },
+    { "LEFT", VPAD_BUTTON_LEFT },
+    { "RIGHT", VPAD_BUTTON_RIGHT },
+    { "UP", VPAD_BUTTON_UP },
+    { "DOWN", VPAD_BUTTON_DOWN },
+    { "ZL", VPAD_BUTTON_ZL },
+    { "ZR", VPAD_BUTTON_ZR },
+    { "L", VPAD_BUTTON_L },
+    { "R", VPAD_BUTTON_R },
+    { "PLUS", VPAD_BUTTON_PLUS },
+    { "MINUS", VPAD_BUTTON_MINUS },
+    { "HOME", VPAD_BUTTON_HOME },
+    { "STICK_L", VPAD_BUTTON_STICK_L },
+    { "STICK_R", VPAD_BUTTON_STICK_R },
+    { "TV", VPAD_BUTTON_TV },
+};
+
+static std::vector<ScriptEvent> scriptEvents;
+static size_t nextEvent = 0;
+
+// Scripted state and the sample returned for the current frame
+static VPADStatus padState[NUM_CHANNELS];
+static VPADStatus padSample[NUM_CHANNELS];
+
+static bool ParseButtons(std::string const& str, uint32_t* buttons)
+{
+    *buttons = 0;
+    if (str == "-") {
+        return true;
+    }
+
+    std::stringstream stream(str);
+    std::string name;
+    while (std::getline(stream, name, '|')) {
+        bool found = false;
+        for (auto const& entry : buttonNames) {
+            if (strcasecmp(entry.name, name.c_str()) == 0) {
+                *buttons |= entry.button;
+                found = true;
+                break;
+            }
+        }
+
+        if (!found) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static uint32_t GetStickEmulation(VPADVec2D stick, uint32_t left, uint32_t right, uint32_t up, uint32_t down)
+{
+    uint32_t buttons = 0;
+    if (stick.x <= -STICK_EMULATION_THRESHOLD) {
+        buttons |= left;
+    } else if (stick.x >= STICK_EMULATION_THRESHOLD) {
+        buttons |= right;
+    }
+
+    if (stick.y >= STICK_EMULATION_THRESHOLD) {
+        buttons |= up;
+    } else if (stick.y <= -STICK_EMULATION_THRESHOLD) {
+        buttons |= down;
+    }
+
+    return buttons;
+}
+
+static void UpdateSamples()
+{
+    for (uint32_t i = 0; i < NUM_CHANNELS; ++i) {
+        VPADStatus& state = padState[i];
+        VPADStatus& sample = padSample[i];
+
+        uint32_t hold = state.hold |
+            GetStickEmulation(state.leftStick, VPAD_STICK_L_EMULATION_LEFT, VPAD_STICK_L_EMULATION_RIGHT,
+                VPAD_STICK_L_EMULATION_UP, VPAD_STICK_L_EMULATION_DOWN) |
+            GetStickEmulation(state.rightStick, VPAD_STICK_R_EMULATION_LEFT, VPAD_STICK_R_EMULATION_RIGHT,
+                VPAD_STICK_R_EMULATION_UP, VPAD_STICK_R_EMULATION_DOWN);
+
+        // Edges are relative to the sample of the previous frame
+        sample.trigger = hold & ~sample.hold;
+        sample.release = sample.hold & ~hold;
+        sample.hold = hold;
+        sample.leftStick = state.leftStick;
+        sample.rightStick = state.rightStick;
+        sample.error = VPAD_READ_SUCCESS;
+        sample.battery = 6;
+    }
+}
+
+static void ApplyEvents(uint32_t frame)
+{
+    while (nextEvent < scriptEvents.size() && scriptEvents[nextEvent].frame <= frame) {
+        ScriptEvent& event = scriptEvents[nextEvent++];
+        switch (event.type) {
+        case ScriptEvent::EVENT_PAD:
+            padState[event.chan].hold = event.buttons;
+            padState[event.chan].leftStick = event.leftStick;
+            padState[event.chan].rightStick = event.rightStick;
+            break;
+        case ScriptEvent::EVENT_HOME:
+            HostStub::SimulateHomeMenu();
+            break;
+        case ScriptEvent::EVENT_PAIR:
+            HostStub::SimulatePairing(event.success);
+            break;
+        case ScriptEvent::EVENT_SYNC:
+            HostStub::SimulateSyncButton();
+            break;
+        case ScriptEvent::EVENT_EXIT:
+            HostStub::SetFrameLimit(frame);
+            break;
+        }
+    }
+
+    UpdateSamples();
+}
+
+bool HostStub::LoadInputScript(const char* path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<ScriptEvent> events;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream stream(line);
+        std::string command;
+
+        ScriptEvent event{};
+        if (!(stream >> event.frame >> command)) {
+            // Skip empty lines and comments
+            stream.clear();
+            stream.str(line);
+            if (!(stream >> command) || command[0] == '#') {
+                continue;
+            }
+
+            return false;
+        }
+
+        if (command == "pad") {
+            std::string buttons;
+            if (!(stream >> event.chan >> buttons) || event.chan >= NUM_CHANNELS || !ParseButtons(buttons, &event.buttons)) {
+                return false;
+            }
+
+            // Sticks are optional
+            stream >> event.leftStick.x >> event.leftStick.y >> event.rightStick.x >> event.rightStick.y;
+            event.type = ScriptEvent::EVENT_PAD;
+        } else if (command == "home") {
+            event.type = ScriptEvent::EVENT_HOME;
+        } else if (command == "pair") {
+            std::string result;
+            stream >> result;
+            event.type = ScriptEvent::EVENT_PAIR;
+            event.success = result == "ok";
+        } else if (command == "sync") {
+            event.type = ScriptEvent::EVENT_SYNC;
+        } else if (command == "exit") {
+            event.type = ScriptEvent::EVENT_EXIT;
+        } else {
+            return false;
+        }
+
+        events.push_back(event);
+    }
+
+    // Lines don't have to be sorted, events of the same frame keep their order
+    std::stable_sort(events.begin(), events.end(), [](ScriptEvent const& a, ScriptEvent const& b) {
+        return a.frame < b.frame;
+    });
+
+    scriptEvents = events;
+    nextEvent = 0;
+    memset(padState, 0, sizeof(padState));
+    memset(padSample, 0, sizeof(padSample));
+
+    ApplyEvents(GetFrame());
+
+    return true;
+}
+
+uint32_t HostStub::GetInputScriptLength()
+{
+    return scriptEvents.empty() ? 0 : scriptEvents.back().frame;
+}
+
+void HostStub::OnFrameEnd()
+{
+    ApplyEvents(GetFrame());
+}
+
+int32_t VPADRead(VPADChan chan, VPADStatus* buffers, uint32_t count, VPADReadError* outError)
+{
+    if ((uint32_t) chan >= HostStub::GetConnectedDrcs()) {
+        if (outError) {
+            *outError = VPAD_READ_INVALID_CONTROLLER;
+        }
+        return 0;
+    }
+
+    // Every read within a frame returns the same sample
+    if (count > 0) {
+        buffers[0] = padSample[chan];
+    }
+
+    if (outError) {
+        *outError = VPAD_READ_SUCCESS;
+    }
+    return count > 0 ? 1 : 0;
+}
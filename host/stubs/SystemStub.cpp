@@ -0,0 +1,249 @@
+#include "HostStub.hpp"
+
+#include <whb/proc.h>
+#include <proc_ui/procui.h>
+#include <sysapp/launch.h>
+#include <sndcore2/core.h>
+#include <nsysccr/cdc.h>
+#include <nn/ccr.h>
+#include <coreinit/im.h>
+
+#include <algorithm>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Pin shown while pairing, the console generates a random one
+#define STUB_PINCODE 1234
+
+#define STUB_IM_HANDLE 1
+
+struct ProcUICallbackEntry {
+    ProcUICallback callback;
+    void* param;
+    uint32_t priority;
+};
+
+static std::vector<ProcUICallbackEntry> procUICallbacks[PROCUI_CALLBACK_HOME_BUTTON_DENIED + 1];
+
+static bool running = false;
+static bool homeMenuPending = false;
+static uint32_t frameLimit = 0;
+static uint32_t connectedDrcs = 2;
+
+static uint32_t multiDrc = 1;
+static bool pairing = false;
+static CCRSysPairingState pairingState = CCR_SYS_PAIRING_TIMED_OUT;
+
+// Pending IM_GetEventNotify request
+static IMEventMask* imEvent = nullptr;
+static IOSAsyncCallbackFn imCallback = nullptr;
+static void* imCallbackContext = nullptr;
+
+static void CallProcUICallbacks(ProcUICallbackType type)
+{
+    for (ProcUICallbackEntry& entry : procUICallbacks[type]) {
+        entry.callback(entry.param);
+    }
+}
+
+void ProcUIRegisterCallback(ProcUICallbackType type, ProcUICallback callback, void* param, uint32_t priority)
+{
+    std::vector<ProcUICallbackEntry>& callbacks = procUICallbacks[type];
+    callbacks.push_back({ callback, param, priority });
+
+    // Higher priorities are called first, keep the registration order otherwise
+    std::stable_sort(callbacks.begin(), callbacks.end(), [](ProcUICallbackEntry const& a, ProcUICallbackEntry const& b) {
+        return a.priority > b.priority;
+    });
+}
+
+void WHBProcInit()
+{
+    running = true;
+
+    // Apply the configuration of the environment
+    const char* trace = getenv("HOST_TRACE");
+    if (trace && !HostStub::OpenTrace(trace)) {
+        fprintf(stderr, "Failed to open trace %s\n", trace);
+    }
+
+    const char* input = getenv("HOST_INPUT");
+    if (input && !HostStub::LoadInputScript(input)) {
+        fprintf(stderr, "Failed to load input script %s\n", input);
+    }
+
+    const char* frames = getenv("HOST_FRAMES");
+    if (frames) {
+        HostStub::SetFrameLimit(strtoul(frames, nullptr, 0));
+    }
+
+    const char* drcs = getenv("HOST_DRCS");
+    if (drcs) {
+        HostStub::SetConnectedDrcs(strtoul(drcs, nullptr, 0));
+    }
+}
+
+void WHBProcShutdown()
+{
+    for (std::vector<ProcUICallbackEntry>& callbacks : procUICallbacks) {
+        callbacks.clear();
+    }
+
+    HostStub::CloseTrace();
+}
+
+void WHBProcStopRunning()
+{
+    running = false;
+}
+
+BOOL WHBProcIsRunning()
+{
+    if (frameLimit && HostStub::GetFrame() >= frameLimit) {
+        running = false;
+    }
+
+    // The HOME Menu is handled while processing messages, release and acquire right away
+    if (running && homeMenuPending) {
+        homeMenuPending = false;
+        CallProcUICallbacks(PROCUI_CALLBACK_RELEASE);
+        CallProcUICallbacks(PROCUI_CALLBACK_ACQUIRE);
+    }
+
+    return running;
+}
+
+void SYSLaunchMenu()
+{
+    running = false;
+}
+
+void AXInit()
+{
+}
+
+void AXQuit()
+{
+}
+
+int32_t CCRCDCSetMultiDrc(uint8_t numDrcs)
+{
+    multiDrc = numDrcs;
+    return 0;
+}
+
+int32_t CCRCDCSysSetDrcState(CCRCDCDestination dest, CCRCDCDrcState* state)
+{
+    if (dest == CCR_CDC_DESTINATION_DRC1 && *state == CCR_CDC_DRC_STATE_DISCONNECT) {
+        connectedDrcs = 1;
+    }
+
+    return 0;
+}
+
+void CCRSysInit()
+{
+}
+
+void CCRSysExit()
+{
+}
+
+int32_t CCRSysGetPincode(uint32_t* pin)
+{
+    *pin = STUB_PINCODE;
+    return 0;
+}
+
+int32_t CCRSysStartPairing(uint32_t drcSlot, uint32_t timeout)
+{
+    // Pairing only finishes when it's simulated
+    pairing = true;
+    pairingState = CCR_SYS_PAIRING_IN_PROGRESS;
+    return 0;
+}
+
+int32_t CCRSysStopPairing()
+{
+    pairing = false;
+    return 0;
+}
+
+CCRSysPairingState CCRSysGetPairingState()
+{
+    return pairingState;
+}
+
+IOSHandle IM_Open()
+{
+    return STUB_IM_HANDLE;
+}
+
+IOSError IM_Close(IOSHandle handle)
+{
+    return IOS_ERROR_OK;
+}
+
+IOSError IM_GetEventNotify(IOSHandle handle, IMRequest* request, IMEventMask* event, IOSAsyncCallbackFn asyncCallback, void* asyncCallbackContext)
+{
+    imEvent = event;
+    imCallback = asyncCallback;
+    imCallbackContext = asyncCallbackContext;
+    return IOS_ERROR_OK;
+}
+
+IOSError IM_CancelGetEventNotify(IOSHandle handle, IMRequest* request, IOSAsyncCallbackFn asyncCallback, void* asyncCallbackContext)
+{
+    imEvent = nullptr;
+    imCallback = nullptr;
+    imCallbackContext = nullptr;
+    return IOS_ERROR_OK;
+}
+
+void HostStub::SetFrameLimit(uint32_t frames)
+{
+    frameLimit = frames;
+}
+
+void HostStub::SetConnectedDrcs(uint32_t count)
+{
+    connectedDrcs = std::clamp(count, 1u, 2u);
+}
+
+uint32_t HostStub::GetConnectedDrcs()
+{
+    // The second GamePad only shows up with multi DRC mode enabled
+    return multiDrc > 1 ? connectedDrcs : 1;
+}
+
+void HostStub::SimulateHomeMenu()
+{
+    homeMenuPending = true;
+}
+
+void HostStub::SimulatePairing(bool success)
+{
+    if (!pairing) {
+        return;
+    }
+
+    pairing = false;
+    pairingState = success ? CCR_SYS_PAIRING_FINISHED : CCR_SYS_PAIRING_TIMED_OUT;
+    if (success) {
+        connectedDrcs = 2;
+    }
+}
+
+void HostStub::SimulateSyncButton()
+{
+    if (!imCallback) {
+        return;
+    }
+
+    // The request completes once, the caller has to register again
+    IOSAsyncCallbackFn callback = imCallback;
+    *imEvent = IM_EVENT_SYNC;
+    imCallback = nullptr;
+    callback(IOS_ERROR_OK, imCallbackContext);
+}
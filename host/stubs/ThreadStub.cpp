@@ -0,0 +1,137 @@
+#include "HostStub.hpp"
+
+#include <coreinit/thread.h>
+#include <coreinit/messagequeue.h>
+
+#include <chrono>
+#include <thread>
+#include <string.h>
+
+// Core the calling thread would run on, the main thread starts on core 1 like on the console
+static thread_local uint32_t currentCoreId = 1;
+
+static void* ThreadEntry(void* arg)
+{
+    OSThread* thread = (OSThread*) arg;
+    currentCoreId = thread->coreId;
+
+    thread->result = thread->entry(thread->argc, thread->argv);
+    return nullptr;
+}
+
+BOOL OSCreateThread(OSThread* thread, OSThreadEntryPointFn entry, int argc, char* argv, void* stack, uint32_t stackSize, int32_t priority, OSThreadAttributes attributes)
+{
+    memset(thread, 0, sizeof(OSThread));
+    thread->entry = entry;
+    thread->argc = argc;
+    thread->argv = (const char**) argv;
+
+    // Pick the lowest core of the affinity mask
+    thread->coreId = currentCoreId;
+    for (uint32_t core = 0; core < 3; ++core) {
+        if (attributes & (OS_THREAD_ATTRIB_AFFINITY_CPU0 << core)) {
+            thread->coreId = core;
+            break;
+        }
+    }
+
+    // Threads are created suspended
+    return TRUE;
+}
+
+int32_t OSResumeThread(OSThread* thread)
+{
+    if (thread->started) {
+        return 0;
+    }
+
+    thread->started = pthread_create(&thread->thread, nullptr, ThreadEntry, thread) == 0;
+    return 1;
+}
+
+BOOL OSJoinThread(OSThread* thread, int* threadResult)
+{
+    if (!thread->started || pthread_join(thread->thread, nullptr) != 0) {
+        return FALSE;
+    }
+
+    thread->started = FALSE;
+    if (threadResult) {
+        *threadResult = thread->result;
+    }
+    return TRUE;
+}
+
+void OSSetThreadName(OSThread* thread, const char* name)
+{
+    thread->name = name;
+}
+
+uint32_t OSGetCoreId()
+{
+    return currentCoreId;
+}
+
+void OSSleepTicks(OSTime ticks)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(OSTicksToMicroseconds(ticks)));
+}
+
+void OSInitMessageQueue(OSMessageQueue* queue, OSMessage* messages, int32_t size)
+{
+    pthread_mutex_init(&queue->mutex, nullptr);
+    pthread_cond_init(&queue->cond, nullptr);
+    queue->messages = messages;
+    queue->size = size;
+    queue->first = 0;
+    queue->used = 0;
+}
+
+BOOL OSSendMessage(OSMessageQueue* queue, OSMessage* message, OSMessageFlags flags)
+{
+    pthread_mutex_lock(&queue->mutex);
+
+    while (queue->used == queue->size) {
+        if (!(flags & OS_MESSAGE_FLAGS_BLOCKING)) {
+            pthread_mutex_unlock(&queue->mutex);
+            return FALSE;
+        }
+
+        pthread_cond_wait(&queue->cond, &queue->mutex);
+    }
+
+    if (flags & OS_MESSAGE_FLAGS_HIGH_PRIORITY) {
+        // Jump the queue
+        queue->first = (queue->first + queue->size - 1) % queue->size;
+        queue->messages[queue->first] = *message;
+    } else {
+        queue->messages[(queue->first + queue->used) % queue->size] = *message;
+    }
+    queue->used++;
+
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+    return TRUE;
+}
+
+BOOL OSReceiveMessage(OSMessageQueue* queue, OSMessage* message, OSMessageFlags flags)
+{
+    pthread_mutex_lock(&queue->mutex);
+
+    while (queue->used == 0) {
+        if (!(flags & OS_MESSAGE_FLAGS_BLOCKING)) {
+            pthread_mutex_unlock(&queue->mutex);
+            return FALSE;
+        }
+
+        pthread_cond_wait(&queue->cond, &queue->mutex);
+    }
+
+    *message = queue->messages[queue->first];
+    queue->first = (queue->first + 1) % queue->size;
+    queue->used--;
+
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+    return TRUE;
+}
@@ -0,0 +1,166 @@
+#include "GX2Trace.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Per frame limits for a range of frames
+struct Budget {
+    uint32_t first;
+    uint32_t last;
+    uint32_t draws;
+    uint32_t stateChanges;
+};
+
+// Every line is "<first frame> <last frame or -> <draws> <state changes>", # starts a comment
+static bool LoadBudgets(const char* path, std::vector<Budget>& budgets)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+
+    char line[256];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        char* comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+
+        char last[16];
+        Budget budget;
+        int fields = sscanf(line, "%u %15s %u %u", &budget.first, last, &budget.draws, &budget.stateChanges);
+        if (fields <= 0) {
+            continue;
+        }
+
+        budget.last = strcmp(last, "-") == 0 ? UINT32_MAX : strtoul(last, nullptr, 10);
+        ok = fields == 4 && budget.last >= budget.first;
+        budgets.push_back(budget);
+    }
+
+    fclose(f);
+    return ok;
+}
+
+static const Budget* FindBudget(std::vector<Budget> const& budgets, uint32_t frame)
+{
+    for (Budget const& budget : budgets) {
+        if (frame >= budget.first && frame <= budget.last) {
+            return &budget;
+        }
+    }
+    return nullptr;
+}
+
+// Prints a summary of every frame in a GX2 trace, -v also prints every call with its arguments.
+// With -b only the frames over the draw and state change limits of a budget file are printed,
+// and the exit code is 1 if there are any.
+int main(int argc, char const* argv[])
+{
+    bool verbose = false;
+    const char* budgetPath = nullptr;
+    int arg = 1;
+    for (; arg < argc - 1; ++arg) {
+        if (strcmp(argv[arg], "-v") == 0) {
+            verbose = true;
+        } else if (strcmp(argv[arg], "-b") == 0 && arg + 2 < argc) {
+            budgetPath = argv[++arg];
+        } else {
+            break;
+        }
+    }
+
+    if (arg != argc - 1) {
+        fprintf(stderr, "Usage: %s [-v] [-b <budget>] <trace>\n", argv[0]);
+        return 1;
+    }
+    const char* path = argv[arg];
+
+    std::vector<Budget> budgets;
+    if (budgetPath && !LoadBudgets(budgetPath, budgets)) {
+        fprintf(stderr, "Failed to read the budget %s\n", budgetPath);
+        return 1;
+    }
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return 1;
+    }
+
+    GX2TraceHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 || header.magic != GX2_TRACE_MAGIC || header.version != GX2_TRACE_VERSION) {
+        fprintf(stderr, "%s is not a GX2 trace\n", path);
+        fclose(f);
+        return 1;
+    }
+
+    uint32_t callCounts[GX2_TRACE_NUM_CALLS] = {};
+    uint32_t stateChanges = 0;
+    uint32_t words[256];
+
+    uint32_t frames = 0;
+    uint32_t overBudget = 0;
+    uint32_t maxDraws = 0;
+    uint32_t maxStateChanges = 0;
+
+    if (!budgetPath) {
+        printf("%8s %8s %8s %8s %8s\n", "frame", "calls", "bytes", "draws", "state");
+    }
+
+    GX2TraceRecord record;
+    while (fread(&record, sizeof(record), 1, f) == 1) {
+        if (record.call >= GX2_TRACE_NUM_CALLS || fread(words, sizeof(uint32_t), record.numWords, f) != record.numWords) {
+            fprintf(stderr, "Truncated or corrupt trace\n");
+            fclose(f);
+            return 1;
+        }
+
+        if (verbose) {
+            printf("  GX2%s(", GX2TraceGetCallName(record.call));
+            for (uint32_t i = 0; i < record.numWords; ++i) {
+                printf(i ? ", 0x%x" : "0x%x", words[i]);
+            }
+            printf(")\n");
+        }
+
+        if (record.call == GX2_TRACE_FrameEnd) {
+            uint32_t draws = callCounts[GX2_TRACE_DrawEx];
+            if (!budgetPath) {
+                printf("%8u %8u %8u %8u %8u\n", words[0], words[1], words[2], draws, stateChanges);
+            } else if (const Budget* budget = FindBudget(budgets, words[0])) {
+                if (draws > budget->draws || stateChanges > budget->stateChanges) {
+                    printf("frame %u: %u draws (limit %u), %u state changes (limit %u)\n",
+                        words[0], draws, budget->draws, stateChanges, budget->stateChanges);
+                    overBudget++;
+                }
+            }
+
+            frames++;
+            maxDraws = std::max(maxDraws, draws);
+            maxStateChanges = std::max(maxStateChanges, stateChanges);
+            memset(callCounts, 0, sizeof(callCounts));
+            stateChanges = 0;
+            continue;
+        }
+
+        callCounts[record.call]++;
+        if (GX2TraceIsStateChange(record.call)) {
+            stateChanges++;
+        }
+    }
+
+    fclose(f);
+
+    if (budgetPath) {
+        printf("%u frames, at most %u draws and %u state changes, %u over budget\n",
+            frames, maxDraws, maxStateChanges, overBudget);
+        return overBudget ? 1 : 0;
+    }
+
+    return 0;
+}
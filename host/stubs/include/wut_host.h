@@ -0,0 +1,620 @@
+#pragma once
+
+// Host declarations of the subset of wut used by the game.
+// Types and constants follow wut, structures only contain the fields the game and the stubs use.
+// Every header under this directory includes this file so sources compile unchanged on the host.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+typedef int32_t BOOL;
+#define TRUE 1
+#define FALSE 0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// coreinit
+//-----------------------------------------------------------------------------
+typedef int64_t OSTime;
+typedef int32_t OSTick;
+
+// Bus clock of the console divided by 4
+#define OSTimerClockSpeed 62156250ull
+
+#define OSSecondsToTicks(val)       ((uint64_t)(val) * OSTimerClockSpeed)
+#define OSMillisecondsToTicks(val)  (((uint64_t)(val) * OSTimerClockSpeed) / 1000ull)
+#define OSMicrosecondsToTicks(val)  (((uint64_t)(val) * OSTimerClockSpeed) / 1000000ull)
+#define OSNanosecondsToTicks(val)   (((uint64_t)(val) * (OSTimerClockSpeed / 31250ull)) / 32000ull)
+#define OSTicksToSeconds(val)       ((uint64_t)(val) / OSTimerClockSpeed)
+#define OSTicksToMilliseconds(val)  (((uint64_t)(val) * 1000ull) / OSTimerClockSpeed)
+#define OSTicksToMicroseconds(val)  (((uint64_t)(val) * 1000000ull) / OSTimerClockSpeed)
+#define OSTicksToNanoseconds(val)   (((uint64_t)(val) * 32000ull) / (OSTimerClockSpeed / 31250ull))
+
+OSTime OSGetTime();
+OSTime OSGetSystemTime();
+OSTick OSGetTick();
+
+uint64_t OSGetTitleID();
+
+typedef enum OSSharedDataType {
+    OS_SHAREDDATATYPE_FONT_CHINESE    = 0,
+    OS_SHAREDDATATYPE_FONT_KOREAN     = 1,
+    OS_SHAREDDATATYPE_FONT_STANDARD   = 2,
+    OS_SHAREDDATATYPE_FONT_TAIWANESE  = 3,
+} OSSharedDataType;
+
+BOOL OSGetSharedData(OSSharedDataType type, uint32_t unk_r4, void** outPtr, uint32_t* outSize);
+
+void OSReport(const char* fmt, ...);
+
+void DCFlushRange(void* addr, uint32_t size);
+void DCStoreRange(void* addr, uint32_t size);
+void DCInvalidateRange(void* addr, uint32_t size);
+
+typedef struct MEMHeapHeader MEMHeapHeader;
+typedef MEMHeapHeader* MEMHeapHandle;
+
+typedef enum MEMBaseHeapType {
+    MEM_BASE_HEAP_MEM1  = 0,
+    MEM_BASE_HEAP_MEM2  = 1,
+    MEM_BASE_HEAP_FG    = 8,
+} MEMBaseHeapType;
+
+typedef enum MEMFrameHeapFreeMode {
+    MEM_FRM_HEAP_FREE_HEAD  = 1 << 0,
+    MEM_FRM_HEAP_FREE_TAIL  = 1 << 1,
+    MEM_FRM_HEAP_FREE_ALL   = MEM_FRM_HEAP_FREE_HEAD | MEM_FRM_HEAP_FREE_TAIL,
+} MEMFrameHeapFreeMode;
+
+MEMHeapHandle MEMGetBaseHeapHandle(MEMBaseHeapType type);
+void* MEMAllocFromFrmHeapEx(MEMHeapHandle heap, uint32_t size, int alignment);
+void MEMFreeToFrmHeap(MEMHeapHandle heap, MEMFrameHeapFreeMode mode);
+uint32_t MEMGetAllocatableSizeForFrmHeapEx(MEMHeapHandle heap, int alignment);
+
+typedef int (*OSThreadEntryPointFn)(int argc, const char** argv);
+
+typedef enum OSThreadAttributes {
+    OS_THREAD_ATTRIB_AFFINITY_CPU0  = 1 << 0,
+    OS_THREAD_ATTRIB_AFFINITY_CPU1  = 1 << 1,
+    OS_THREAD_ATTRIB_AFFINITY_CPU2  = 1 << 2,
+    OS_THREAD_ATTRIB_AFFINITY_ANY   = OS_THREAD_ATTRIB_AFFINITY_CPU0 | OS_THREAD_ATTRIB_AFFINITY_CPU1 | OS_THREAD_ATTRIB_AFFINITY_CPU2,
+    OS_THREAD_ATTRIB_DETACHED       = 1 << 3,
+} OSThreadAttributes;
+
+// Threads run on host threads, the affinity only decides what OSGetCoreId returns
+typedef struct OSThread {
+    pthread_t thread;
+    OSThreadEntryPointFn entry;
+    int argc;
+    const char** argv;
+    int result;
+    uint32_t coreId;
+    BOOL started;
+    const char* name;
+} OSThread;
+
+BOOL OSCreateThread(OSThread* thread, OSThreadEntryPointFn entry, int argc, char* argv, void* stack, uint32_t stackSize, int32_t priority, OSThreadAttributes attributes);
+int32_t OSResumeThread(OSThread* thread);
+BOOL OSJoinThread(OSThread* thread, int* threadResult);
+void OSSetThreadName(OSThread* thread, const char* name);
+uint32_t OSGetCoreId();
+void OSSleepTicks(OSTime ticks);
+
+typedef struct OSMessage {
+    void* message;
+    uint32_t args[3];
+} OSMessage;
+
+typedef enum OSMessageFlags {
+    OS_MESSAGE_FLAGS_NONE       = 0,
+    OS_MESSAGE_FLAGS_BLOCKING   = 1 << 0,
+    OS_MESSAGE_FLAGS_HIGH_PRIORITY = 1 << 1,
+} OSMessageFlags;
+
+typedef struct OSMessageQueue {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    OSMessage* messages;
+    uint32_t size;
+    uint32_t first;
+    uint32_t used;
+} OSMessageQueue;
+
+void OSInitMessageQueue(OSMessageQueue* queue, OSMessage* messages, int32_t size);
+BOOL OSSendMessage(OSMessageQueue* queue, OSMessage* message, OSMessageFlags flags);
+BOOL OSReceiveMessage(OSMessageQueue* queue, OSMessage* message, OSMessageFlags flags);
+
+//-----------------------------------------------------------------------------
+// IOS / IM
+//-----------------------------------------------------------------------------
+typedef int32_t IOSHandle;
+
+typedef enum IOSError {
+    IOS_ERROR_OK        = 0,
+    IOS_ERROR_ACCESS    = -1,
+    IOS_ERROR_INVALID   = -4,
+} IOSError;
+
+typedef void (*IOSAsyncCallbackFn)(IOSError error, void* context);
+
+typedef uint32_t IMEventMask;
+#define IM_EVENT_SYNC 0x40
+
+typedef struct IMRequest {
+    uint8_t data[0x80];
+} IMRequest;
+
+IOSHandle IM_Open();
+IOSError IM_Close(IOSHandle handle);
+IOSError IM_GetEventNotify(IOSHandle handle, IMRequest* request, IMEventMask* event, IOSAsyncCallbackFn asyncCallback, void* asyncCallbackContext);
+IOSError IM_CancelGetEventNotify(IOSHandle handle, IMRequest* request, IOSAsyncCallbackFn asyncCallback, void* asyncCallbackContext);
+
+//-----------------------------------------------------------------------------
+// ProcUI / WHB
+//-----------------------------------------------------------------------------
+typedef enum ProcUICallbackType {
+    PROCUI_CALLBACK_ACQUIRE,
+    PROCUI_CALLBACK_RELEASE,
+    PROCUI_CALLBACK_EXIT,
+    PROCUI_CALLBACK_NET_IO_START,
+    PROCUI_CALLBACK_NET_IO_STOP,
+    PROCUI_CALLBACK_HOME_BUTTON_DENIED,
+} ProcUICallbackType;
+
+typedef uint32_t (*ProcUICallback)(void* context);
+
+void ProcUIRegisterCallback(ProcUICallbackType type, ProcUICallback callback, void* param, uint32_t priority);
+
+void WHBProcInit();
+void WHBProcShutdown();
+void WHBProcStopRunning();
+BOOL WHBProcIsRunning();
+
+void SYSLaunchMenu();
+
+void AXInit();
+void AXQuit();
+
+//-----------------------------------------------------------------------------
+// CCR
+//-----------------------------------------------------------------------------
+typedef enum CCRCDCDestination {
+    CCR_CDC_DESTINATION_DRC0 = 0x11,
+    CCR_CDC_DESTINATION_DRC1 = 0x12,
+} CCRCDCDestination;
+
+typedef enum CCRCDCDrcState {
+    CCR_CDC_DRC_STATE_ACTIVE        = 1,
+    CCR_CDC_DRC_STATE_BACKGROUND    = 3,
+    CCR_CDC_DRC_STATE_DISCONNECT    = 4,
+} CCRCDCDrcState;
+
+typedef enum CCRSysPairingState {
+    CCR_SYS_PAIRING_FINISHED    = 0,
+    CCR_SYS_PAIRING_IN_PROGRESS = 1,
+    CCR_SYS_PAIRING_TIMED_OUT   = 2,
+} CCRSysPairingState;
+
+int32_t CCRCDCSetMultiDrc(uint8_t numDrcs);
+int32_t CCRCDCSysSetDrcState(CCRCDCDestination dest, CCRCDCDrcState* state);
+
+void CCRSysInit();
+void CCRSysExit();
+int32_t CCRSysGetPincode(uint32_t* pin);
+int32_t CCRSysStartPairing(uint32_t drcSlot, uint32_t timeout);
+int32_t CCRSysStopPairing();
+CCRSysPairingState CCRSysGetPairingState();
+
+//-----------------------------------------------------------------------------
+// VPAD
+//-----------------------------------------------------------------------------
+typedef enum VPADChan {
+    VPAD_CHAN_0 = 0,
+    VPAD_CHAN_1 = 1,
+} VPADChan;
+
+typedef enum VPADButtons {
+    VPAD_BUTTON_A                   = 0x8000,
+    VPAD_BUTTON_B                   = 0x4000,
+    VPAD_BUTTON_X                   = 0x2000,
+    VPAD_BUTTON_Y                   = 0x1000,
+    VPAD_BUTTON_LEFT                = 0x0800,
+    VPAD_BUTTON_RIGHT               = 0x0400,
+    VPAD_BUTTON_UP                  = 0x0200,
+    VPAD_BUTTON_DOWN                = 0x0100,
+    VPAD_BUTTON_ZL                  = 0x0080,
+    VPAD_BUTTON_ZR                  = 0x0040,
+    VPAD_BUTTON_L                   = 0x0020,
+    VPAD_BUTTON_R                   = 0x0010,
+    VPAD_BUTTON_PLUS                = 0x0008,
+    VPAD_BUTTON_MINUS               = 0x0004,
+    VPAD_BUTTON_HOME                = 0x0002,
+    VPAD_BUTTON_SYNC                = 0x0001,
+    VPAD_BUTTON_STICK_R             = 0x00020000,
+    VPAD_BUTTON_STICK_L             = 0x00040000,
+    VPAD_BUTTON_TV                  = 0x00010000,
+    VPAD_STICK_R_EMULATION_LEFT     = 0x04000000,
+    VPAD_STICK_R_EMULATION_RIGHT    = 0x02000000,
+    VPAD_STICK_R_EMULATION_UP       = 0x01000000,
+    VPAD_STICK_R_EMULATION_DOWN     = 0x00800000,
+    VPAD_STICK_L_EMULATION_LEFT     = 0x40000000,
+    VPAD_STICK_L_EMULATION_RIGHT    = 0x20000000,
+    VPAD_STICK_L_EMULATION_UP       = 0x10000000,
+    VPAD_STICK_L_EMULATION_DOWN     = 0x08000000,
+} VPADButtons;
+
+typedef enum VPADReadError {
+    VPAD_READ_SUCCESS               = 0,
+    VPAD_READ_NO_SAMPLES            = -1,
+    VPAD_READ_INVALID_CONTROLLER    = -2,
+} VPADReadError;
+
+typedef struct VPADVec2D {
+    float x;
+    float y;
+} VPADVec2D;
+
+typedef struct VPADTouchData {
+    uint16_t x;
+    uint16_t y;
+    uint16_t touched;
+    uint16_t validity;
+} VPADTouchData;
+
+typedef struct VPADStatus {
+    uint32_t hold;
+    uint32_t trigger;
+    uint32_t release;
+    VPADVec2D leftStick;
+    VPADVec2D rightStick;
+    VPADReadError error;
+    VPADTouchData tpNormal;
+    uint8_t battery;
+} VPADStatus;
+
+int32_t VPADRead(VPADChan chan, VPADStatus* buffers, uint32_t count, VPADReadError* outError);
+
+//-----------------------------------------------------------------------------
+// GX2
+//-----------------------------------------------------------------------------
+#define GX2_COMMAND_BUFFER_ALIGNMENT    0x40
+#define GX2_COMMAND_BUFFER_SIZE         0x400000
+#define GX2_SCAN_BUFFER_ALIGNMENT       0x1000
+#define GX2_CONTEXT_STATE_ALIGNMENT     0x100
+#define GX2_VERTEX_BUFFER_ALIGNMENT     0x40
+#define GX2_UNIFORM_BLOCK_ALIGNMENT     0x100
+
+#define GX2_COMP_MAP(r, g, b, a) (((r) << 24) | ((g) << 16) | ((b) << 8) | (a))
+
+typedef enum GX2InitAttributes {
+    GX2_INIT_END                = 0,
+    GX2_INIT_CMD_BUF_BASE       = 1,
+    GX2_INIT_CMD_BUF_POOL_SIZE  = 2,
+    GX2_INIT_ARGC               = 7,
+    GX2_INIT_ARGV               = 8,
+} GX2InitAttributes;
+
+typedef enum GX2SurfaceFormat {
+    GX2_SURFACE_FORMAT_UNORM_R8                 = 0x001,
+    GX2_SURFACE_FORMAT_UNORM_R8_G8_B8_A8        = 0x01a,
+    GX2_SURFACE_FORMAT_UNORM_R10_G10_B10_A2     = 0x019,
+    GX2_SURFACE_FORMAT_FLOAT_R16_G16_B16_A16    = 0x81f,
+} GX2SurfaceFormat;
+
+typedef enum GX2SurfaceUse {
+    GX2_SURFACE_USE_TEXTURE                 = 1 << 0,
+    GX2_SURFACE_USE_COLOR_BUFFER            = 1 << 1,
+    GX2_SURFACE_USE_DEPTH_BUFFER            = 1 << 2,
+    GX2_SURFACE_USE_SCAN_BUFFER             = 1 << 3,
+    GX2_SURFACE_USE_TV                      = 1u << 31,
+    GX2_SURFACE_USE_TEXTURE_COLOR_BUFFER_TV = GX2_SURFACE_USE_TEXTURE | GX2_SURFACE_USE_COLOR_BUFFER | GX2_SURFACE_USE_TV,
+} GX2SurfaceUse;
+
+typedef enum GX2SurfaceDim {
+    GX2_SURFACE_DIM_TEXTURE_1D  = 0,
+    GX2_SURFACE_DIM_TEXTURE_2D  = 1,
+} GX2SurfaceDim;
+
+typedef enum GX2TileMode {
+    GX2_TILE_MODE_DEFAULT           = 0,
+    GX2_TILE_MODE_LINEAR_ALIGNED    = 1,
+    GX2_TILE_MODE_TILED_1D_THIN1    = 2,
+    GX2_TILE_MODE_TILED_2D_THIN1    = 4,
+    GX2_TILE_MODE_LINEAR_SPECIAL    = 16,
+} GX2TileMode;
+
+typedef enum GX2AAMode {
+    GX2_AA_MODE1X = 0,
+} GX2AAMode;
+
+typedef enum GX2SqSel {
+    GX2_SQ_SEL_R = 0,
+    GX2_SQ_SEL_G = 1,
+    GX2_SQ_SEL_B = 2,
+    GX2_SQ_SEL_A = 3,
+    GX2_SQ_SEL_0 = 4,
+    GX2_SQ_SEL_1 = 5,
+} GX2SqSel;
+
+typedef struct GX2Surface {
+    GX2SurfaceDim dim;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t mipLevels;
+    GX2SurfaceFormat format;
+    GX2AAMode aa;
+    GX2SurfaceUse use;
+    uint32_t imageSize;
+    void* image;
+    uint32_t mipmapSize;
+    void* mipmaps;
+    GX2TileMode tileMode;
+    uint32_t swizzle;
+    uint32_t alignment;
+    uint32_t pitch;
+    uint32_t mipLevelOffset[13];
+} GX2Surface;
+
+typedef struct GX2ColorBuffer {
+    GX2Surface surface;
+    uint32_t viewMip;
+    uint32_t viewFirstSlice;
+    uint32_t viewNumSlices;
+    void* aaBuffer;
+    uint32_t aaSize;
+    uint32_t regs[5];
+} GX2ColorBuffer;
+
+typedef struct GX2Texture {
+    GX2Surface surface;
+    uint32_t viewFirstMip;
+    uint32_t viewNumMips;
+    uint32_t viewFirstSlice;
+    uint32_t viewNumSlices;
+    uint32_t compMap;
+    uint32_t regs[5];
+} GX2Texture;
+
+typedef enum GX2TexClampMode {
+    GX2_TEX_CLAMP_MODE_WRAP     = 0,
+    GX2_TEX_CLAMP_MODE_MIRROR   = 1,
+    GX2_TEX_CLAMP_MODE_CLAMP    = 2,
+} GX2TexClampMode;
+
+typedef enum GX2TexXYFilterMode {
+    GX2_TEX_XY_FILTER_MODE_POINT    = 0,
+    GX2_TEX_XY_FILTER_MODE_LINEAR   = 1,
+} GX2TexXYFilterMode;
+
+typedef enum GX2TexAnisoRatio {
+    GX2_TEX_ANISO_RATIO_NONE = 0,
+} GX2TexAnisoRatio;
+
+typedef struct GX2Sampler {
+    uint32_t regs[3];
+} GX2Sampler;
+
+typedef struct GX2ContextState {
+    uint8_t data[0xa100];
+} GX2ContextState;
+
+typedef enum GX2TVRenderMode {
+    GX2_TV_RENDER_MODE_STANDARD_480P    = 1,
+    GX2_TV_RENDER_MODE_WIDE_480P        = 2,
+    GX2_TV_RENDER_MODE_WIDE_720P        = 3,
+    GX2_TV_RENDER_MODE_WIDE_1080P       = 5,
+} GX2TVRenderMode;
+
+typedef enum GX2TVScanMode {
+    GX2_TV_SCAN_MODE_NONE   = 0,
+    GX2_TV_SCAN_MODE_576I   = 1,
+    GX2_TV_SCAN_MODE_480I   = 2,
+    GX2_TV_SCAN_MODE_480P   = 3,
+    GX2_TV_SCAN_MODE_720P   = 4,
+    GX2_TV_SCAN_MODE_1080I  = 6,
+    GX2_TV_SCAN_MODE_1080P  = 7,
+} GX2TVScanMode;
+
+typedef enum GX2DrcRenderMode {
+    GX2_DRC_RENDER_MODE_DISABLED    = 0,
+    GX2_DRC_RENDER_MODE_SINGLE      = 1,
+    GX2_DRC_RENDER_MODE_DOUBLE      = 2,
+} GX2DrcRenderMode;
+
+typedef enum GX2BufferingMode {
+    GX2_BUFFERING_MODE_SINGLE   = 1,
+    GX2_BUFFERING_MODE_DOUBLE   = 2,
+    GX2_BUFFERING_MODE_TRIPLE   = 3,
+} GX2BufferingMode;
+
+typedef enum GX2ScanTarget {
+    GX2_SCAN_TARGET_TV      = 1 << 0,
+    GX2_SCAN_TARGET_DRC0    = 1 << 2,
+    GX2_SCAN_TARGET_DRC1    = 1 << 3,
+} GX2ScanTarget;
+
+typedef enum GX2RenderTarget {
+    GX2_RENDER_TARGET_0 = 0,
+} GX2RenderTarget;
+
+typedef enum GX2BlendMode {
+    GX2_BLEND_MODE_ZERO             = 0,
+    GX2_BLEND_MODE_ONE              = 1,
+    GX2_BLEND_MODE_SRC_COLOR        = 2,
+    GX2_BLEND_MODE_INV_SRC_COLOR    = 3,
+    GX2_BLEND_MODE_SRC_ALPHA        = 4,
+    GX2_BLEND_MODE_INV_SRC_ALPHA    = 5,
+    GX2_BLEND_MODE_DST_ALPHA        = 6,
+    GX2_BLEND_MODE_INV_DST_ALPHA    = 7,
+} GX2BlendMode;
+
+typedef enum GX2BlendCombineMode {
+    GX2_BLEND_COMBINE_MODE_ADD = 0,
+} GX2BlendCombineMode;
+
+typedef enum GX2LogicOp {
+    GX2_LOGIC_OP_COPY = 0xcc,
+} GX2LogicOp;
+
+typedef enum GX2CompareFunction {
+    GX2_COMPARE_FUNC_NEVER      = 0,
+    GX2_COMPARE_FUNC_LESS       = 1,
+    GX2_COMPARE_FUNC_EQUAL      = 2,
+    GX2_COMPARE_FUNC_LEQUAL     = 3,
+    GX2_COMPARE_FUNC_GREATER    = 4,
+    GX2_COMPARE_FUNC_NOT_EQUAL  = 5,
+    GX2_COMPARE_FUNC_GEQUAL     = 6,
+    GX2_COMPARE_FUNC_ALWAYS     = 7,
+} GX2CompareFunction;
+
+typedef enum GX2InvalidateMode {
+    GX2_INVALIDATE_MODE_ATTRIBUTE_BUFFER        = 1 << 0,
+    GX2_INVALIDATE_MODE_TEXTURE                 = 1 << 1,
+    GX2_INVALIDATE_MODE_UNIFORM_BLOCK           = 1 << 2,
+    GX2_INVALIDATE_MODE_SHADER                  = 1 << 3,
+    GX2_INVALIDATE_MODE_COLOR_BUFFER            = 1 << 4,
+    GX2_INVALIDATE_MODE_DEPTH_BUFFER            = 1 << 5,
+    GX2_INVALIDATE_MODE_CPU                     = 1 << 6,
+    GX2_INVALIDATE_MODE_CPU_ATTRIBUTE_BUFFER    = GX2_INVALIDATE_MODE_CPU | GX2_INVALIDATE_MODE_ATTRIBUTE_BUFFER,
+    GX2_INVALIDATE_MODE_CPU_TEXTURE             = GX2_INVALIDATE_MODE_CPU | GX2_INVALIDATE_MODE_TEXTURE,
+    GX2_INVALIDATE_MODE_CPU_UNIFORM_BLOCK       = GX2_INVALIDATE_MODE_CPU | GX2_INVALIDATE_MODE_UNIFORM_BLOCK,
+    GX2_INVALIDATE_MODE_CPU_SHADER              = GX2_INVALIDATE_MODE_CPU | GX2_INVALIDATE_MODE_SHADER,
+} GX2InvalidateMode;
+
+typedef enum GX2PrimitiveMode {
+    GX2_PRIMITIVE_MODE_TRIANGLES    = 4,
+    GX2_PRIMITIVE_MODE_QUADS        = 19,
+} GX2PrimitiveMode;
+
+typedef enum GX2AttribFormat {
+    GX2_ATTRIB_FORMAT_UNORM_8_8_8_8     = 0x0a,
+    GX2_ATTRIB_FORMAT_FLOAT_32_32       = 0x80d,
+    GX2_ATTRIB_FORMAT_FLOAT_32_32_32_32 = 0x813,
+} GX2AttribFormat;
+
+typedef struct GX2FetchShader {
+    uint32_t size;
+    void* program;
+} GX2FetchShader;
+
+typedef struct GX2UniformVar {
+    const char* name;
+    uint32_t type;
+    uint32_t count;
+    uint32_t offset;
+    int32_t block;
+} GX2UniformVar;
+
+typedef struct GX2SamplerVar {
+    const char* name;
+    uint32_t type;
+    uint32_t location;
+} GX2SamplerVar;
+
+typedef struct GX2VertexShader {
+    uint32_t numUniforms;
+    GX2UniformVar* uniformVars;
+} GX2VertexShader;
+
+typedef struct GX2PixelShader {
+    uint32_t numUniforms;
+    GX2UniformVar* uniformVars;
+    uint32_t numSamplerVars;
+    GX2SamplerVar* samplerVars;
+} GX2PixelShader;
+
+void GX2Init(uint32_t* attributes);
+void GX2Shutdown();
+void GX2Flush();
+void GX2DrawDone();
+
+GX2TVScanMode GX2GetSystemTVScanMode();
+GX2DrcRenderMode GX2GetSystemDRCMode();
+void GX2CalcTVSize(GX2TVRenderMode tvRenderMode, GX2SurfaceFormat surfaceFormat, GX2BufferingMode bufferingMode, uint32_t* size, uint32_t* unkOut);
+void GX2CalcDRCSize(GX2DrcRenderMode drcRenderMode, GX2SurfaceFormat surfaceFormat, GX2BufferingMode bufferingMode, uint32_t* size, uint32_t* unkOut);
+void GX2SetTVBuffer(void* buffer, uint32_t size, GX2TVRenderMode tvRenderMode, GX2SurfaceFormat surfaceFormat, GX2BufferingMode bufferingMode);
+void GX2SetDRCBuffer(void* buffer, uint32_t size, GX2DrcRenderMode drcRenderMode, GX2SurfaceFormat surfaceFormat, GX2BufferingMode bufferingMode);
+void GX2SetTVScale(uint32_t x, uint32_t y);
+void GX2SetDRCScale(uint32_t x, uint32_t y);
+void GX2SetTVEnable(BOOL enable);
+void GX2SetDRCEnable(BOOL enable);
+void GX2SetSwapInterval(uint32_t interval);
+void GX2SwapScanBuffers();
+void GX2GetSwapStatus(uint32_t* swapCount, uint32_t* flipCount, OSTime* lastFlip, OSTime* lastVsync);
+void GX2WaitForVsync();
+void GX2CopyColorBufferToScanBuffer(const GX2ColorBuffer* buffer, GX2ScanTarget scanTarget);
+
+void GX2CalcSurfaceSizeAndAlignment(GX2Surface* surface);
+void GX2InitColorBufferRegs(GX2ColorBuffer* colorBuffer);
+void GX2InitTextureRegs(GX2Texture* texture);
+void GX2InitSampler(GX2Sampler* sampler, GX2TexClampMode clampMode, GX2TexXYFilterMode minMagFilterMode);
+void GX2InitSamplerClamping(GX2Sampler* sampler, GX2TexClampMode clampX, GX2TexClampMode clampY, GX2TexClampMode clampZ);
+void GX2InitSamplerXYFilter(GX2Sampler* sampler, GX2TexXYFilterMode filterMag, GX2TexXYFilterMode filterMin, GX2TexAnisoRatio maxAniso);
+void GX2CopySurface(const GX2Surface* src, uint32_t srcLevel, uint32_t srcDepth, GX2Surface* dst, uint32_t dstLevel, uint32_t dstDepth);
+
+void GX2Invalidate(GX2InvalidateMode mode, void* buffer, uint32_t size);
+
+void GX2SetupContextStateEx(GX2ContextState* state, BOOL unk1);
+void GX2SetContextState(GX2ContextState* state);
+void GX2SetColorBuffer(const GX2ColorBuffer* colorBuffer, GX2RenderTarget target);
+void GX2SetViewport(float x, float y, float width, float height, float nearZ, float farZ);
+void GX2SetScissor(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+void GX2SetDepthOnlyControl(BOOL depthTest, BOOL depthWrite, GX2CompareFunction depthCompare);
+void GX2SetColorControl(GX2LogicOp rop3, uint8_t targetBlendEnable, BOOL multiWriteEnable, BOOL colorWriteEnable);
+void GX2SetBlendControl(GX2RenderTarget target, GX2BlendMode colorSrcBlend, GX2BlendMode colorDstBlend, GX2BlendCombineMode colorCombine,
+    BOOL useAlphaBlend, GX2BlendMode alphaSrcBlend, GX2BlendMode alphaDstBlend, GX2BlendCombineMode alphaCombine);
+void GX2SetAlphaTest(BOOL alphaTest, GX2CompareFunction func, float ref);
+void GX2ClearColor(GX2ColorBuffer* colorBuffer, float red, float green, float blue, float alpha);
+
+void GX2SetFetchShader(const GX2FetchShader* shader);
+void GX2SetVertexShader(const GX2VertexShader* shader);
+void GX2SetPixelShader(const GX2PixelShader* shader);
+void GX2SetVertexUniformReg(uint32_t offset, uint32_t count, const void* data);
+void GX2SetPixelUniformReg(uint32_t offset, uint32_t count, const void* data);
+void GX2SetPixelTexture(const GX2Texture* texture, uint32_t unit);
+void GX2SetPixelSampler(const GX2Sampler* sampler, uint32_t unit);
+void GX2SetAttribBuffer(uint32_t index, uint32_t size, uint32_t stride, const void* buffer);
+void GX2DrawEx(GX2PrimitiveMode mode, uint32_t count, uint32_t offset, uint32_t numInstances);
+
+uint64_t GX2GetLastSubmittedTimeStamp();
+uint64_t GX2GetRetiredTimeStamp();
+BOOL GX2WaitTimeStamp(uint64_t time);
+void GX2SampleBottomGPUCycle(uint64_t* cycle);
+
+typedef struct WHBGfxShaderGroup {
+    GX2FetchShader fetchShader;
+    void* fetchShaderProgram;
+    uint32_t numAttributes;
+    GX2VertexShader* vertexShader;
+    GX2PixelShader* pixelShader;
+} WHBGfxShaderGroup;
+
+BOOL WHBGfxLoadGFDShaderGroup(WHBGfxShaderGroup* group, uint32_t index, const void* file);
+BOOL WHBGfxInitShaderAttribute(WHBGfxShaderGroup* group, const char* name, uint32_t buffer, uint32_t offset, GX2AttribFormat format);
+BOOL WHBGfxInitFetchShader(WHBGfxShaderGroup* group);
+BOOL WHBGfxFreeShaderGroup(WHBGfxShaderGroup* group);
+
+#ifdef __cplusplus
+}
+
+// wut marks bitmask enums so they can be combined in C++
+inline OSThreadAttributes operator|(OSThreadAttributes a, OSThreadAttributes b)
+{
+    return (OSThreadAttributes) ((uint32_t) a | (uint32_t) b);
+}
+
+inline OSMessageFlags operator|(OSMessageFlags a, OSMessageFlags b)
+{
+    return (OSMessageFlags) ((uint32_t) a | (uint32_t) b);
+}
+
+inline GX2InvalidateMode operator|(GX2InvalidateMode a, GX2InvalidateMode b)
+{
+    return (GX2InvalidateMode) ((uint32_t) a | (uint32_t) b);
+}
+#endif
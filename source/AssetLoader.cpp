@@ -0,0 +1,451 @@
+#include "AssetLoader.hpp"
+
+#include <coreinit/time.h>
+
+#include <algorithm>
+#include <fcntl.h>
+#include <malloc.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WORKER_STACK_SIZE (64 * 1024)
+
+// Below the render thread, it mostly waits for storage
+#define WORKER_PRIORITY 20
+
+AssetLoader::Request::State AssetLoader::Request::GetState() const
+{
+    return state.load(std::memory_order_acquire);
+}
+
+bool AssetLoader::Request::IsFinished() const
+{
+    return GetState() >= STATE_DONE;
+}
+
+const void* AssetLoader::Request::GetData() const
+{
+    return GetState() == STATE_DONE ? data : nullptr;
+}
+
+uint32_t AssetLoader::Request::GetSize() const
+{
+    return GetState() == STATE_DONE ? size : 0;
+}
+
+bool AssetLoader::Request::IsFallback() const
+{
+    return GetState() == STATE_DONE && fallback;
+}
+
+AssetLoader::AssetLoader() :
+    thread(nullptr),
+    threadStack(nullptr),
+    quit(false),
+    sequence(0),
+    buffers(),
+    loaded(0),
+    fallbacks(0),
+    failed(0),
+    canceled(0),
+    bytesRead(0),
+    readMs(0.0f),
+    poolBytes(0)
+{
+    OSInitMessageQueue(&wakeQueue, &wakeMessage, 1);
+    OSInitMessageQueue(&finishedQueue, finishedMessages, QUEUE_SIZE);
+}
+
+AssetLoader::~AssetLoader()
+{
+    Finalize();
+}
+
+bool AssetLoader::Initialize()
+{
+    quit = false;
+
+    thread = (OSThread*) memalign(16, sizeof(OSThread));
+    threadStack = memalign(16, WORKER_STACK_SIZE);
+    if (!thread || !threadStack) {
+        Finalize();
+        return false;
+    }
+
+    // Share core 2 with frame captures, reading mostly waits for storage
+    if (!OSCreateThread(thread, WorkerThread, 0, (char*) this, (uint8_t*) threadStack + WORKER_STACK_SIZE,
+        WORKER_STACK_SIZE, WORKER_PRIORITY, OS_THREAD_ATTRIB_AFFINITY_CPU2)) {
+        Finalize();
+        return false;
+    }
+
+    OSSetThreadName(thread, "AssetLoader");
+    OSResumeThread(thread);
+
+    return true;
+}
+
+void AssetLoader::Finalize()
+{
+    if (thread && threadStack) {
+        quit = true;
+        Wake();
+        OSJoinThread(thread, nullptr);
+    }
+
+    free(thread);
+    thread = nullptr;
+    free(threadStack);
+    threadStack = nullptr;
+
+    // The worker is gone, clean up on this thread
+    for (Command const& command : backlog) {
+        HandleCommand(command);
+    }
+    backlog.clear();
+
+    Command command;
+    while (commands.Pop(&command)) {
+        HandleCommand(command);
+    }
+
+    for (Request* request : pending) {
+        Finish(request, Request::STATE_CANCELED);
+    }
+    pending.clear();
+
+    for (Request* request : requests) {
+        delete request;
+    }
+    requests.clear();
+
+    for (Buffer& buffer : buffers) {
+        free(buffer.data);
+        buffer = {};
+    }
+    poolBytes = 0;
+}
+
+AssetLoader::Request* AssetLoader::Load(const char* path, Priority priority, const void* fallbackData, uint32_t fallbackSize)
+{
+    Request* request = new Request();
+    request->path = path ? path : "";
+    request->priority = priority;
+    request->sequence = sequence++;
+    request->fallbackData = fallbackData;
+    request->fallbackSize = fallbackSize;
+    request->fd = -1;
+    request->offset = 0;
+    request->buffer = nullptr;
+    request->data = nullptr;
+    request->size = 0;
+    request->fallback = false;
+    request->blocked = false;
+    request->state = Request::STATE_QUEUED;
+
+    Send({ COMMAND_LOAD, request });
+    return request;
+}
+
+void AssetLoader::Cancel(Request* request)
+{
+    Send({ COMMAND_CANCEL, request });
+}
+
+void AssetLoader::Release(Request* request)
+{
+    Send({ COMMAND_RELEASE, request });
+}
+
+void AssetLoader::Wait(Request* request)
+{
+    while (!request->IsFinished()) {
+        // The request might not even be queued yet
+        Flush();
+
+        // The state is published before posting, so if the post gets dropped there are older ones left
+        OSMessage message;
+        OSReceiveMessage(&finishedQueue, &message, OS_MESSAGE_FLAGS_BLOCKING);
+    }
+}
+
+AssetLoader::Stats AssetLoader::GetStats() const
+{
+    Stats stats;
+    stats.loaded = loaded;
+    stats.fallbacks = fallbacks;
+    stats.failed = failed;
+    stats.canceled = canceled;
+    stats.bytesRead = bytesRead;
+    stats.readMs = readMs;
+    stats.poolBytes = poolBytes;
+    return stats;
+}
+
+int AssetLoader::WorkerThread(int argc, const char** argv)
+{
+    AssetLoader* loader = (AssetLoader*) argv;
+
+    while (!loader->quit) {
+        if (!loader->Process()) {
+            OSMessage message;
+            OSReceiveMessage(&loader->wakeQueue, &message, OS_MESSAGE_FLAGS_BLOCKING);
+        }
+    }
+
+    return 0;
+}
+
+bool AssetLoader::Process()
+{
+    Command command;
+    while (commands.Pop(&command)) {
+        HandleCommand(command);
+    }
+
+    Request* request = NextRequest();
+    if (!request) {
+        return false;
+    }
+
+    if (!Step(request)) {
+        pending.erase(std::find(pending.begin(), pending.end(), request));
+    }
+    return true;
+}
+
+void AssetLoader::HandleCommand(Command const& command)
+{
+    Request* request = command.request;
+    auto it = std::find(pending.begin(), pending.end(), request);
+
+    switch (command.type) {
+    case COMMAND_LOAD:
+        requests.push_back(request);
+        pending.push_back(request);
+        break;
+    case COMMAND_CANCEL:
+        if (it != pending.end()) {
+            Finish(request, Request::STATE_CANCELED);
+            pending.erase(it);
+        }
+        break;
+    case COMMAND_RELEASE:
+        if (it != pending.end()) {
+            Finish(request, Request::STATE_CANCELED);
+            pending.erase(it);
+        }
+
+        ReleaseBuffer(request->buffer);
+        requests.erase(std::find(requests.begin(), requests.end(), request));
+        delete request;
+        break;
+    }
+}
+
+AssetLoader::Request* AssetLoader::NextRequest()
+{
+    // Highest priority first, then in the order they were requested
+    Request* next = nullptr;
+    for (Request* request : pending) {
+        if (request->blocked) {
+            continue;
+        }
+
+        if (!next || request->priority > next->priority ||
+            (request->priority == next->priority && request->sequence < next->sequence)) {
+            next = request;
+        }
+    }
+
+    return next;
+}
+
+bool AssetLoader::Step(Request* request)
+{
+    OSTime start = OSGetTime();
+
+    // Open the file and get a buffer for it on the first step
+    if (request->fd < 0) {
+        request->fd = open(request->path.c_str(), O_RDONLY);
+
+        struct stat st;
+        if (request->fd < 0 || fstat(request->fd, &st) != 0 || st.st_size <= 0) {
+            Finish(request, Request::STATE_FAILED);
+            return false;
+        }
+
+        request->size = st.st_size;
+        request->buffer = AcquireBuffer(request->size);
+        if (!request->buffer) {
+            // Wait for a release, the file is opened again then
+            close(request->fd);
+            request->fd = -1;
+            request->blocked = true;
+            return true;
+        }
+
+        request->state = Request::STATE_LOADING;
+    }
+
+    uint32_t chunk = std::min(CHUNK_SIZE, request->size - request->offset);
+    ssize_t bytes = read(request->fd, request->buffer->data + request->offset, chunk);
+    readMs = readMs + OSTicksToMicroseconds(OSGetTime() - start) / 1000.0f;
+    if (bytes <= 0) {
+        Finish(request, Request::STATE_FAILED);
+        return false;
+    }
+
+    request->offset += bytes;
+    bytesRead += bytes;
+    if (request->offset < request->size) {
+        return true;
+    }
+
+    request->data = request->buffer->data;
+    Finish(request, Request::STATE_DONE);
+    return false;
+}
+
+void AssetLoader::Finish(Request* request, Request::State state)
+{
+    if (request->fd >= 0) {
+        close(request->fd);
+        request->fd = -1;
+    }
+
+    // Use the embedded data if the file couldn't be read
+    if (state == Request::STATE_FAILED && request->fallbackData) {
+        state = Request::STATE_DONE;
+        request->data = request->fallbackData;
+        request->size = request->fallbackSize;
+        request->fallback = true;
+    }
+
+    // Only loaded files keep their buffer
+    if (state != Request::STATE_DONE || request->fallback) {
+        ReleaseBuffer(request->buffer);
+        request->buffer = nullptr;
+    }
+
+    switch (state) {
+    case Request::STATE_DONE:
+        (request->fallback ? fallbacks : loaded)++;
+        break;
+    case Request::STATE_FAILED:
+        failed++;
+        break;
+    case Request::STATE_CANCELED:
+        canceled++;
+        break;
+    default:
+        break;
+    }
+
+    request->state.store(state, std::memory_order_release);
+
+    OSMessage message = {};
+    OSSendMessage(&finishedQueue, &message, OS_MESSAGE_FLAGS_NONE);
+}
+
+AssetLoader::Buffer* AssetLoader::AcquireBuffer(uint32_t size)
+{
+    // The smallest free buffer which fits, otherwise grow the largest free one
+    Buffer* best = nullptr;
+    Buffer* largest = nullptr;
+    for (Buffer& buffer : buffers) {
+        if (buffer.used) {
+            continue;
+        }
+
+        if (buffer.capacity >= size && (!best || buffer.capacity < best->capacity)) {
+            best = &buffer;
+        }
+        if (!largest || buffer.capacity > largest->capacity) {
+            largest = &buffer;
+        }
+    }
+
+    if (!best && largest) {
+        uint8_t* data = (uint8_t*) memalign(BUFFER_ALIGNMENT, size);
+        if (!data) {
+            return nullptr;
+        }
+
+        poolBytes = poolBytes - largest->capacity + size;
+        free(largest->data);
+        largest->data = data;
+        largest->capacity = size;
+        best = largest;
+    }
+
+    if (best) {
+        best->used = true;
+    }
+    return best;
+}
+
+void AssetLoader::ReleaseBuffer(Buffer* buffer)
+{
+    if (!buffer) {
+        return;
+    }
+
+    buffer->used = false;
+
+    // Requests waiting for a buffer can try again
+    for (Request* request : pending) {
+        request->blocked = false;
+    }
+}
+
+void AssetLoader::Send(Command const& command)
+{
+    // Without a worker everything happens right away
+    if (!thread) {
+        HandleCommand(command);
+        while (Process()) {
+        }
+
+        // Nobody would release a buffer for the requests which wait for one
+        for (Request* request : pending) {
+            Finish(request, Request::STATE_FAILED);
+        }
+        pending.clear();
+        return;
+    }
+
+    // Keep the order of backlogged commands
+    Flush();
+    if (backlog.empty() && commands.Push(command)) {
+        Wake();
+        return;
+    }
+
+    backlog.push_back(command);
+}
+
+void AssetLoader::Flush()
+{
+    if (backlog.empty()) {
+        return;
+    }
+
+    uint32_t pushed = 0;
+    while (pushed < backlog.size() && commands.Push(backlog[pushed])) {
+        pushed++;
+    }
+    backlog.erase(backlog.begin(), backlog.begin() + pushed);
+
+    if (pushed) {
+        Wake();
+    }
+}
+
+void AssetLoader::Wake()
+{
+    // Fails if the worker wasn't woken up yet, which is fine
+    OSMessage message = {};
+    OSSendMessage(&wakeQueue, &message, OS_MESSAGE_FLAGS_NONE);
+}
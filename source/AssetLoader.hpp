@@ -0,0 +1,189 @@
+#pragma once
+
+#include "SpscQueue.hpp"
+
+#include <coreinit/thread.h>
+#include <coreinit/messagequeue.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Streams asset files from storage into pooled buffers on a worker thread.
+// Files are read with POSIX calls, which wut maps onto the FS library for fs:/vol/... paths,
+// so the same code runs on Linux. They're read in chunks and the worker picks the most urgent
+// request before every chunk, so a high priority load overtakes a large low priority one and
+// canceled loads stop right away. A load can fall back to data embedded in the executable if
+// the file can't be read.
+class AssetLoader {
+    struct Buffer;
+
+public:
+    static constexpr uint32_t QUEUE_SIZE = 64;
+    static constexpr uint32_t MAX_BUFFERS = 8;
+    static constexpr uint32_t CHUNK_SIZE = 256 * 1024;
+    // Enough for an AssetPack to be used in place
+    static constexpr uint32_t BUFFER_ALIGNMENT = 0x100;
+
+    enum Priority {
+        PRIORITY_LOW,
+        PRIORITY_NORMAL,
+        PRIORITY_HIGH,
+    };
+
+    class Request {
+    public:
+        enum State {
+            STATE_QUEUED,
+            STATE_LOADING,
+            STATE_DONE,
+            STATE_FAILED,
+            STATE_CANCELED,
+        };
+
+        State GetState() const;
+
+        // Done, failed or canceled
+        bool IsFinished() const;
+
+        // Valid once done, until the request is released
+        const void* GetData() const;
+
+        uint32_t GetSize() const;
+
+        // The file couldn't be read and the data is the embedded fallback
+        bool IsFallback() const;
+
+    private:
+        friend AssetLoader;
+
+        std::string path;
+        Priority priority;
+        // Orders requests of the same priority
+        uint32_t sequence;
+
+        const void* fallbackData;
+        uint32_t fallbackSize;
+
+        // Only touched by the worker until the state is published
+        int fd;
+        uint32_t offset;
+        Buffer* buffer;
+        const void* data;
+        uint32_t size;
+        bool fallback;
+        // Waits for a free buffer
+        bool blocked;
+
+        std::atomic<State> state;
+    };
+
+    struct Stats {
+        uint32_t loaded;
+        uint32_t fallbacks;
+        uint32_t failed;
+        uint32_t canceled;
+        uint32_t bytesRead;
+        // Time the worker spent reading since startup
+        float readMs;
+        // Memory held by the buffer pool
+        uint32_t poolBytes;
+    };
+
+    AssetLoader();
+    virtual ~AssetLoader();
+
+    bool Initialize();
+
+    // Requests still loading are canceled, requests which weren't released are freed
+    void Finalize();
+
+    // Load path into a pooled buffer. If it can't be read the request completes with the fallback
+    // data instead, if there is any. The request has to be released once its data isn't needed anymore.
+    Request* Load(const char* path, Priority priority, const void* fallbackData = nullptr, uint32_t fallbackSize = 0);
+
+    // Stop a request which isn't finished yet, it still has to be released
+    void Cancel(Request* request);
+
+    // Cancels the request if it isn't finished and returns its buffer to the pool
+    void Release(Request* request);
+
+    // Block until the request is finished
+    void Wait(Request* request);
+
+    Stats GetStats() const;
+
+private:
+    struct Buffer {
+        uint8_t* data;
+        uint32_t capacity;
+        bool used;
+    };
+
+    enum CommandType {
+        COMMAND_LOAD,
+        COMMAND_CANCEL,
+        COMMAND_RELEASE,
+    };
+
+    struct Command {
+        CommandType type;
+        Request* request;
+    };
+
+    static int WorkerThread(int argc, const char** argv);
+
+    // Worker side, returns false if there is nothing to do
+    bool Process();
+
+    void HandleCommand(Command const& command);
+
+    Request* NextRequest();
+
+    // Returns false once the request is finished
+    bool Step(Request* request);
+
+    void Finish(Request* request, Request::State state);
+
+    Buffer* AcquireBuffer(uint32_t size);
+
+    void ReleaseBuffer(Buffer* buffer);
+
+    // Render thread side
+    void Send(Command const& command);
+
+    void Flush();
+
+    void Wake();
+
+    OSThread* thread;
+    void* threadStack;
+    std::atomic<bool> quit;
+
+    SpscQueue<Command, QUEUE_SIZE> commands;
+    // Commands which didn't fit into the queue
+    std::vector<Command> backlog;
+    uint32_t sequence;
+
+    // Wakes the worker, one message is enough
+    OSMessageQueue wakeQueue;
+    OSMessage wakeMessage;
+
+    // Posted by the worker whenever a request finished
+    OSMessageQueue finishedQueue;
+    OSMessage finishedMessages[QUEUE_SIZE];
+
+    // Owned by the worker, or the render thread without a worker
+    std::vector<Request*> requests;
+    std::vector<Request*> pending;
+    Buffer buffers[MAX_BUFFERS];
+
+    std::atomic<uint32_t> loaded;
+    std::atomic<uint32_t> fallbacks;
+    std::atomic<uint32_t> failed;
+    std::atomic<uint32_t> canceled;
+    std::atomic<uint32_t> bytesRead;
+    std::atomic<float> readMs;
+    std::atomic<uint32_t> poolBytes;
+};
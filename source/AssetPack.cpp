@@ -0,0 +1,97 @@
+#include "AssetPack.hpp"
+
+#include <string.h>
+
+AssetPack::AssetPack()
+{
+}
+
+AssetPack::~AssetPack()
+{
+    Close();
+}
+
+bool AssetPack::Open(const void* data, uint32_t size)
+{
+    Close();
+
+    // Surfaces are used in place, so the pack has to be aligned like them
+    if (((uintptr_t) data & (SURFACE_ALIGNMENT - 1)) != 0 || size < sizeof(Header)) {
+        return false;
+    }
+
+    const Header* header = (const Header*) data;
+    uint32_t numEntries = SwapBE(header->numEntries);
+    if (SwapBE(header->magic) != MAGIC || SwapBE(header->version) != VERSION ||
+        SwapBE(header->size) > size || numEntries > (size - sizeof(Header)) / sizeof(Entry)) {
+        return false;
+    }
+
+    const Entry* entries = (const Entry*) (header + 1);
+    for (uint32_t i = 0; i < numEntries; ++i) {
+        const Entry& entry = entries[i];
+        uint32_t offset = SwapBE(entry.offset);
+        uint32_t imageSize = SwapBE(entry.imageSize);
+
+        if (SwapBE(entry.format) != FORMAT_RGBA8 || SwapBE(entry.tileMode) != TILE_MODE_LINEAR_ALIGNED ||
+            offset > size || imageSize > size - offset || (offset & (SURFACE_ALIGNMENT - 1)) != 0 ||
+            memchr(entry.name, '\0', MAX_NAME_LENGTH) == nullptr) {
+            Close();
+            return false;
+        }
+
+        // The backend checks the layout matches its own
+        void* image = (uint8_t*) data + offset;
+        glm::uvec2 textureSize = glm::uvec2(SwapBE(entry.width), SwapBE(entry.height));
+        Gfx::Texture* tex = Gfx::WrapTexture(textureSize, SwapBE(entry.pitch), image, imageSize);
+        if (!tex) {
+            Close();
+            return false;
+        }
+
+        // Duplicate names keep the first texture
+        if (!textures.emplace(entry.name, tex).second) {
+            tex->Delete();
+        }
+    }
+
+    return true;
+}
+
+void AssetPack::Close()
+{
+    for (auto& it : textures) {
+        it.second->Delete();
+    }
+    textures.clear();
+}
+
+Gfx::Texture* AssetPack::GetTexture(const char* name) const
+{
+    auto it = textures.find(name);
+    if (it == textures.end()) {
+        return nullptr;
+    }
+
+    return it->second;
+}
+
+uint32_t AssetPack::GetNumTextures() const
+{
+    return textures.size();
+}
+
+uint32_t AssetPack::CalcPitch(uint32_t width)
+{
+    // 256 byte pipe interleave, but at least 64 pixels
+    return (width + 63) & ~63u;
+}
+
+uint32_t AssetPack::SwapBE(uint32_t value)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return __builtin_bswap32(value);
+#else
+    return value;
+#endif
+}
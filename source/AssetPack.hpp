@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Gfx.hpp"
+
+#include <string>
+#include <unordered_map>
+
+// Textures cooked offline by host/AssetCooker.cpp.
+// The pack starts with a header and an index of entries, followed by the surfaces in the exact
+// format, tile mode and pitch Gfx::NewTexture would give them. Opening a pack only points textures
+// at the surfaces, nothing is decoded or copied, so the data has to stay mapped while it's open.
+// All header fields are big endian like the console.
+class AssetPack {
+public:
+    static constexpr uint32_t MAGIC = 0x4d444150; // MDAP
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t MAX_NAME_LENGTH = 32;
+    // Surfaces and the pack itself have to be aligned to this
+    static constexpr uint32_t SURFACE_ALIGNMENT = 0x100;
+    // The GX2SurfaceFormat and GX2TileMode of Gfx textures, the only ones packs contain
+    static constexpr uint32_t FORMAT_RGBA8 = 0x1a;
+    static constexpr uint32_t TILE_MODE_LINEAR_ALIGNED = 1;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t numEntries;
+        // Size of the whole pack
+        uint32_t size;
+    };
+
+    struct Entry {
+        // File name without extension, nul terminated
+        char name[MAX_NAME_LENGTH];
+        // From the start of the pack
+        uint32_t offset;
+        uint32_t imageSize;
+        uint32_t width;
+        uint32_t height;
+        // In pixels
+        uint32_t pitch;
+        uint32_t format;
+        uint32_t tileMode;
+        uint32_t alignment;
+    };
+
+    AssetPack();
+    virtual ~AssetPack();
+
+    // Returns false if the pack is invalid or wasn't cooked for this Gfx backend
+    bool Open(const void* data, uint32_t size);
+
+    void Close();
+
+    // Texture owned by the pack, nullptr if there is no asset with this name
+    Gfx::Texture* GetTexture(const char* name) const;
+
+    uint32_t GetNumTextures() const;
+
+    // Pitch in pixels of a linear aligned RGBA8 surface, as calculated by GX2
+    static uint32_t CalcPitch(uint32_t width);
+
+    // Convert between big endian and native byte order
+    static uint32_t SwapBE(uint32_t value);
+
+private:
+    std::unordered_map<std::string, Gfx::Texture*> textures;
+};
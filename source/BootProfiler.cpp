@@ -0,0 +1,151 @@
+#include "BootProfiler.hpp"
+
+#include <coreinit/debug.h>
+
+#include <stdio.h>
+
+// Deeper phases are still timed by their parents
+#define MAX_DEPTH 16
+
+struct Phase {
+    char name[BootProfiler::MAX_NAME];
+    uint32_t depth;
+    OSTime start;
+    OSTime end;
+};
+
+static Phase phases[BootProfiler::MAX_PHASES];
+static uint32_t numPhases = 0;
+static uint32_t droppedPhases = 0;
+
+// Indices of the open phases, -1 for ones which didn't fit
+static int openPhases[MAX_DEPTH];
+static uint32_t depth = 0;
+
+static bool finished = false;
+
+BootProfiler::Scope::Scope(const char* name, const char* detail)
+{
+    BootProfiler::Begin(name, detail);
+}
+
+BootProfiler::Scope::~Scope()
+{
+    BootProfiler::End();
+}
+
+void BootProfiler::Begin(const char* name, const char* detail)
+{
+    if (finished) {
+        return;
+    }
+
+    int index = -1;
+    if (numPhases < MAX_PHASES && depth < MAX_DEPTH) {
+        index = numPhases++;
+
+        Phase& phase = phases[index];
+        if (detail) {
+            snprintf(phase.name, sizeof(phase.name), "%s %s", name, detail);
+        } else {
+            snprintf(phase.name, sizeof(phase.name), "%s", name);
+        }
+        phase.depth = depth;
+        phase.end = 0;
+        phase.start = OSGetTime();
+    } else {
+        droppedPhases++;
+    }
+
+    if (depth < MAX_DEPTH) {
+        openPhases[depth] = index;
+    }
+    depth++;
+}
+
+void BootProfiler::End()
+{
+    if (finished || depth == 0) {
+        return;
+    }
+
+    depth--;
+    if (depth < MAX_DEPTH && openPhases[depth] >= 0) {
+        phases[openPhases[depth]].end = OSGetTime();
+    }
+}
+
+void BootProfiler::Finish()
+{
+    while (depth > 0) {
+        End();
+    }
+
+    finished = true;
+}
+
+bool BootProfiler::IsRecording()
+{
+    return !finished;
+}
+
+void BootProfiler::Report()
+{
+    char line[160];
+    for (uint32_t i = 0; i <= numPhases; ++i) {
+        FormatLine(i, line, sizeof(line));
+        OSReport("%s", line);
+    }
+}
+
+bool BootProfiler::Save(const char* path)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+
+    char line[160];
+    for (uint32_t i = 0; i <= numPhases; ++i) {
+        FormatLine(i, line, sizeof(line));
+        fputs(line, f);
+    }
+
+    return fclose(f) == 0;
+}
+
+void BootProfiler::FormatLine(uint32_t index, char* buffer, uint32_t size)
+{
+    // Summary with the time from the first phase until the last one ended
+    if (index == 0) {
+        OSTime end = 0;
+        for (uint32_t i = 0; i < numPhases; ++i) {
+            if (phases[i].end > end) {
+                end = phases[i].end;
+            }
+        }
+
+        float total = numPhases ? TicksToMilliseconds(end - phases[0].start) : 0.0f;
+        snprintf(buffer, size, "boot %.3f ms, %u phases, %u dropped\n", total, numPhases, droppedPhases);
+        return;
+    }
+
+    Phase const& phase = phases[index - 1];
+    OSTime duration = phase.end ? phase.end - phase.start : 0;
+
+    // Time not covered by direct children
+    OSTime self = duration;
+    for (uint32_t i = index; i < numPhases && phases[i].depth > phase.depth; ++i) {
+        if (phases[i].depth == phase.depth + 1 && phases[i].end) {
+            self -= phases[i].end - phases[i].start;
+        }
+    }
+
+    snprintf(buffer, size, "%10.3f ms %10.3f ms self  %*s%s%s\n", TicksToMilliseconds(duration), TicksToMilliseconds(self),
+        (int) phase.depth * 2, "", phase.name, phase.end ? "" : " (not ended)");
+}
+
+float BootProfiler::TicksToMilliseconds(OSTime ticks)
+{
+    return OSTicksToMicroseconds(ticks) / 1000.0f;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <coreinit/time.h>
+
+#include <cstdint>
+
+// Times named, nested phases of the startup with OSGetTime until Finish is called, after that
+// Begin and End do nothing, so instrumented code which also runs later costs a single check.
+// Only the render thread may record phases.
+class BootProfiler {
+public:
+    static constexpr uint32_t MAX_PHASES = 256;
+    static constexpr uint32_t MAX_NAME = 64;
+
+    // Times the enclosing block
+    class Scope {
+    public:
+        Scope(const char* name, const char* detail = nullptr);
+        virtual ~Scope();
+    };
+
+    // Start a phase inside the current one, the detail is appended to the name
+    static void Begin(const char* name, const char* detail = nullptr);
+
+    static void End();
+
+    // Close all open phases and stop recording
+    static void Finish();
+
+    static bool IsRecording();
+
+    // Print the phases with OSReport
+    static void Report();
+
+    // Write the same report to path, one line per phase so two runs can be diffed
+    static bool Save(const char* path);
+
+private:
+    // Writes line index of the report, 0 is the summary
+    static void FormatLine(uint32_t index, char* buffer, uint32_t size);
+
+    static float TicksToMilliseconds(OSTime ticks);
+};
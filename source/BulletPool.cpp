@@ -0,0 +1,294 @@
+#include "BulletPool.hpp"
+
+#include <algorithm>
+
+BulletPool::BulletPool(glm::vec2 boundsMin, glm::vec2 boundsMax) :
+    boundsMin(boundsMin),
+    boundsMax(boundsMax),
+    count(0),
+    stats()
+{
+    gridWidth = std::max((int) ceil((boundsMax.x - boundsMin.x) / CELL_SIZE), 1);
+    gridHeight = std::max((int) ceil((boundsMax.y - boundsMin.y) / CELL_SIZE), 1);
+    cells.resize(gridWidth * gridHeight, -1);
+}
+
+BulletPool::~BulletPool()
+{
+}
+
+bool BulletPool::Spawn(glm::vec2 position, glm::vec2 velocity, float angle, uint32_t owner, uint32_t timeLeft)
+{
+    if (count == CAPACITY || timeLeft == 0 ||
+        position.x < boundsMin.x || position.x >= boundsMax.x || position.y < boundsMin.y || position.y >= boundsMax.y) {
+        return false;
+    }
+
+    uint32_t i = count++;
+    positionX[i] = position.x;
+    positionY[i] = position.y;
+    previousX[i] = position.x;
+    previousY[i] = position.y;
+    velocityX[i] = velocity.x;
+    velocityY[i] = velocity.y;
+    rotationC[i] = cos(glm::radians(angle));
+    rotationS[i] = sin(glm::radians(angle));
+    this->timeLeft[i] = std::min<uint32_t>(timeLeft, UINT16_MAX);
+    owners[i] = owner;
+    Link(i, GetCellY(position.y) * gridWidth + GetCellX(position.x));
+    return true;
+}
+
+void BulletPool::Update()
+{
+    stats = {};
+
+    // No dependencies between bullets, so this vectorizes
+    for (uint32_t i = 0; i < count; ++i) {
+        previousX[i] = positionX[i];
+        previousY[i] = positionY[i];
+        positionX[i] += velocityX[i];
+        positionY[i] += velocityY[i];
+        timeLeft[i]--;
+    }
+
+    // Retire bullets and move the others between cells. The moved in bullet has to be checked
+    // as well, so only advance if this one stays.
+    for (uint32_t i = 0; i < count;) {
+        float x = positionX[i];
+        float y = positionY[i];
+        if (timeLeft[i] == 0 || x < boundsMin.x || x >= boundsMax.x || y < boundsMin.y || y >= boundsMax.y) {
+            Remove(i);
+            stats.retired++;
+            continue;
+        }
+
+        int cell = GetCellY(y) * gridWidth + GetCellX(x);
+        if (cell != cellOf[i]) {
+            Unlink(i);
+            Link(i, cell);
+            stats.cellMoves++;
+        }
+        ++i;
+    }
+
+    stats.bullets = count;
+}
+
+void BulletPool::Remove(uint32_t index)
+{
+    Unlink(index);
+
+    // Move the last bullet into the gap
+    uint32_t last = --count;
+    if (index == last) {
+        return;
+    }
+
+    positionX[index] = positionX[last];
+    positionY[index] = positionY[last];
+    previousX[index] = previousX[last];
+    previousY[index] = previousY[last];
+    velocityX[index] = velocityX[last];
+    velocityY[index] = velocityY[last];
+    rotationC[index] = rotationC[last];
+    rotationS[index] = rotationS[last];
+    timeLeft[index] = timeLeft[last];
+    owners[index] = owners[last];
+    cellOf[index] = cellOf[last];
+    next[index] = next[last];
+    prev[index] = prev[last];
+
+    // Its neighbours in the cell list have to point at the new index
+    if (prev[index] >= 0) {
+        next[prev[index]] = index;
+    } else {
+        cells[cellOf[index]] = index;
+    }
+    if (next[index] >= 0) {
+        prev[next[index]] = index;
+    }
+}
+
+void BulletPool::Clear()
+{
+    count = 0;
+    std::fill(cells.begin(), cells.end(), -1);
+}
+
+uint32_t BulletPool::GetCount() const
+{
+    return count;
+}
+
+glm::vec2 BulletPool::GetPosition(uint32_t index) const
+{
+    return glm::vec2(positionX[index], positionY[index]);
+}
+
+uint32_t BulletPool::GetOwner(uint32_t index) const
+{
+    return owners[index];
+}
+
+int BulletPool::FindHit(glm::vec2 position, float radius, uint32_t ignoreOwner)
+{
+    float radiusSq = radius * radius;
+
+    // Only the cells the circle overlaps
+    int x0 = GetCellX(position.x - radius);
+    int x1 = GetCellX(position.x + radius);
+    int y0 = GetCellY(position.y - radius);
+    int y1 = GetCellY(position.y + radius);
+
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            for (int32_t i = cells[y * gridWidth + x]; i >= 0; i = next[i]) {
+                if (owners[i] == ignoreOwner) {
+                    continue;
+                }
+
+                stats.pairTests++;
+                float dx = positionX[i] - position.x;
+                float dy = positionY[i] - position.y;
+                if (dx * dx + dy * dy < radiusSq) {
+                    stats.hits++;
+                    return i;
+                }
+            }
+        }
+    }
+
+    return -1;
+}
+
+uint32_t BulletPool::FindPairs(float radius, Pair* pairs, uint32_t maxPairs)
+{
+    float radiusSq = std::min(radius, CELL_SIZE) * std::min(radius, CELL_SIZE);
+
+    // Every neighbouring cell is visited from one side only, so each pair is tested once
+    static const int neighbours[][2] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+
+    uint32_t numPairs = 0;
+    auto test = [&](int32_t a, int32_t b) {
+        if (owners[a] == owners[b]) {
+            return;
+        }
+
+        stats.pairTests++;
+        float dx = positionX[a] - positionX[b];
+        float dy = positionY[a] - positionY[b];
+        if (dx * dx + dy * dy < radiusSq) {
+            if (numPairs < maxPairs) {
+                pairs[numPairs] = { (uint32_t) a, (uint32_t) b };
+            }
+            numPairs++;
+        }
+    };
+
+    for (int y = 0; y < gridHeight; ++y) {
+        for (int x = 0; x < gridWidth; ++x) {
+            for (int32_t a = cells[y * gridWidth + x]; a >= 0; a = next[a]) {
+                // The rest of this cell
+                for (int32_t b = next[a]; b >= 0; b = next[b]) {
+                    test(a, b);
+                }
+
+                for (auto const& offset : neighbours) {
+                    int nx = x + offset[0];
+                    int ny = y + offset[1];
+                    if (nx < 0 || nx >= gridWidth || ny >= gridHeight) {
+                        continue;
+                    }
+
+                    for (int32_t b = cells[ny * gridWidth + nx]; b >= 0; b = next[b]) {
+                        test(a, b);
+                    }
+                }
+            }
+        }
+    }
+
+    stats.hits += numPairs;
+    return numPairs;
+}
+
+const glm::vec2* BulletPool::BuildQuads(Gfx* gfx, glm::vec2 size, float alpha) const
+{
+    if (count == 0) {
+        return nullptr;
+    }
+
+    // Bullets are drawn as quads in world space
+    glm::vec2* vertices = (glm::vec2*) gfx->AllocTransient(count * 4 * sizeof(glm::vec2));
+    if (!vertices) {
+        return nullptr;
+    }
+
+    glm::vec2 halfSize = size / 2.0f;
+    for (uint32_t i = 0; i < count; ++i) {
+        glm::vec2* quad = &vertices[i * 4];
+
+        glm::vec2 position = glm::mix(glm::vec2(previousX[i], previousY[i]), glm::vec2(positionX[i], positionY[i]), alpha);
+        glm::vec2 center = position + halfSize;
+        glm::vec2 right = glm::vec2(rotationC[i], rotationS[i]) * halfSize.x;
+        glm::vec2 down = glm::vec2(-rotationS[i], rotationC[i]) * halfSize.y;
+
+        quad[0] = center - right - down;
+        quad[1] = center + right - down;
+        quad[2] = center + right + down;
+        quad[3] = center - right + down;
+    }
+
+    return vertices;
+}
+
+void BulletPool::Draw(Gfx* gfx, const glm::vec2* quads, glm::vec4 color) const
+{
+    if (!quads) {
+        return;
+    }
+
+    glm::mat4 model = glm::mat4(1.0f);
+    gfx->SetModel(model);
+
+    gfx->Draw(nullptr, quads, count * 4, color, true);
+}
+
+BulletPool::Stats const& BulletPool::GetStats() const
+{
+    return stats;
+}
+
+int BulletPool::GetCellX(float x) const
+{
+    return glm::clamp((int) ((x - boundsMin.x) / CELL_SIZE), 0, gridWidth - 1);
+}
+
+int BulletPool::GetCellY(float y) const
+{
+    return glm::clamp((int) ((y - boundsMin.y) / CELL_SIZE), 0, gridHeight - 1);
+}
+
+void BulletPool::Link(uint32_t index, int cell)
+{
+    cellOf[index] = cell;
+    prev[index] = -1;
+    next[index] = cells[cell];
+    if (next[index] >= 0) {
+        prev[next[index]] = index;
+    }
+    cells[cell] = index;
+}
+
+void BulletPool::Unlink(uint32_t index)
+{
+    if (prev[index] >= 0) {
+        next[prev[index]] = next[index];
+    } else {
+        cells[cellOf[index]] = next[index];
+    }
+    if (next[index] >= 0) {
+        prev[next[index]] = prev[index];
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Gfx.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Fixed capacity pool of bullets with a uniform grid for collision queries.
+// Bullets are stored as structure of arrays and swap-removed once they expire or leave the
+// bounds. Every cell keeps a linked list of its bullets, which is only touched when a bullet
+// crosses into another cell, so the grid is kept up to date instead of being rebuilt each tick.
+class BulletPool {
+public:
+    static constexpr uint32_t CAPACITY = 4096;
+    static constexpr float CELL_SIZE = 128.0f;
+
+    struct Pair {
+        uint32_t a;
+        uint32_t b;
+    };
+
+    // Work done since the last Update
+    struct Stats {
+        uint32_t bullets;
+        uint32_t retired;
+        // Bullets which moved into another cell
+        uint32_t cellMoves;
+        // Narrowphase distance tests of all queries
+        uint32_t pairTests;
+        uint32_t hits;
+    };
+
+    // Bullets outside of the bounds are retired, the grid covers them
+    BulletPool(glm::vec2 boundsMin, glm::vec2 boundsMax);
+    virtual ~BulletPool();
+
+    // Returns false if the pool is full or the position is out of bounds, angle is in degrees
+    bool Spawn(glm::vec2 position, glm::vec2 velocity, float angle, uint32_t owner, uint32_t timeLeft);
+
+    // Move all bullets and retire the expired ones
+    void Update();
+
+    void Remove(uint32_t index);
+
+    void Clear();
+
+    uint32_t GetCount() const;
+
+    glm::vec2 GetPosition(uint32_t index) const;
+
+    uint32_t GetOwner(uint32_t index) const;
+
+    // Index of a bullet closer than radius which isn't owned by ignoreOwner, -1 if there is none
+    int FindHit(glm::vec2 position, float radius, uint32_t ignoreOwner);
+
+    // Pairs of bullets with different owners closer than radius, which may be at most a cell.
+    // Returns the number of pairs found, only the first maxPairs are written.
+    uint32_t FindPairs(float radius, Pair* pairs, uint32_t maxPairs);
+
+    // Write all bullets as rotated rectangles into transient memory, the position is the top left corner.
+    // Positions are interpolated between the last two updates by alpha. Returns nullptr if there are none.
+    const glm::vec2* BuildQuads(Gfx* gfx, glm::vec2 size, float alpha = 1.0f) const;
+
+    // Draw the quads of BuildQuads, they can be drawn several times until the pool changes or the frame ends
+    void Draw(Gfx* gfx, const glm::vec2* quads, glm::vec4 color) const;
+
+    Stats const& GetStats() const;
+
+private:
+    int GetCellX(float x) const;
+
+    int GetCellY(float y) const;
+
+    void Link(uint32_t index, int cell);
+
+    void Unlink(uint32_t index);
+
+    glm::vec2 boundsMin;
+    glm::vec2 boundsMax;
+    int gridWidth;
+    int gridHeight;
+    // First bullet of every cell, -1 if it's empty
+    std::vector<int32_t> cells;
+
+    uint32_t count;
+    Stats stats;
+
+    alignas(16) float positionX[CAPACITY];
+    alignas(16) float positionY[CAPACITY];
+    // Positions before the last update, drawing interpolates between them
+    alignas(16) float previousX[CAPACITY];
+    alignas(16) float previousY[CAPACITY];
+    alignas(16) float velocityX[CAPACITY];
+    alignas(16) float velocityY[CAPACITY];
+    // Rotation as cos and sin
+    alignas(16) float rotationC[CAPACITY];
+    alignas(16) float rotationS[CAPACITY];
+    alignas(16) uint16_t timeLeft[CAPACITY];
+    uint8_t owners[CAPACITY];
+    // Cell lists
+    int32_t cellOf[CAPACITY];
+    int32_t next[CAPACITY];
+    int32_t prev[CAPACITY];
+};
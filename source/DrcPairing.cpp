@@ -1,18 +1,20 @@
 #include "DrcPairing.hpp"
 #include "SceneMgr.hpp"
+#include "Input.hpp"
 
 #include <malloc.h>
 
-#include <vpad/input.h>
 #include <nn/ccr.h>
 #include <nsysccr/cdc.h>
 
-#include "background_png.h"
-
 // 2 minutes timeout
 #define TIMEOUT_SECONDS 120
 
 DrcPairing::DrcPairing(SceneMgr* sceneMgr) :
+    systemOpen(false),
+    imHandle(-1),
+    imRequest(nullptr),
+    imCancelRequest(nullptr),
     sceneMgr(sceneMgr),
     frameCount(0),
     titleText("Pairing second GamePad", 96),
@@ -25,7 +27,7 @@ DrcPairing::DrcPairing(SceneMgr* sceneMgr) :
     state(STATE_START)
 {
     // Load the background
-    background = Sprite::FromPNG(background_png, background_png_size);
+    background = Sprite::FromAsset("background");
     // Fill the entire screen
     background->SetSize(Gfx::screenSpace);
     // Adjust from 1:1 to 16:9
@@ -46,19 +48,51 @@ DrcPairing::DrcPairing(SceneMgr* sceneMgr) :
     hintText.SetPosition(glm::vec2(Gfx::screenSpace.x / 2, Gfx::screenSpace.y - hintText.GetSize().y));
     hintText2.SetCentered(true);
     hintText2.SetPosition(glm::vec2(Gfx::screenSpace.x / 2, Gfx::screenSpace.y - hintText2.GetSize().y));
+}
+
+DrcPairing::~DrcPairing()
+{
+    CloseSystem();
+
+    delete background;
+}
+
+bool DrcPairing::OpenSystem()
+{
+    if (systemOpen) {
+        return true;
+    }
 
     // Initialize IM
     imHandle = IM_Open();
     imRequest = (IMRequest*) memalign(0x40, sizeof(IMRequest));
     // Allocate a separate request for IM_CancelGetEventNotify to avoid conflict with the pending IM_GetEventNotify request
     imCancelRequest = (IMRequest*) memalign(0x40, sizeof(IMRequest));
+    if (imHandle < 0 || !imRequest || !imCancelRequest) {
+        if (imHandle >= 0) {
+            IM_Close(imHandle);
+        }
+        free(imCancelRequest);
+        free(imRequest);
+        imHandle = -1;
+        imRequest = nullptr;
+        imCancelRequest = nullptr;
+        return false;
+    }
 
     // Init CCRSys
     CCRSysInit();
+
+    systemOpen = true;
+    return true;
 }
 
-DrcPairing::~DrcPairing()
+void DrcPairing::CloseSystem()
 {
+    if (!systemOpen) {
+        return;
+    }
+
     // Deinit CCRSys
     CCRSysExit();
 
@@ -67,8 +101,11 @@ DrcPairing::~DrcPairing()
     IM_Close(imHandle);
     free(imCancelRequest);
     free(imRequest);
+    imHandle = -1;
+    imRequest = nullptr;
+    imCancelRequest = nullptr;
 
-    delete background;
+    systemOpen = false;
 }
 
 void DrcPairing::Update()
@@ -80,6 +117,11 @@ void DrcPairing::Update()
 
     switch (state) {
     case STATE_START: {
+        if (!OpenSystem()) {
+            state = STATE_ERROR;
+            return;
+        }
+
         // Setup sync callback to allow cancelling with the SYNC button
         cancelPairing = false;
         // Set mask to only sync events
@@ -139,15 +181,15 @@ void DrcPairing::Update()
     case STATE_ERROR:
     case STATE_DONE: {
         VPADStatus status{};
-        VPADRead(VPAD_CHAN_0, &status, 1, nullptr);
+        Input::Read(VPAD_CHAN_0, &status);
 
         if (status.trigger) {
             // Reset state
             state = STATE_START;
 
-            // Reset sync callback
+            // Reset sync callback and close IM and CCRSys until the next pairing
             cancelPairing = false;
-            IM_CancelGetEventNotify(imHandle, imCancelRequest, nullptr, nullptr);
+            CloseSystem();
 
             // Return to menu
             sceneMgr->SetScene(SceneMgr::SCENE_MENU);
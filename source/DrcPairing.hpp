@@ -21,6 +21,11 @@ private:
     static void SyncButtonCallback(IOSError error, void* arg);
     static inline bool cancelPairing;
 
+    // IM and CCRSys are only open while pairing, so building this scene ahead of time has no side effects
+    bool OpenSystem();
+    void CloseSystem();
+
+    bool systemOpen;
     IOSHandle imHandle;
     IMRequest* imRequest;
     IMRequest* imCancelRequest;
@@ -0,0 +1,176 @@
+#include "ForegroundMgr.hpp"
+
+#include <gx2/draw.h>
+#include <gx2/mem.h>
+#include <coreinit/cache.h>
+#include <coreinit/debug.h>
+#include <coreinit/memheap.h>
+#include <coreinit/memfrmheap.h>
+
+#include <malloc.h>
+#include <string.h>
+
+// Alignment of the MEM2 copies, matches the cache line size
+#define BACKUP_ALIGNMENT 0x40
+
+ForegroundMgr::ForegroundMgr() :
+    acquired(false),
+    released(false),
+    acquireTime(0),
+    resumePending(false)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+ForegroundMgr::~ForegroundMgr()
+{
+    for (Resource& res : resources) {
+        free(res.backup);
+    }
+}
+
+bool ForegroundMgr::Add(void** image, uint32_t size, uint32_t align, Heap heap, GX2InvalidateMode invalidateMode, bool preserve)
+{
+    Resource res;
+    res.image = image;
+    res.size = size;
+    res.align = align;
+    res.heap = heap;
+    res.invalidateMode = invalidateMode;
+    res.backup = nullptr;
+    res.saved = false;
+
+    if (preserve) {
+        res.backup = memalign(BACKUP_ALIGNMENT, size);
+        if (!res.backup) {
+            return false;
+        }
+    }
+
+    *image = nullptr;
+    if (acquired && !Allocate(res)) {
+        free(res.backup);
+        return false;
+    }
+
+    if (preserve) {
+        stats.preservedBytes += size;
+    }
+    resources.push_back(res);
+    return true;
+}
+
+void ForegroundMgr::Remove(void** image)
+{
+    for (auto it = resources.begin(); it != resources.end(); ++it) {
+        if (it->image != image) {
+            continue;
+        }
+
+        if (it->backup) {
+            stats.preservedBytes -= it->size;
+            free(it->backup);
+        }
+
+        *image = nullptr;
+        resources.erase(it);
+        return;
+    }
+}
+
+bool ForegroundMgr::Allocate(Resource& res)
+{
+    MEMHeapHandle heap = MEMGetBaseHeapHandle(res.heap == HEAP_MEM1 ? MEM_BASE_HEAP_MEM1 : MEM_BASE_HEAP_FG);
+    *res.image = MEMAllocFromFrmHeapEx(heap, res.size, res.align);
+    if (!*res.image) {
+        return false;
+    }
+
+    GX2Invalidate(res.invalidateMode, *res.image, res.size);
+    return true;
+}
+
+bool ForegroundMgr::Acquire()
+{
+    acquired = true;
+
+    // Measure until the first frame is presented again, startup isn't a resume
+    acquireTime = OSGetTime();
+    resumePending = released;
+
+    // Resources are allocated in the order they were added, so they get the same addresses
+    // as long as nothing else allocates from the heaps
+    for (Resource& res : resources) {
+        if (!Allocate(res)) {
+            return false;
+        }
+    }
+
+    OSTime restoreStart = OSGetTime();
+    for (Resource& res : resources) {
+        if (!res.saved) {
+            continue;
+        }
+
+        // Write the copy back to memory before the GPU reads it
+        memcpy(*res.image, res.backup, res.size);
+        GX2Invalidate((GX2InvalidateMode) (res.invalidateMode | GX2_INVALIDATE_MODE_CPU), *res.image, res.size);
+        res.saved = false;
+    }
+    stats.lastRestoreMs = OSTicksToMicroseconds(OSGetTime() - restoreStart) / 1000.0f;
+
+    return true;
+}
+
+void ForegroundMgr::Release()
+{
+    if (!acquired) {
+        return;
+    }
+
+    OSTime saveStart = OSGetTime();
+    if (stats.preservedBytes) {
+        // The GPU might still be writing to the resources
+        GX2DrawDone();
+    }
+
+    for (Resource& res : resources) {
+        if (res.backup && *res.image) {
+            // Drop stale cache lines so the copy sees what the GPU wrote
+            DCInvalidateRange(*res.image, res.size);
+            memcpy(res.backup, *res.image, res.size);
+            res.saved = true;
+        }
+
+        *res.image = nullptr;
+    }
+    stats.lastSaveMs = OSTicksToMicroseconds(OSGetTime() - saveStart) / 1000.0f;
+
+    // Free all foreground allocations
+    MEMFreeToFrmHeap(MEMGetBaseHeapHandle(MEM_BASE_HEAP_FG), MEM_FRM_HEAP_FREE_ALL);
+    MEMFreeToFrmHeap(MEMGetBaseHeapHandle(MEM_BASE_HEAP_MEM1), MEM_FRM_HEAP_FREE_ALL);
+
+    acquired = false;
+    released = true;
+}
+
+void ForegroundMgr::OnFramePresented()
+{
+    if (!resumePending) {
+        return;
+    }
+
+    stats.resumeCount++;
+    stats.lastResumeMs = OSTicksToMicroseconds(OSGetTime() - acquireTime) / 1000.0f;
+    resumePending = false;
+
+#ifdef DIAGNOSTICS
+    OSReport("Resume %u: first frame after %.2f ms (saved in %.2f ms, restored in %.2f ms, %u bytes preserved)\n",
+        stats.resumeCount, stats.lastResumeMs, stats.lastSaveMs, stats.lastRestoreMs, stats.preservedBytes);
+#endif
+}
+
+ForegroundMgr::Stats const& ForegroundMgr::GetStats() const
+{
+    return stats;
+}
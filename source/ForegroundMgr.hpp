@@ -0,0 +1,77 @@
+#pragma once
+
+#include <gx2/enum.h>
+#include <coreinit/time.h>
+
+#include <cstdint>
+#include <vector>
+
+// Owns every allocation from the foreground bucket and MEM1 frame heaps.
+// Both heaps are lost while the HOME Menu or another application runs. Resources are
+// re-allocated on every acquire, preserved ones are copied to MEM2 before the release and
+// copied back on acquire, so their contents survive without being rebuilt.
+class ForegroundMgr {
+public:
+    enum Heap {
+        HEAP_MEM1,
+        HEAP_FG,
+    };
+
+    struct Stats {
+        // Number of returns to the foreground
+        uint32_t resumeCount;
+        // Time from the last acquire until the first frame was presented
+        float lastResumeMs;
+        // Time spent copying preserved resources on the last release and acquire
+        float lastSaveMs;
+        float lastRestoreMs;
+        // Bytes copied to MEM2 on every release
+        uint32_t preservedBytes;
+    };
+
+    ForegroundMgr();
+    virtual ~ForegroundMgr();
+
+    // Add a resource which is allocated into image on every acquire, invalidateMode is applied to
+    // the fresh allocation. Allocates right away when already in foreground.
+    bool Add(void** image, uint32_t size, uint32_t align, Heap heap, GX2InvalidateMode invalidateMode, bool preserve);
+
+    // Stop managing a resource, its memory is only returned to the heap on the next release
+    void Remove(void** image);
+
+    // Allocate all resources and restore the preserved ones, called from the acquire callback
+    bool Acquire();
+
+    // Save the preserved resources and free both heaps, called from the release callback
+    void Release();
+
+    // Called after a frame was flipped, finishes the resume measurement
+    void OnFramePresented();
+
+    bool IsAcquired() const { return acquired; }
+
+    Stats const& GetStats() const;
+
+private:
+    struct Resource {
+        void** image;
+        uint32_t size;
+        uint32_t align;
+        Heap heap;
+        GX2InvalidateMode invalidateMode;
+        // MEM2 copy of preserved resources, allocated up front so a release never fails
+        void* backup;
+        bool saved;
+    };
+
+    bool Allocate(Resource& res);
+
+    std::vector<Resource> resources;
+    bool acquired;
+    bool released;
+
+    OSTime acquireTime;
+    bool resumePending;
+
+    Stats stats;
+};
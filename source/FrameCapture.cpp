@@ -0,0 +1,262 @@
+#ifdef DIAGNOSTICS
+#include "FrameCapture.hpp"
+
+#ifdef __WIIU__
+#include <gx2/event.h>
+#include <coreinit/cache.h>
+#endif
+#include <coreinit/time.h>
+
+#include <png.h>
+
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define WORKER_STACK_SIZE (128 * 1024)
+
+// Below the render thread so encoding only uses idle time
+#define WORKER_PRIORITY 20
+
+FrameCapture::FrameCapture() :
+    thread(nullptr),
+    threadStack(nullptr),
+    written(0),
+    failed(0),
+    lastEncodeMs(0.0f),
+    dropped(0)
+{
+    for (Buffer& buffer : buffers) {
+        buffer.pixels = nullptr;
+        buffer.capacity = 0;
+        buffer.state = Buffer::STATE_FREE;
+        buffer.timestamp = 0;
+    }
+}
+
+FrameCapture::~FrameCapture()
+{
+    Finalize();
+}
+
+bool FrameCapture::Initialize()
+{
+    OSInitMessageQueue(&queue, messages, MAX_BUFFERS + 1);
+
+    thread = (OSThread*) memalign(16, sizeof(OSThread));
+    threadStack = memalign(16, WORKER_STACK_SIZE);
+    if (!thread || !threadStack) {
+        Finalize();
+        return false;
+    }
+
+    // Encode on core 2, the render thread runs on core 1
+    if (!OSCreateThread(thread, WorkerThread, 0, (char*) this, (uint8_t*) threadStack + WORKER_STACK_SIZE,
+        WORKER_STACK_SIZE, WORKER_PRIORITY, OS_THREAD_ATTRIB_AFFINITY_CPU2)) {
+        Finalize();
+        return false;
+    }
+
+    OSSetThreadName(thread, "FrameCapture");
+    OSResumeThread(thread);
+
+    return true;
+}
+
+void FrameCapture::Finalize()
+{
+    if (thread && threadStack) {
+        // Let the worker finish the queued captures and quit
+        OSMessage message = {};
+        OSSendMessage(&queue, &message, OS_MESSAGE_FLAGS_BLOCKING);
+        OSJoinThread(thread, nullptr);
+    }
+
+    free(thread);
+    thread = nullptr;
+    free(threadStack);
+    threadStack = nullptr;
+
+    for (Buffer& buffer : buffers) {
+        free(buffer.pixels);
+        buffer.pixels = nullptr;
+        buffer.capacity = 0;
+        buffer.state = Buffer::STATE_FREE;
+    }
+}
+
+bool FrameCapture::AllocateBuffers(const uint32_t* sizes, uint32_t numSizes, uint32_t align)
+{
+    if (buffers[0].pixels) {
+        return true;
+    }
+
+    for (uint32_t i = 0; i < MAX_BUFFERS; ++i) {
+        Buffer& buffer = buffers[i];
+        uint32_t size = sizes[i % numSizes];
+        buffer.pixels = (uint8_t*) memalign(align, size);
+        if (!buffer.pixels) {
+            // Leave none, so the next capture tries again
+            for (Buffer& other : buffers) {
+                free(other.pixels);
+                other.pixels = nullptr;
+                other.capacity = 0;
+            }
+            return false;
+        }
+        buffer.capacity = size;
+    }
+
+    return true;
+}
+
+FrameCapture::Buffer* FrameCapture::Acquire(uint32_t size)
+{
+    if (!thread) {
+        return nullptr;
+    }
+
+    // Keep the larger buffers for the larger targets
+    Buffer* best = nullptr;
+    for (Buffer& buffer : buffers) {
+        if (buffer.state == Buffer::STATE_FREE && buffer.capacity >= size && (!best || buffer.capacity < best->capacity)) {
+            best = &buffer;
+        }
+    }
+
+    if (best) {
+        return best;
+    }
+
+    dropped++;
+    return nullptr;
+}
+
+void FrameCapture::Submit(Buffer* buffer)
+{
+    buffer->timestamp = 0;
+    buffer->state = Buffer::STATE_COPYING;
+}
+
+void FrameCapture::EndFrame(uint64_t timestamp)
+{
+    for (Buffer& buffer : buffers) {
+        if (buffer.state == Buffer::STATE_COPYING && !buffer.timestamp) {
+            buffer.timestamp = timestamp;
+        }
+    }
+}
+
+void FrameCapture::Dispatch()
+{
+#ifdef __WIIU__
+    uint64_t retired = GX2GetRetiredTimeStamp();
+#else
+    // Host backends copy the pixels on the CPU
+    uint64_t retired = UINT64_MAX;
+#endif
+
+    for (Buffer& buffer : buffers) {
+        if (buffer.state != Buffer::STATE_COPYING || !buffer.timestamp || buffer.timestamp > retired) {
+            continue;
+        }
+
+        // The queue has room for every buffer so this never blocks
+        buffer.state = Buffer::STATE_ENCODING;
+        OSMessage message = {};
+        message.message = &buffer;
+        OSSendMessage(&queue, &message, OS_MESSAGE_FLAGS_NONE);
+    }
+}
+
+FrameCapture::Stats FrameCapture::GetStats() const
+{
+    Stats stats;
+    stats.written = written;
+    stats.dropped = dropped;
+    stats.failed = failed;
+    stats.lastEncodeMs = lastEncodeMs;
+    return stats;
+}
+
+int FrameCapture::WorkerThread(int argc, const char** argv)
+{
+    FrameCapture* capture = (FrameCapture*) argv;
+
+    while (true) {
+        OSMessage message;
+        OSReceiveMessage(&capture->queue, &message, OS_MESSAGE_FLAGS_BLOCKING);
+
+        Buffer* buffer = (Buffer*) message.message;
+        if (!buffer) {
+            break;
+        }
+
+#ifdef __WIIU__
+        // The copy was written by the GPU
+        DCInvalidateRange(buffer->pixels, buffer->pitch * buffer->size.y * 4);
+#endif
+
+        OSTime start = OSGetTime();
+        if (WritePNG(buffer)) {
+            capture->written++;
+        } else {
+            capture->failed++;
+        }
+        capture->lastEncodeMs = OSTicksToMicroseconds(OSGetTime() - start) / 1000.0f;
+
+        buffer->state = Buffer::STATE_FREE;
+    }
+
+    return 0;
+}
+
+bool FrameCapture::WritePNG(Buffer* buffer)
+{
+    FILE* f = fopen(buffer->path, "wb");
+    if (!f) {
+        return false;
+    }
+
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png ? png_create_info_struct(png) : nullptr;
+    if (!info) {
+        png_destroy_write_struct(&png, nullptr);
+        fclose(f);
+        return false;
+    }
+
+    // Alpha of the targets isn't shown on screen, store RGB only
+    std::vector<uint8_t> row(buffer->size.x * 3);
+
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        fclose(f);
+        return false;
+    }
+
+    png_init_io(png, f);
+    // Favor speed, captures are taken while playing
+    png_set_compression_level(png, 1);
+    png_set_IHDR(png, info, buffer->size.x, buffer->size.y, 8, PNG_COLOR_TYPE_RGB,
+        PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png, info);
+
+    for (uint32_t y = 0; y < buffer->size.y; ++y) {
+        const uint8_t* src = buffer->pixels + (y * buffer->pitch * 4);
+        for (uint32_t x = 0; x < buffer->size.x; ++x) {
+            row[x * 3    ] = src[x * 4    ];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+
+        png_write_row(png, row.data());
+    }
+
+    png_write_end(png, nullptr);
+    png_destroy_write_struct(&png, &info);
+
+    return fclose(f) == 0;
+}
+#endif
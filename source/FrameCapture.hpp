@@ -0,0 +1,99 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <coreinit/thread.h>
+#include <coreinit/messagequeue.h>
+
+#include <atomic>
+#include <cstdint>
+
+// Encodes captured frames into PNG files on a worker thread, only built with DIAGNOSTICS.
+// The render thread copies a target into a free readback buffer and submits it, the buffer is
+// handed to the worker once the GPU retired the frame. When every buffer is busy the capture is
+// dropped, so capturing never blocks rendering.
+class FrameCapture {
+public:
+    // Readback buffers, enough for two frames of all targets
+    static constexpr uint32_t MAX_BUFFERS = 6;
+
+    static constexpr uint32_t MAX_PATH_LENGTH = 256;
+
+    struct Stats {
+        // PNG files written
+        uint32_t written;
+        // Captures skipped because every buffer was busy
+        uint32_t dropped;
+        // Files which couldn't be written
+        uint32_t failed;
+        // Time the worker spent on the last file
+        float lastEncodeMs;
+    };
+
+    struct Buffer {
+        // RGBA8 rows of pitch pixels
+        uint8_t* pixels;
+        uint32_t capacity;
+        glm::uvec2 size;
+        uint32_t pitch;
+        char path[MAX_PATH_LENGTH];
+
+    private:
+        friend FrameCapture;
+
+        enum State {
+            STATE_FREE,
+            // Waiting for the GPU to finish the copy
+            STATE_COPYING,
+            // Owned by the worker
+            STATE_ENCODING,
+        };
+
+        std::atomic<State> state;
+        uint64_t timestamp;
+    };
+
+    FrameCapture();
+    virtual ~FrameCapture();
+
+    bool Initialize();
+
+    void Finalize();
+
+    // Allocate the readback buffers before the first capture, the buffers are spread evenly over
+    // the sizes so every target has some of its own. Does nothing if they already exist.
+    bool AllocateBuffers(const uint32_t* sizes, uint32_t numSizes, uint32_t align);
+
+    // Get the smallest free buffer of at least size bytes, returns nullptr if the capture has to be dropped
+    Buffer* Acquire(uint32_t size);
+
+    // Queue a filled buffer, the size, pitch and path have to be set
+    void Submit(Buffer* buffer);
+
+    // Mark the end of the current frame, submitted buffers are ready once the GPU reaches timestamp
+    void EndFrame(uint64_t timestamp);
+
+    // Hand all buffers the GPU is done with to the worker
+    void Dispatch();
+
+    Stats GetStats() const;
+
+private:
+    static int WorkerThread(int argc, const char** argv);
+
+    static bool WritePNG(Buffer* buffer);
+
+    Buffer buffers[MAX_BUFFERS];
+
+    OSThread* thread;
+    void* threadStack;
+
+    // One extra entry for the quit message
+    OSMessageQueue queue;
+    OSMessage messages[MAX_BUFFERS + 1];
+
+    std::atomic<uint32_t> written;
+    std::atomic<uint32_t> failed;
+    std::atomic<float> lastEncodeMs;
+    uint32_t dropped;
+};
@@ -1,21 +1,37 @@
 #include "Game.hpp"
 #include "SceneMgr.hpp"
-
-#include <vpad/input.h>
-
-#include "background_png.h"
-#include "border_png.h"
-#include "spaceship_small_red_png.h"
-#include "spaceship_small_blue_png.h"
+#include "Input.hpp"
+#include "Random.hpp"
 
 #define FIELD_WIDTH (1024.0f * 3)
 #define FIELD_HEIGHT (1024.0f * 3)
 #define BORDER_SIZE 1024.0f
 
+#define PARTICLE_SIZE 2.0f
+#define EXPLOSION_PARTICLES 100
+#define BOOST_PARTICLES 30
+#define BULLET_SIZE glm::vec2(4.0f, 10.0f)
+
 #define NUM_LIVES 5
 #define HEART_FULL "\ue017" // "\u2665"
 #define HEART_EMPTY "\ue01f" // "\u2661"
 
+// Particles only vary in red between 0.5 and 1.0, they're grouped into shades for batching
+static uint32_t GetParticleBucket(float red)
+{
+    int bucket = (int) ((red - 0.5f) * 2.0f * ParticlePool::NUM_BUCKETS);
+    return glm::clamp(bucket, 0, (int) ParticlePool::NUM_BUCKETS - 1);
+}
+
+// Gameplay draws from its own stream, so effects don't change where players spawn
+static glm::vec2 RandomFieldPosition()
+{
+    Random& random = Random::GetStream(Random::STREAM_GAME);
+    float x = random.Float(-(FIELD_WIDTH / 2), (FIELD_WIDTH / 2));
+    float y = random.Float(-(FIELD_HEIGHT / 2), (FIELD_HEIGHT / 2));
+    return glm::vec2(x, y);
+}
+
 Game::Game(SceneMgr* sceneMgr) :
     sceneMgr(sceneMgr),
     frameCount(0),
@@ -28,7 +44,11 @@ Game::Game(SceneMgr* sceneMgr) :
     tvPlayerLives{
         Text("-", 64, glm::vec2(0.0f), glm::vec2(1.0f), 0.0f, glm::vec4(0.89f, 0.0f, 0.0f, 1.0f)),
         Text("-", 64, glm::vec2(0.0f), glm::vec2(1.0f), 0.0f, glm::vec4(0.2f, 0.62f, 0.8f, 1.0f)),
-    }
+    },
+    // Bullets are retired once they left the borders
+    bullets(glm::vec2(-(FIELD_WIDTH / 2 + BORDER_SIZE), -(FIELD_HEIGHT / 2 + BORDER_SIZE)),
+        glm::vec2(FIELD_WIDTH / 2 + BORDER_SIZE, FIELD_HEIGHT / 2 + BORDER_SIZE)),
+    interpolation(1.0f)
 {
     // Initialize pause items
     pauseBackground.SetVisible(false);
@@ -48,14 +68,14 @@ Game::Game(SceneMgr* sceneMgr) :
     gameOverSubText.SetVisible(false);
 
     // Initialize map items
-    mapBackground = Sprite::FromPNG(background_png, background_png_size);
+    mapBackground = Sprite::FromAsset("background");
     mapBackground->SetCentered(true);
     mapBackground->SetSize(glm::vec2(512.0f));
     mapBackground->SetPosition(Gfx::screenSpace / 2.0f);
-    mapPlayers[0] = Sprite::FromPNG(spaceship_small_red_png, spaceship_small_red_png_size);
+    mapPlayers[0] = Sprite::FromAsset("spaceship_small_red");
     mapPlayers[0]->SetCentered(true);
     mapPlayers[0]->SetScale(glm::vec2(0.5f));
-    mapPlayers[1] = Sprite::FromPNG(spaceship_small_blue_png, spaceship_small_blue_png_size);
+    mapPlayers[1] = Sprite::FromAsset("spaceship_small_blue");
     mapPlayers[1]->SetCentered(true);
     mapPlayers[1]->SetScale(glm::vec2(0.5f));
 
@@ -72,8 +92,8 @@ Game::Game(SceneMgr* sceneMgr) :
         Gfx::screenSpace.y - tvPlayerLives[1].GetSize().y));
 
     // Load the backgrounds
-    background = Sprite::FromPNG(background_png, background_png_size);
-    tvBackground = Sprite::FromPNG(border_png, border_png_size);
+    background = Sprite::FromAsset("background");
+    tvBackground = Sprite::FromAsset("border");
     // Fill the entire screen
     background->SetSize(Gfx::screenSpace);
     tvBackground->SetSize(Gfx::screenSpace);
@@ -87,25 +107,25 @@ Game::Game(SceneMgr* sceneMgr) :
 
     // Create borders
     // Top
-    borders[0] = Sprite::FromPNG(border_png, border_png_size);
+    borders[0] = Sprite::FromAsset("border");
     borders[0]->SetPosition(glm::vec2(0.0f, -((FIELD_HEIGHT + BORDER_SIZE) / 2)));
     borders[0]->SetSize(glm::vec2(FIELD_WIDTH + BORDER_SIZE, BORDER_SIZE));
     borders[0]->SetCentered(true);
     borders[0]->SetUVScale(glm::vec2(borders[0]->GetSize().x / 1024.0f, borders[0]->GetSize().y / 1024.0f));
     // Bottom
-    borders[1] = Sprite::FromPNG(border_png, border_png_size);
+    borders[1] = Sprite::FromAsset("border");
     borders[1]->SetPosition(glm::vec2(0.0f, (FIELD_HEIGHT + BORDER_SIZE) / 2));
     borders[1]->SetSize(glm::vec2(FIELD_WIDTH + BORDER_SIZE, BORDER_SIZE));
     borders[1]->SetCentered(true);
     borders[1]->SetUVScale(glm::vec2(borders[1]->GetSize().x / 1024.0f, borders[1]->GetSize().y / 1024.0f));
     // Left
-    borders[2] = Sprite::FromPNG(border_png, border_png_size);
+    borders[2] = Sprite::FromAsset("border");
     borders[2]->SetPosition(glm::vec2(-((FIELD_WIDTH + BORDER_SIZE) / 2), 0.0f));
     borders[2]->SetSize(glm::vec2(BORDER_SIZE, FIELD_HEIGHT + BORDER_SIZE));
     borders[2]->SetCentered(true);
     borders[2]->SetUVScale(glm::vec2(borders[2]->GetSize().x / 1024.0f, borders[2]->GetSize().y / 1024.0f));
     // Right
-    borders[3] = Sprite::FromPNG(border_png, border_png_size);
+    borders[3] = Sprite::FromAsset("border");
     borders[3]->SetPosition(glm::vec2((FIELD_WIDTH + BORDER_SIZE) / 2, 0.0f));
     borders[3]->SetSize(glm::vec2(BORDER_SIZE, FIELD_HEIGHT + BORDER_SIZE));
     borders[3]->SetCentered(true);
@@ -134,10 +154,16 @@ Game::~Game()
 
 void Game::Update()
 {
+    // Keep the state of the last step for drawing in between
+    for (Player* p : players) {
+        p->previousPosition = p->position;
+        p->previousAngle = p->angle;
+    }
+
     // Handle paused state
     if (paused || gameOver) {
         VPADStatus status{};
-        VPADRead(VPAD_CHAN_0, &status, 1, nullptr);
+        Input::Read(VPAD_CHAN_0, &status);
 
         // Continue
         if (status.trigger & (VPAD_BUTTON_A | VPAD_BUTTON_PLUS)) {
@@ -160,84 +186,107 @@ void Game::Update()
 
     frameCount++;
 
+    // Update particles and bullets
+    particles.Update();
+    bullets.Update();
+
     // Update players
     for (Player* p : players) {
         p->Update();
 
-        // Check for collision against the other players bullets
-        for (Bullet& b : players[p->playerNum ? 0 : 1]->bullets) {
-            // Use a simple distance check, not great but will do for this demo
-            if (glm::length(b.sprite.GetPosition() - p->sprite->GetPosition()) < 32.0f) {
-                // Spawn explosion particles
-                for (int i = 0; i < 100; ++i) {
-                    p->particles.push_back(Particle{
-                        Sprite(
-                            // Position: Create particles around player
-                            p->sprite->GetPosition() + glm::vec2(frand(-2.5f, 2.5f), frand(-2.5f, 2.5f)),
-                            // Size
-                            glm::vec2(2.0f),
-                            // Angle: Random rotations
-                            frand(-90.0f, 90.0f),
-                            // Color: Random reddish colors
-                            glm::vec4(frand(0.5f, 1.0f), 0.0f, 0.0f, 1.0f)
-                        ),
-                        // Velocity: random velocity
-                        glm::vec2(frand(-1.0f, 1.0f), frand(-1.0f, 1.0f)),
-                        // Random time-to-live
-                        20u + (rand() % 20)
-                    });
-                }
+        // Check for collision against the other players bullets, the grid only tests the ones nearby
+        int hit = bullets.FindHit(p->position, 32.0f, p->playerNum);
+        if (hit >= 0) {
+            // The bullet is used up
+            bullets.Remove(hit);
+
+            // Generate the random values for the whole explosion at once
+            Random& random = Random::GetStream(Random::STREAM_PARTICLES);
+            float offsets[EXPLOSION_PARTICLES * 2], velocities[EXPLOSION_PARTICLES * 2];
+            float angles[EXPLOSION_PARTICLES], reds[EXPLOSION_PARTICLES], lifetimes[EXPLOSION_PARTICLES];
+            random.Floats(offsets, EXPLOSION_PARTICLES * 2, -2.5f, 2.5f);
+            random.Floats(velocities, EXPLOSION_PARTICLES * 2, -1.0f, 1.0f);
+            random.Floats(angles, EXPLOSION_PARTICLES, -90.0f, 90.0f);
+            random.Floats(reds, EXPLOSION_PARTICLES, 0.5f, 1.0f);
+            random.Floats(lifetimes, EXPLOSION_PARTICLES, 20.0f, 40.0f);
+
+            // Spawn explosion particles
+            for (int i = 0; i < EXPLOSION_PARTICLES; ++i) {
+                particles.Spawn(
+                    // Position: Create particles around player
+                    p->position + glm::vec2(offsets[i * 2], offsets[i * 2 + 1]),
+                    // Velocity: random velocity
+                    glm::vec2(velocities[i * 2], velocities[i * 2 + 1]),
+                    // Angle: Random rotations
+                    angles[i],
+                    // Color: Random reddish colors
+                    GetParticleBucket(reds[i]),
+                    // Random time-to-live
+                    (uint32_t) lifetimes[i]
+                );
+            }
 
-                // Decrease lives
-                p->lives--;
-                std::string text;
-                for (uint32_t i = 0; i < NUM_LIVES; ++i) {
-                    if (p->lives > i) {
-                        text += HEART_FULL;
-                    } else {
-                        text += HEART_EMPTY;
-                    }
-                }
-                p->livesText.SetText(text);
-                tvPlayerLives[p->playerNum].SetText(text);
-
-                // Handle game over
-                if (p->lives == 0) {
-                    // Hide the player
-                    p->sprite->SetVisible(false);
-                    
-                    gameOver = true;
-                    winner = !p->playerNum;
-                    // Show pause and game over texts
-                    pauseBackground.SetVisible(true);
-                    pauseHint.SetVisible(true);
-                    gameOverText.SetVisible(true);
-                    gameOverSubText.SetVisible(true);
-
-                    // Update text and color to match winner
-                    gameOverSubText.SetText(winner ? "Player 2 won!" : "Player 1 won!");
-                    gameOverSubText.SetColor(winner ? glm::vec4(0.2f, 0.62f, 0.8f, 1.0f) : glm::vec4(0.89f, 0.0f, 0.0f, 1.0f));
-                    return;
+            // Decrease lives
+            p->lives--;
+            std::string text;
+            for (uint32_t i = 0; i < NUM_LIVES; ++i) {
+                if (p->lives > i) {
+                    text += HEART_FULL;
+                } else {
+                    text += HEART_EMPTY;
                 }
-
-                // Place player in a random position
-                p->sprite->SetPosition(glm::vec2(
-                    frand(-(FIELD_WIDTH / 2), (FIELD_WIDTH / 2)),
-                    frand(-(FIELD_HEIGHT / 2), (FIELD_HEIGHT / 2))));
             }
+            p->livesText.SetText(text);
+            tvPlayerLives[p->playerNum].SetText(text);
+
+            // Handle game over
+            if (p->lives == 0) {
+                // Hide the player
+                p->sprite->SetVisible(false);
+                
+                gameOver = true;
+                winner = !p->playerNum;
+                // Show pause and game over texts
+                pauseBackground.SetVisible(true);
+                pauseHint.SetVisible(true);
+                gameOverText.SetVisible(true);
+                gameOverSubText.SetVisible(true);
+
+                // Update text and color to match winner
+                gameOverSubText.SetText(winner ? "Player 2 won!" : "Player 1 won!");
+                gameOverSubText.SetColor(winner ? glm::vec4(0.2f, 0.62f, 0.8f, 1.0f) : glm::vec4(0.89f, 0.0f, 0.0f, 1.0f));
+                return;
+            }
+
+            // Place player in a random position
+            p->position = RandomFieldPosition();
+            p->previousPosition = p->position;
         }
     }
 
     // Animate the TV background
     tvBackground->SetUVOffset(glm::vec2(frameCount * 0.005f, frameCount * -0.005f));
+}
+
+void Game::Interpolate(float alpha)
+{
+    // Nothing moves while paused
+    if (paused || gameOver) {
+        alpha = 1.0f;
+    }
+    interpolation = alpha;
 
-    // Update map player icons
-    mapPlayers[0]->SetPosition((Gfx::screenSpace / 2.0f) + (glm::vec2(
-        players[0]->sprite->GetPosition().x / FIELD_WIDTH, players[0]->sprite->GetPosition().y / FIELD_HEIGHT) * 512.0f));
-    mapPlayers[0]->SetAngle(players[0]->sprite->GetAngle());
-    mapPlayers[1]->SetPosition((Gfx::screenSpace / 2.0f) + (glm::vec2(
-        players[1]->sprite->GetPosition().x / FIELD_WIDTH, players[1]->sprite->GetPosition().y / FIELD_HEIGHT) * 512.0f));
-    mapPlayers[1]->SetAngle(players[1]->sprite->GetAngle());
+    for (Player* p : players) {
+        // Turn the short way around, angles are between -180 and 180
+        float turn = fmod(p->angle - p->previousAngle + 540.0f, 360.0f) - 180.0f;
+        p->sprite->SetPosition(glm::mix(p->previousPosition, p->position, alpha));
+        p->sprite->SetAngle(p->previousAngle + turn * alpha);
+
+        // Update map player icons
+        mapPlayers[p->playerNum]->SetPosition((Gfx::screenSpace / 2.0f) + (glm::vec2(
+            p->sprite->GetPosition().x / FIELD_WIDTH, p->sprite->GetPosition().y / FIELD_HEIGHT) * 512.0f));
+        mapPlayers[p->playerNum]->SetAngle(p->sprite->GetAngle());
+    }
 }
 
 void Game::DrawScene(Gfx* gfx, Gfx::Target target)
@@ -279,14 +328,19 @@ void Game::DrawScene(Gfx* gfx, Gfx::Target target)
             s->Draw(gfx);
         }
 
+        // Build the particle and bullet quads once, they're drawn twice
+        const glm::vec2* particleQuads = particles.BuildQuads(gfx, PARTICLE_SIZE, interpolation);
+        const glm::vec2* bulletQuads = bullets.BuildQuads(gfx, BULLET_SIZE, interpolation);
+
         // Draw particles and bullets first so they don't overlap players
-        for (Player* p : players) {
-            for (Particle& part : p->particles) {
-                part.sprite.Draw(gfx);
-            }
-            for (Bullet& b : p->bullets) {
-                b.sprite.Draw(gfx);
-            }
+        DrawParticles(gfx, particleQuads);
+        DrawBullets(gfx, bulletQuads);
+
+        // Draw them again into the emissive layer to make them glow
+        if (gfx->BeginEmissive()) {
+            DrawParticles(gfx, particleQuads);
+            DrawBullets(gfx, bulletQuads);
+            gfx->EndEmissive();
         }
 
         // Draw player sprites
@@ -315,15 +369,29 @@ void Game::DrawScene(Gfx* gfx, Gfx::Target target)
     }
 }
 
+void Game::DrawParticles(Gfx* gfx, const glm::vec2* quads)
+{
+    // One shade of red per bucket
+    glm::vec4 colors[ParticlePool::NUM_BUCKETS];
+    for (uint32_t i = 0; i < ParticlePool::NUM_BUCKETS; ++i) {
+        colors[i] = glm::vec4(0.5f + 0.5f * (i + 1) / ParticlePool::NUM_BUCKETS, 0.0f, 0.0f, 1.0f);
+    }
+
+    particles.Draw(gfx, quads, colors);
+}
+
+void Game::DrawBullets(Gfx* gfx, const glm::vec2* quads)
+{
+    bullets.Draw(gfx, quads, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+}
+
 void Game::Reset()
 {
     for (Player* p : players) {
-        p->bullets.clear();
-        p->particles.clear();
         p->lives = NUM_LIVES;
         p->shootTimeout = 0;
         p->velocity = glm::vec2(0.0f);
-        p->sprite->SetAngle(0.0f);
+        p->angle = 0.0f;
         p->sprite->SetVisible(true);
 
         std::string text;
@@ -334,13 +402,18 @@ void Game::Reset()
         tvPlayerLives[p->playerNum].SetText(text);
     }
 
+    particles.Clear();
+    bullets.Clear();
+
     // Place players in a random position
-    players[0]->sprite->SetPosition(glm::vec2(
-        frand(-(FIELD_WIDTH / 2), (FIELD_WIDTH / 2)),
-        frand(-(FIELD_HEIGHT / 2), (FIELD_HEIGHT / 2))));
-    players[1]->sprite->SetPosition(glm::vec2(
-        frand(-(FIELD_WIDTH / 2), (FIELD_WIDTH / 2)),
-        frand(-(FIELD_HEIGHT / 2), (FIELD_HEIGHT / 2))));
+    players[0]->position = RandomFieldPosition();
+    players[1]->position = RandomFieldPosition();
+
+    // Don't interpolate from where the last game ended
+    for (Player* p : players) {
+        p->previousPosition = p->position;
+        p->previousAngle = p->angle;
+    }
 
     gameOver = false;
     gameOverText.SetVisible(false);
@@ -365,12 +438,14 @@ Game::Player::Player(Game* game, int playerNum) :
     livesText("-", 64, glm::vec2(0.0f), glm::vec2(1.0f), 0.0f,
         playerNum ? glm::vec4(0.2f, 0.62f, 0.8f, 1.0f) : glm::vec4(0.89f, 0.0f, 0.0f, 1.0f)),
     shootTimeout(0),
+    position(glm::vec2(0.0f)),
+    previousPosition(glm::vec2(0.0f)),
+    angle(0.0f),
+    previousAngle(0.0f),
     velocity(glm::vec2(0.0f))
 {
     // Load player sprite
-    sprite = Sprite::FromPNG(
-            playerNum ? spaceship_small_blue_png : spaceship_small_red_png,
-            playerNum ? spaceship_small_blue_png_size : spaceship_small_red_png_size);
+    sprite = Sprite::FromAsset(playerNum ? "spaceship_small_blue" : "spaceship_small_red");
     sprite->SetCentered(true);
     sprite->SetScale(glm::vec2(1.5f));
     // Disable filtering for pixel art
@@ -388,7 +463,7 @@ Game::Player::~Player()
 void Game::Player::Update()
 {
     VPADStatus status{};
-    VPADRead((VPADChan) playerNum, &status, 1, nullptr);
+    Input::Read((VPADChan) playerNum, &status);
 
     // Pause (only allowed by host)
     if (playerNum == 0 && (status.trigger & VPAD_BUTTON_PLUS)) {
@@ -398,21 +473,17 @@ void Game::Player::Update()
     // Shoot
     if (status.hold & (VPAD_BUTTON_ZR | VPAD_BUTTON_R)) {
         if (shootTimeout == 0) {
-            bullets.push_back(Bullet{
-                Sprite(
-                    // Position: Spawn bullet at player position
-                    sprite->GetPosition(),
-                    // Size
-                    glm::vec2(4.0f, 10.0f),
-                    // Use player angle for rotation
-                    sprite->GetAngle(),
-                    // Color
-                    glm::vec4(0.0f, 0.0f, 1.0f, 1.0f)),
+            game->bullets.Spawn(
+                // Position: Spawn bullet at player position
+                position,
                 // Bullet velocity based on direction and current player velocity
-                sprite->GetForwardVector() * (16.0f + glm::length(velocity)),
+                GetForwardVector() * (16.0f + glm::length(velocity)),
+                // Use player angle for rotation
+                angle,
+                playerNum,
                 // time to live
                 600
-            });
+            );
 
             // Set timeout
             shootTimeout = 5;
@@ -437,43 +508,47 @@ void Game::Player::Update()
             // Double speed while boosting
             speed *= 2.0f;
 
+            // Generate the random values for the whole trail at once
+            Random& random = Random::GetStream(Random::STREAM_PARTICLES);
+            float offsets[BOOST_PARTICLES * 2], angles[BOOST_PARTICLES], reds[BOOST_PARTICLES], lifetimes[BOOST_PARTICLES];
+            random.Floats(offsets, BOOST_PARTICLES * 2);
+            random.Floats(angles, BOOST_PARTICLES, -90.0f, 90.0f);
+            random.Floats(reds, BOOST_PARTICLES, 0.5f, 1.0f);
+            random.Floats(lifetimes, BOOST_PARTICLES, 40.0f, 80.0f);
+
             // Spawn boost particles
-            for (int i = 0; i < 30; ++i) {
-                particles.push_back(Particle{
-                    Sprite(
-                        // Position: Create trail of particles behind player
-                        sprite->GetPosition() + (leftStick * glm::vec2(-(i % 15))),
-                        // Size
-                        glm::vec2(2.0f),
-                        // Angle: Random rotations
-                        frand(-90.0f, 90.0f),
-                        // Color: Random reddish colors
-                        glm::vec4(frand(0.5f, 1.0f) + 0.5f, 0.0f, 0.0f, 1.0f)
-                    ),
+            for (int i = 0; i < BOOST_PARTICLES; ++i) {
+                game->particles.Spawn(
+                    // Position: Create trail of particles behind player
+                    position + (leftStick * glm::vec2(-(i % 15))),
                     // Velocity: Move in opposite player position with random offsets
-                    -sprite->GetForwardVector() + glm::vec2(frand(), frand()),
+                    -GetForwardVector() + glm::vec2(offsets[i * 2], offsets[i * 2 + 1]),
+                    // Angle: Random rotations
+                    angles[i],
+                    // Color: Random reddish colors
+                    GetParticleBucket(reds[i] + 0.5f),
                     // Random time-to-live
-                    40u + (rand() % 40)
-                });
+                    (uint32_t) lifetimes[i]
+                );
             }
         }
 
         // Set velocity based on stick and speed
         velocity = leftStick * speed;
         // Rotate player in move direction
-        sprite->SetAngle(glm::degrees(atan2(leftStick.x, -leftStick.y)));
+        angle = glm::degrees(atan2(leftStick.x, -leftStick.y));
     }
 
     // Check for border collision
-    if ((sprite->GetPosition().x + velocity.x) > (FIELD_WIDTH / 2) || (sprite->GetPosition().x + velocity.x) < -(FIELD_WIDTH / 2)) {
+    if ((position.x + velocity.x) > (FIELD_WIDTH / 2) || (position.x + velocity.x) < -(FIELD_WIDTH / 2)) {
         velocity.x = -velocity.x * 3.0f;
     }
-    if ((sprite->GetPosition().y + velocity.y) > (FIELD_HEIGHT / 2) || (sprite->GetPosition().y + velocity.y) < -(FIELD_HEIGHT / 2)) {
+    if ((position.y + velocity.y) > (FIELD_HEIGHT / 2) || (position.y + velocity.y) < -(FIELD_HEIGHT / 2)) {
         velocity.y = -velocity.y * 3.0f;
     }
 
     // Update position
-    sprite->SetPosition(sprite->GetPosition() + velocity);
+    position += velocity;
 
     // Update velocity: Slowly decreasing
     velocity *= glm::vec2(0.95f);
@@ -483,28 +558,11 @@ void Game::Player::Update()
 
     // Right stick overrides rotation
     if (glm::length(rightStick) > 0.1f) {
-        sprite->SetAngle(glm::degrees(atan2(rightStick.x, -rightStick.y)));
+        angle = glm::degrees(atan2(rightStick.x, -rightStick.y));
     }
+}
 
-    // Update particles
-    for (size_t i = 0; i < particles.size(); ++i) {
-        Particle& p = particles[i];
-        if (--p.timeLeft == 0) {
-            particles.erase(particles.begin() + i);
-            continue;;
-        }
-
-        p.sprite.SetPosition(p.sprite.GetPosition() + p.velocity);
-    }
-
-    // Update bullets
-    for (size_t i = 0; i < bullets.size(); ++i) {
-        Bullet& b = bullets[i];
-        if (--b.timeLeft == 0) {
-            bullets.erase(bullets.begin() + i);
-            continue;;
-        }
-
-        b.sprite.SetPosition(b.sprite.GetPosition() + b.velocity);
-    }
+glm::vec2 Game::Player::GetForwardVector() const
+{
+    return glm::vec2(sin(glm::radians(angle)), -cos(glm::radians(angle)));
 }
@@ -3,6 +3,8 @@
 #include "Gfx.hpp"
 #include "Sprite.hpp"
 #include "Text.hpp"
+#include "ParticlePool.hpp"
+#include "BulletPool.hpp"
 
 #include <vector>
 
@@ -21,7 +23,14 @@ public:
 
     void PauseGame(bool pause);
 
+    // Position the sprites between the last two steps for drawing
+    void Interpolate(float alpha);
+
 private:
+    void DrawParticles(Gfx* gfx, const glm::vec2* quads);
+
+    void DrawBullets(Gfx* gfx, const glm::vec2* quads);
+
     SceneMgr* sceneMgr;
 
     uint32_t frameCount;
@@ -44,18 +53,6 @@ private:
     Sprite* background;
     Sprite* borders[4];
 
-    struct Bullet {
-        Sprite sprite;
-        glm::vec2 velocity;
-        uint32_t timeLeft;
-    };
-
-    struct Particle {
-        Sprite sprite;
-        glm::vec2 velocity;
-        uint32_t timeLeft;
-    };
-
     struct Player {
         Game* game;
         int playerNum;
@@ -63,17 +60,31 @@ private:
         Text livesText;
         uint32_t shootTimeout;
 
-        Sprite* sprite;
+        // Simulated state, the sprite is placed between the last two steps for drawing
+        glm::vec2 position;
+        glm::vec2 previousPosition;
+        float angle;
+        float previousAngle;
         glm::vec2 velocity;
 
-        std::vector<Bullet> bullets;
-        std::vector<Particle> particles;
+        Sprite* sprite;
 
         Player(Game* game, int playerNum);
         virtual ~Player();
 
         void Update();
+
+        glm::vec2 GetForwardVector() const;
     };
 
     Player* players[2];
+
+    // Explosion and boost particles of both players
+    ParticlePool particles;
+
+    // Bullets of both players
+    BulletPool bullets;
+
+    // Where drawing is between the last two steps
+    float interpolation;
 };
@@ -1,4 +1,5 @@
 #include "Gfx.hpp"
+#include "BootProfiler.hpp"
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -13,14 +14,50 @@
 #include <gx2/swap.h>
 #include <gx2/utils.h>
 
-#include <coreinit/memfrmheap.h>
+#include <coreinit/cache.h>
 #include <proc_ui/procui.h>
 
+#include <algorithm>
 #include <malloc.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "colorShader_gsh.h"
 #include "textureShader_gsh.h"
 
+// Gaussian blur taps using linear filtering to sample two texels at once
+static const float bloomTapOffsets[] = { 0.0f, 1.3846153846f, 3.2307692308f };
+static const float bloomTapWeights[] = { 0.2270270270f, 0.3162162162f, 0.0702702703f };
+
+// Strength of the bloom when compositing it onto the target
+#define BLOOM_INTENSITY 1.5f
+
+// Unit quad scaled to the full screen space
+static const float fullscreenVertices[][4] __attribute__ ((aligned (GX2_VERTEX_BUFFER_ALIGNMENT))) = {
+    { 0.0f, 1.0f, 0.0f, 1.0f, },
+    { 1.0f, 0.0f, 1.0f, 0.0f, },
+    { 0.0f, 0.0f, 0.0f, 0.0f, },
+    { 0.0f, 1.0f, 0.0f, 1.0f, },
+    { 1.0f, 1.0f, 1.0f, 1.0f, },
+    { 1.0f, 0.0f, 1.0f, 0.0f, },
+};
+
+// GPU timer slots, each target has a begin and end sample followed by the swap
+#define GPU_SAMPLE_TARGET_BEGIN(target) ((target) * 2)
+#define GPU_SAMPLE_TARGET_END(target) ((target) * 2 + 1)
+#define GPU_SAMPLE_SWAP (NUM_TARGETS * 2)
+
+// Every fragment adds to a black body heatmap in rgb and counts in alpha
+static const glm::vec4 overdrawColor = glm::vec4(0.25f, 0.125f, 0.0625f, 1.0f / 255.0f);
+
+// Size of the ring buffer used for per-frame vertex and uniform data
+#define TRANSIENT_BUFFER_SIZE (1024 * 1024)
+
+#ifdef DIAGNOSTICS
+// File name suffixes of captured targets
+static const char* const captureTargetNames[] = { "tv", "drc0", "drc1" };
+#endif
+
 static void InitColorBuffer(GX2ColorBuffer& cb, glm::uvec2& size, GX2SurfaceFormat format)
 {
     memset(&cb, 0, sizeof(GX2ColorBuffer));
@@ -37,12 +74,56 @@ static void InitColorBuffer(GX2ColorBuffer& cb, glm::uvec2& size, GX2SurfaceForm
     GX2InitColorBufferRegs(&cb);
 }
 
+static void InitColorBufferTexture(GX2Texture& tex, GX2ColorBuffer& cb)
+{
+    memset(&tex, 0, sizeof(GX2Texture));
+    tex.surface = cb.surface;
+    tex.surface.use = GX2_SURFACE_USE_TEXTURE;
+    tex.viewFirstMip = 0;
+    tex.viewNumMips = 1;
+    tex.viewFirstSlice = 0;
+    tex.viewNumSlices = 1;
+    tex.compMap = GX2_COMP_MAP(GX2_SQ_SEL_R, GX2_SQ_SEL_G, GX2_SQ_SEL_B, GX2_SQ_SEL_A);
+    GX2InitTextureRegs(&tex);
+}
+
+#ifdef DIAGNOSTICS
+// Copying into a linear surface detiles the color buffer on the GPU
+static void InitCaptureSurface(GX2Surface* surface, GX2ColorBuffer const& cb)
+{
+    *surface = cb.surface;
+    surface->use = GX2_SURFACE_USE_TEXTURE;
+    surface->tileMode = GX2_TILE_MODE_LINEAR_ALIGNED;
+    surface->image = nullptr;
+    GX2CalcSurfaceSizeAndAlignment(surface);
+}
+#endif
+
 Gfx::Gfx()
 {
     inForeground = false;
     displaysEnabled = false;
 
     currentShader = SHADER_INVALID;
+    currentBlendMode = BLEND_ALPHA;
+    alphaTestEnabled = false;
+    alphaTestRef = 0.0f;
+
+    bloomEnabled = true;
+    emissiveUsed = false;
+
+    memset(&frameStats, 0, sizeof(frameStats));
+    memset(&pendingStats, 0, sizeof(pendingStats));
+    lastSwapEnd = 0;
+    lastFlipTime = 0;
+
+    overdrawEnabled = false;
+    memset(overdrawReadbacks, 0, sizeof(overdrawReadbacks));
+
+#ifdef DIAGNOSTICS
+    captureRequested = false;
+    captureCount = 0;
+#endif
 
     modelMatrix = glm::mat4(1.0f);
     viewMatrix = glm::mat4(1.0f);
@@ -69,34 +150,16 @@ int Gfx::OnForegroundAcquired()
 {
     inForeground = true;
 
-    MEMHeapHandle fgHeap = MEMGetBaseHeapHandle(MEM_BASE_HEAP_FG);
-    MEMHeapHandle mem1Heap = MEMGetBaseHeapHandle(MEM_BASE_HEAP_MEM1);
-
-    // Allocate tv scan buffer
-    tvScanBuffer = MEMAllocFromFrmHeapEx(fgHeap, tvScanBufferSize, GX2_SCAN_BUFFER_ALIGNMENT);
-    if (!tvScanBuffer) {
+    // Allocate scan, color and bloom buffers, restoring preserved resources
+    if (!foregroundMgr.Acquire()) {
         return -1;
     }
-    GX2Invalidate(GX2_INVALIDATE_MODE_CPU, tvScanBuffer, tvScanBufferSize);
-    GX2SetTVBuffer(tvScanBuffer, tvScanBufferSize, tvRenderMode, GX2_SURFACE_FORMAT_UNORM_R8_G8_B8_A8, GX2_BUFFERING_MODE_DOUBLE);
 
-    // Allocate drc scan buffer
-    drcScanBuffer = MEMAllocFromFrmHeapEx(fgHeap, drcScanBufferSize, GX2_SCAN_BUFFER_ALIGNMENT);
-    if (!drcScanBuffer) {
-        return -1;
-    }
-    GX2Invalidate(GX2_INVALIDATE_MODE_CPU, drcScanBuffer, drcScanBufferSize);
+    GX2SetTVBuffer(tvScanBuffer, tvScanBufferSize, tvRenderMode, GX2_SURFACE_FORMAT_UNORM_R8_G8_B8_A8, GX2_BUFFERING_MODE_DOUBLE);
     GX2SetDRCBuffer(drcScanBuffer, drcScanBufferSize, drcRenderMode, GX2_SURFACE_FORMAT_UNORM_R8_G8_B8_A8, GX2_BUFFERING_MODE_DOUBLE);
 
-    // Allocate colorbuffers
-    for (int i = 0; i < NUM_TARGETS; ++i) {
-        GX2ColorBuffer& cb = colorBuffers[i];
-        cb.surface.image = MEMAllocFromFrmHeapEx(mem1Heap, cb.surface.imageSize, cb.surface.alignment);
-        if (!cb.surface.image) {
-            return -1;
-        }
-
-        GX2Invalidate(GX2_INVALIDATE_MODE_CPU | GX2_INVALIDATE_MODE_COLOR_BUFFER, cb.surface.image, cb.surface.imageSize);
+    for (int i = 0; i < 2; ++i) {
+        bloomTextures[i].texture.surface.image = bloomBuffers[i].surface.image;
     }
 
     return 0;
@@ -104,12 +167,8 @@ int Gfx::OnForegroundAcquired()
 
 int Gfx::OnForegroundReleased()
 {
-    MEMHeapHandle fgHeap = MEMGetBaseHeapHandle(MEM_BASE_HEAP_FG);
-    MEMHeapHandle mem1Heap = MEMGetBaseHeapHandle(MEM_BASE_HEAP_MEM1);
-
     // Free all foreground allocations
-    MEMFreeToFrmHeap(fgHeap, MEM_FRM_HEAP_FREE_ALL);
-    MEMFreeToFrmHeap(mem1Heap, MEM_FRM_HEAP_FREE_ALL);
+    foregroundMgr.Release();
 
     inForeground = false;
 
@@ -166,6 +225,44 @@ bool Gfx::Initialize()
     InitColorBuffer(colorBuffers[TARGET_DRC0], drcSize, GX2_SURFACE_FORMAT_UNORM_R8_G8_B8_A8);
     InitColorBuffer(colorBuffers[TARGET_DRC1], drcSize, GX2_SURFACE_FORMAT_UNORM_R8_G8_B8_A8);
 
+    // Bloom buffers are half the size of the largest target
+    glm::uvec2 bloomSize = glm::max(tvSize, drcSize) / 2u;
+    for (int i = 0; i < 2; ++i) {
+        InitColorBuffer(bloomBuffers[i], bloomSize, GX2_SURFACE_FORMAT_UNORM_R8_G8_B8_A8);
+        InitColorBufferTexture(bloomTextures[i].texture, bloomBuffers[i]);
+        GX2InitSampler(&bloomTextures[i].sampler, GX2_TEX_CLAMP_MODE_CLAMP, GX2_TEX_XY_FILTER_MODE_LINEAR);
+    }
+
+    for (int clamp = 0; clamp < 2; ++clamp) {
+        for (int linear = 0; linear < 2; ++linear) {
+            GX2InitSampler(&samplers[clamp][linear],
+                clamp ? GX2_TEX_CLAMP_MODE_CLAMP : GX2_TEX_CLAMP_MODE_WRAP,
+                linear ? GX2_TEX_XY_FILTER_MODE_LINEAR : GX2_TEX_XY_FILTER_MODE_POINT);
+        }
+    }
+
+    // Scan buffers live in the foreground bucket
+    if (!foregroundMgr.Add(&tvScanBuffer, tvScanBufferSize, GX2_SCAN_BUFFER_ALIGNMENT, ForegroundMgr::HEAP_FG, GX2_INVALIDATE_MODE_CPU, false) ||
+        !foregroundMgr.Add(&drcScanBuffer, drcScanBufferSize, GX2_SCAN_BUFFER_ALIGNMENT, ForegroundMgr::HEAP_FG, GX2_INVALIDATE_MODE_CPU, false)) {
+        return false;
+    }
+
+    // Color and bloom buffers are redrawn every frame, so they aren't preserved
+    for (int i = 0; i < NUM_TARGETS; ++i) {
+        GX2Surface& surface = colorBuffers[i].surface;
+        if (!foregroundMgr.Add(&surface.image, surface.imageSize, surface.alignment, ForegroundMgr::HEAP_MEM1,
+            GX2_INVALIDATE_MODE_CPU | GX2_INVALIDATE_MODE_COLOR_BUFFER, false)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < 2; ++i) {
+        GX2Surface& surface = bloomBuffers[i].surface;
+        if (!foregroundMgr.Add(&surface.image, surface.imageSize, surface.alignment, ForegroundMgr::HEAP_MEM1,
+            GX2_INVALIDATE_MODE_CPU | GX2_INVALIDATE_MODE_COLOR_BUFFER, false)) {
+            return false;
+        }
+    }
+
     // Register callbacks for foreground allocations
     ProcUIRegisterCallback(PROCUI_CALLBACK_ACQUIRE, ProcUiAcquired, this, 100);
     ProcUIRegisterCallback(PROCUI_CALLBACK_RELEASE, ProcUiReleased, this, 100);
@@ -195,19 +292,31 @@ bool Gfx::Initialize()
     GX2SetColorControl(GX2_LOGIC_OP_COPY, 0xFF, FALSE, TRUE);
 
     // Setup blend control
-    GX2SetBlendControl(GX2_RENDER_TARGET_0,
-        GX2_BLEND_MODE_SRC_ALPHA,
-        GX2_BLEND_MODE_INV_SRC_ALPHA,
-        GX2_BLEND_COMBINE_MODE_ADD,
-        TRUE,
-        GX2_BLEND_MODE_SRC_ALPHA,
-        GX2_BLEND_MODE_INV_SRC_ALPHA,
-        GX2_BLEND_COMBINE_MODE_ADD);
+    currentBlendMode = NUM_BLEND_MODES;
+    SetBlendMode(BLEND_ALPHA);
 
     // Set 60fps VSync
     GX2SetSwapInterval(1);
 
+    // Allocate transient memory for dynamic geometry
+    if (!transientBuffer.Initialize(TRANSIENT_BUFFER_SIZE)) {
+        return false;
+    }
+
+    // Allocate GPU timestamp memory
+    if (!gpuTimer.Initialize()) {
+        return false;
+    }
+
+#ifdef DIAGNOSTICS
+    // Start the capture worker
+    if (!frameCapture.Initialize()) {
+        return false;
+    }
+#endif
+
     // Load and initialize shaders
+    BootProfiler::Begin("Load shaders");
     WHBGfxShaderGroup* colorShader = &shaderGroups[SHADER_COLOR];
     WHBGfxLoadGFDShaderGroup(colorShader, 0, colorShader_gsh);
     WHBGfxInitShaderAttribute(colorShader, "aPosition", 0, 0, GX2_ATTRIB_FORMAT_FLOAT_32_32);
@@ -218,6 +327,7 @@ bool Gfx::Initialize()
     WHBGfxInitShaderAttribute(textureShader, "aPosition", 0, 0, GX2_ATTRIB_FORMAT_FLOAT_32_32);
     WHBGfxInitShaderAttribute(textureShader, "aTexCoord", 0, 8, GX2_ATTRIB_FORMAT_FLOAT_32_32);
     WHBGfxInitFetchShader(textureShader);
+    BootProfiler::End();
 
     // Initialize projection
     projectionMatrix = glm::ortho(0.0f, screenSpace.x, screenSpace.y, 0.0f, -1.0f, 1.0f);
@@ -243,6 +353,17 @@ void Gfx::Finalize()
     free(commandBufferPool);
     commandBufferPool = nullptr;
 
+    transientBuffer.Finalize();
+    gpuTimer.Finalize();
+#ifdef DIAGNOSTICS
+    frameCapture.Finalize();
+#endif
+
+    for (OverdrawReadback& rb : overdrawReadbacks) {
+        free(rb.surface.image);
+        rb.surface.image = nullptr;
+    }
+
     WHBGfxFreeShaderGroup(&shaderGroups[SHADER_COLOR]);
     WHBGfxFreeShaderGroup(&shaderGroups[SHADER_TEXTURE]);
 }
@@ -259,6 +380,66 @@ void Gfx::SetView(glm::mat4& view)
     matrixUpdated = true;
 }
 
+void Gfx::SetBlendMode(BlendMode mode)
+{
+    // Overdraw counting needs every fragment to add up
+    if (overdrawEnabled) {
+        mode = BLEND_ADDITIVE_PREMULTIPLIED;
+    }
+
+    // Avoid redundant state changes
+    if (currentBlendMode == mode) {
+        return;
+    }
+
+    static const struct {
+        GX2BlendMode src;
+        GX2BlendMode dst;
+    } blendModes[] = {
+        // BLEND_ALPHA
+        { GX2_BLEND_MODE_SRC_ALPHA, GX2_BLEND_MODE_INV_SRC_ALPHA },
+        // BLEND_PREMULTIPLIED
+        { GX2_BLEND_MODE_ONE, GX2_BLEND_MODE_INV_SRC_ALPHA },
+        // BLEND_ADDITIVE
+        { GX2_BLEND_MODE_SRC_ALPHA, GX2_BLEND_MODE_ONE },
+        // BLEND_ADDITIVE_PREMULTIPLIED
+        { GX2_BLEND_MODE_ONE, GX2_BLEND_MODE_ONE },
+        // BLEND_OPAQUE
+        { GX2_BLEND_MODE_ONE, GX2_BLEND_MODE_ZERO },
+    };
+
+    GX2SetBlendControl(GX2_RENDER_TARGET_0,
+        blendModes[mode].src,
+        blendModes[mode].dst,
+        GX2_BLEND_COMBINE_MODE_ADD,
+        TRUE,
+        blendModes[mode].src,
+        blendModes[mode].dst,
+        GX2_BLEND_COMBINE_MODE_ADD);
+
+    currentBlendMode = mode;
+    pendingStats.blendChanges++;
+}
+
+void Gfx::SetAlphaTest(bool enabled, float ref)
+{
+    // Overdraw counting needs every fragment
+    if (overdrawEnabled) {
+        enabled = false;
+    }
+
+    // Avoid redundant state changes
+    if (alphaTestEnabled == enabled && (!enabled || alphaTestRef == ref)) {
+        return;
+    }
+
+    GX2SetAlphaTest(enabled, GX2_COMPARE_FUNC_GEQUAL, ref);
+
+    alphaTestEnabled = enabled;
+    alphaTestRef = ref;
+    pendingStats.blendChanges++;
+}
+
 void Gfx::BeginDraw(Target target, glm::vec4 color)
 {
     currentTarget = target;
@@ -269,15 +450,32 @@ void Gfx::BeginDraw(Target target, glm::vec4 color)
     GX2SetViewport(0.0f, 0.0f, (float) cb->surface.width, (float) cb->surface.height, 0.0f, 1.0f);
     GX2SetScissor(0, 0, cb->surface.width, cb->surface.height);
 
+    // Overdraw counting starts from zero
+    if (overdrawEnabled) {
+        color = glm::vec4(0.0f);
+    }
+
     // Clear colorbuffer
     GX2ClearColor(cb, color.r, color.g, color.b, color.a);
     GX2SetContextState(contextState);
+
+    // Every target starts with regular alpha blending
+    SetBlendMode(BLEND_ALPHA);
+    SetAlphaTest(false);
+
+    gpuTimer.Sample(GPU_SAMPLE_TARGET_BEGIN(target));
 }
 
 void Gfx::EndDraw()
 {
     GX2ColorBuffer* cb = &colorBuffers[currentTarget];
 
+    // Composite the glow of emissive draws
+    if (emissiveUsed) {
+        ApplyBloom();
+        emissiveUsed = false;
+    }
+
     static const GX2ScanTarget scanTargets[] = {
         // TARGET_TV
         GX2_SCAN_TARGET_TV,
@@ -290,10 +488,292 @@ void Gfx::EndDraw()
     // Copy the target buffer to the scanbuffer
     GX2CopyColorBufferToScanBuffer(cb, scanTargets[currentTarget]);
     GX2SetContextState(contextState);
+
+    gpuTimer.Sample(GPU_SAMPLE_TARGET_END(currentTarget));
+
+    // Copy the overdraw counts into linear memory so the CPU can read them
+    OverdrawReadback& rb = overdrawReadbacks[currentTarget];
+    if (overdrawEnabled && rb.surface.image && !rb.pending) {
+        GX2CopySurface(&cb->surface, 0, 0, &rb.surface, 0, 0);
+        GX2SetContextState(contextState);
+        rb.fence = 0;
+        rb.pending = true;
+    }
+
+#ifdef DIAGNOSTICS
+    if (captureRequested) {
+        CaptureTarget();
+    }
+#endif
+}
+
+bool Gfx::BeginEmissive()
+{
+    if (!bloomEnabled || overdrawEnabled) {
+        return false;
+    }
+
+    GX2ColorBuffer* cb = &colorBuffers[currentTarget];
+    glm::uvec2 size = glm::uvec2(cb->surface.width, cb->surface.height) / 2u;
+
+    // Clear the shared emissive layer the first time it's used for this target
+    if (!emissiveUsed) {
+        GX2ClearColor(&bloomBuffers[0], 0.0f, 0.0f, 0.0f, 0.0f);
+        GX2SetContextState(contextState);
+        emissiveUsed = true;
+    }
+
+    SetRenderBuffer(&bloomBuffers[0], size);
+    return true;
+}
+
+void Gfx::EndEmissive()
+{
+    GX2ColorBuffer* cb = &colorBuffers[currentTarget];
+    SetRenderBuffer(cb, glm::uvec2(cb->surface.width, cb->surface.height));
+}
+
+void Gfx::SetBloomEnabled(bool enabled)
+{
+    bloomEnabled = enabled;
+}
+
+bool Gfx::SetOverdrawMode(bool enabled)
+{
+    if (overdrawEnabled == enabled) {
+        return true;
+    }
+
+    // Make sure the GPU is done with the readback surfaces before touching them
+    GX2DrawDone();
+
+    if (enabled) {
+        for (int i = 0; i < NUM_TARGETS; ++i) {
+            OverdrawReadback& rb = overdrawReadbacks[i];
+            rb.surface = colorBuffers[i].surface;
+            rb.surface.use = GX2_SURFACE_USE_TEXTURE;
+            rb.surface.tileMode = GX2_TILE_MODE_LINEAR_ALIGNED;
+            rb.surface.image = nullptr;
+            GX2CalcSurfaceSizeAndAlignment(&rb.surface);
+
+            rb.surface.image = memalign(rb.surface.alignment, rb.surface.imageSize);
+            rb.pending = false;
+            if (!rb.surface.image) {
+                enabled = false;
+                break;
+            }
+        }
+    }
+
+    if (!enabled) {
+        for (OverdrawReadback& rb : overdrawReadbacks) {
+            free(rb.surface.image);
+            rb.surface.image = nullptr;
+            rb.pending = false;
+        }
+
+        if (!overdrawEnabled) {
+            // Allocating the readback surfaces failed
+            return false;
+        }
+    }
+
+    overdrawEnabled = enabled;
+
+    // Force the blend state to be reapplied
+    currentBlendMode = NUM_BLEND_MODES;
+    SetBlendMode(BLEND_ALPHA);
+
+    return true;
+}
+
+bool Gfx::IsOverdrawMode() const
+{
+    return overdrawEnabled;
+}
+
+void Gfx::ResolveOverdraw()
+{
+    uint64_t retired = GX2GetRetiredTimeStamp();
+
+    for (int i = 0; i < NUM_TARGETS; ++i) {
+        OverdrawReadback& rb = overdrawReadbacks[i];
+        if (!rb.pending || !rb.fence || rb.fence > retired) {
+            continue;
+        }
+
+        // The copy was written by the GPU
+        DCInvalidateRange(rb.surface.image, rb.surface.imageSize);
+
+        // The count of every pixel is in the alpha channel
+        const uint8_t* pixels = (const uint8_t*) rb.surface.image;
+        uint64_t sum = 0;
+        uint32_t max = 0;
+        for (uint32_t y = 0; y < rb.surface.height; ++y) {
+            const uint8_t* row = pixels + (y * rb.surface.pitch * 4);
+            for (uint32_t x = 0; x < rb.surface.width; ++x) {
+                uint32_t count = row[x * 4 + 3];
+                sum += count;
+                if (count > max) {
+                    max = count;
+                }
+            }
+        }
+
+        frameStats.overdrawAverage[i] = (float) sum / (rb.surface.width * rb.surface.height);
+        frameStats.overdrawMax[i] = max;
+        rb.pending = false;
+    }
+}
+
+#ifdef DIAGNOSTICS
+bool Gfx::RequestCapture(const char* prefix)
+{
+    // Only one capture per frame
+    if (captureRequested) {
+        return false;
+    }
+
+    // Buffers for the linear copy of every target
+    uint32_t sizes[NUM_TARGETS];
+    uint32_t align = 0;
+    for (int i = 0; i < NUM_TARGETS; ++i) {
+        GX2Surface surface;
+        InitCaptureSurface(&surface, colorBuffers[i]);
+        sizes[i] = surface.imageSize;
+        align = std::max(align, surface.alignment);
+    }
+    if (!frameCapture.AllocateBuffers(sizes, NUM_TARGETS, align)) {
+        return false;
+    }
+
+    capturePrefix = prefix;
+    captureRequested = true;
+    captureCount++;
+    return true;
+}
+
+FrameCapture::Stats Gfx::GetCaptureStats() const
+{
+    return frameCapture.GetStats();
+}
+#endif
+
+ForegroundMgr& Gfx::GetForegroundMgr()
+{
+    return foregroundMgr;
+}
+
+OSTime Gfx::GetLastFlipTime() const
+{
+    return lastFlipTime;
+}
+
+#ifdef DIAGNOSTICS
+void Gfx::CaptureTarget()
+{
+    GX2ColorBuffer* cb = &colorBuffers[currentTarget];
+
+    GX2Surface surface;
+    InitCaptureSurface(&surface, *cb);
+
+    // Drop the capture if the worker is still busy with older ones
+    FrameCapture::Buffer* buffer = frameCapture.Acquire(surface.imageSize);
+    if (!buffer) {
+        return;
+    }
+
+    // Drop stale lines of the last capture so they can't be written back over the copy
+    surface.image = buffer->pixels;
+    DCInvalidateRange(surface.image, surface.imageSize);
+    GX2CopySurface(&cb->surface, 0, 0, &surface, 0, 0);
+    GX2SetContextState(contextState);
+
+    buffer->size = glm::uvec2(surface.width, surface.height);
+    buffer->pitch = surface.pitch;
+    snprintf(buffer->path, sizeof(buffer->path), "%s_%04u_%s.png", capturePrefix.c_str(), captureCount, captureTargetNames[currentTarget]);
+    frameCapture.Submit(buffer);
+}
+#endif
+
+void Gfx::SetRenderBuffer(GX2ColorBuffer* cb, glm::uvec2 size)
+{
+    GX2SetColorBuffer(cb, GX2_RENDER_TARGET_0);
+    GX2SetViewport(0.0f, 0.0f, (float) size.x, (float) size.y, 0.0f, 1.0f);
+    GX2SetScissor(0, 0, size.x, size.y);
+}
+
+void Gfx::DrawFullscreen(Texture* tex, glm::vec2 uvOffset, glm::vec2 uvScale, glm::vec4 color)
+{
+    // Keep the matrices of the caller
+    glm::mat4 oldModel = modelMatrix;
+    glm::mat4 oldView = viewMatrix;
+
+    glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(screenSpace, 1.0f));
+    glm::mat4 view = glm::mat4(1.0f);
+    SetModel(model);
+    SetView(view);
+
+    tex->SetUVOffset(uvOffset);
+    tex->SetUVScale(uvScale);
+    Draw(tex, fullscreenVertices, 6, color);
+
+    SetModel(oldModel);
+    SetView(oldView);
 }
 
-void Gfx::Draw(Texture* tex, const void* vertices, uint32_t numVertices, glm::vec4 color, bool quads)
+void Gfx::ApplyBloom()
 {
+    GX2ColorBuffer* cb = &colorBuffers[currentTarget];
+    glm::uvec2 targetSize = glm::uvec2(cb->surface.width, cb->surface.height);
+    glm::uvec2 size = targetSize / 2u;
+
+    // Only the top left part of the shared buffers is used by smaller targets
+    glm::vec2 uvScale = glm::vec2(size) / glm::vec2(bloomBuffers[0].surface.width, bloomBuffers[0].surface.height);
+    glm::vec2 texelSize = glm::vec2(1.0f) / glm::vec2(size);
+
+    // Separable blur, horizontal from buffer 0 into 1 then vertical back into 0
+    for (int pass = 0; pass < 2; ++pass) {
+        GX2ColorBuffer* src = &bloomBuffers[pass];
+        GX2ColorBuffer* dst = &bloomBuffers[!pass];
+        glm::vec2 direction = pass == 0 ? glm::vec2(texelSize.x, 0.0f) : glm::vec2(0.0f, texelSize.y);
+
+        // Make the rendered data visible to the texture unit
+        GX2Invalidate(GX2_INVALIDATE_MODE_COLOR_BUFFER | GX2_INVALIDATE_MODE_TEXTURE, src->surface.image, src->surface.imageSize);
+
+        GX2ClearColor(dst, 0.0f, 0.0f, 0.0f, 0.0f);
+        GX2SetContextState(contextState);
+        SetRenderBuffer(dst, size);
+        SetBlendMode(BLEND_ADDITIVE_PREMULTIPLIED);
+
+        for (size_t i = 0; i < COUNTOF(bloomTapOffsets); ++i) {
+            glm::vec4 weight = glm::vec4(bloomTapWeights[i]);
+            DrawFullscreen(&bloomTextures[pass], direction * bloomTapOffsets[i], uvScale, weight);
+            if (i != 0) {
+                DrawFullscreen(&bloomTextures[pass], direction * -bloomTapOffsets[i], uvScale, weight);
+            }
+        }
+    }
+
+    GX2Invalidate(GX2_INVALIDATE_MODE_COLOR_BUFFER | GX2_INVALIDATE_MODE_TEXTURE, bloomBuffers[0].surface.image, bloomBuffers[0].surface.imageSize);
+
+    // Composite the blurred layer onto the target
+    SetRenderBuffer(cb, targetSize);
+    DrawFullscreen(&bloomTextures[0], glm::vec2(0.0f), uvScale, glm::vec4(BLOOM_INTENSITY));
+    SetBlendMode(BLEND_ALPHA);
+}
+
+void Gfx::Draw(Texture* tex, const void* vertices, uint32_t numVertices, glm::vec4 color, bool quads, const SamplerState* sampler)
+{
+    // Vertex layout of the caller, position is always first
+    const uint32_t stride = tex ? 16 : 8;
+
+    // Only count the covered fragments while visualizing overdraw
+    if (overdrawEnabled) {
+        tex = nullptr;
+        color = overdrawColor;
+    }
+
     // Set wanted shader
     Shader shader = tex ? SHADER_TEXTURE : SHADER_COLOR;
     WHBGfxShaderGroup* shaderGroup = &shaderGroups[shader];
@@ -304,6 +784,7 @@ void Gfx::Draw(Texture* tex, const void* vertices, uint32_t numVertices, glm::ve
         GX2SetPixelShader(shaderGroup->pixelShader);
         currentShader = shader;
         shaderUpdated = true;
+        pendingStats.shaderChanges++;
     }
 
     if (matrixUpdated || shaderUpdated) {
@@ -319,26 +800,56 @@ void Gfx::Draw(Texture* tex, const void* vertices, uint32_t numVertices, glm::ve
     if (tex) {
         uint32_t location = shaderGroup->pixelShader->samplerVars[0].location;
         GX2SetPixelTexture(&tex->texture, location);
-        GX2SetPixelSampler(&tex->sampler, location);
 
-        GX2SetPixelUniformReg(shaderGroup->pixelShader->uniformVars[1].offset, 4, tex->texCoordParams);
+        if (sampler) {
+            float texCoordParams[4] = { sampler->uvOffset.x, sampler->uvOffset.y, sampler->uvScale.x, sampler->uvScale.y };
+            GX2SetPixelSampler(&samplers[sampler->clamp][sampler->linearFilter], location);
+            GX2SetPixelUniformReg(shaderGroup->pixelShader->uniformVars[1].offset, 4, texCoordParams);
+        } else {
+            GX2SetPixelSampler(&tex->sampler, location);
+            GX2SetPixelUniformReg(shaderGroup->pixelShader->uniformVars[1].offset, 4, tex->texCoordParams);
+        }
     }
 
     // Draw
-    const uint32_t stride = tex ? 16 : 8;
+    if (transientBuffer.Contains(vertices)) {
+        // Flush CPU writes to dynamic vertices
+        GX2Invalidate(GX2_INVALIDATE_MODE_CPU_ATTRIBUTE_BUFFER, (void*) vertices, stride * numVertices);
+    }
     GX2SetAttribBuffer(0, stride * numVertices, stride, vertices);
     GX2DrawEx(quads ? GX2_PRIMITIVE_MODE_QUADS : GX2_PRIMITIVE_MODE_TRIANGLES, numVertices, 0, 1);
+
+    pendingStats.drawCalls[currentTarget]++;
+    pendingStats.vertices[currentTarget] += numVertices;
 }
 
 void Gfx::SwapBuffers(void)
 {
+    OSTime swapStart = OSGetTime();
+
     // Swap scan buffers
     GX2SwapScanBuffers();
     GX2SetContextState(contextState);
+    gpuTimer.Sample(GPU_SAMPLE_SWAP);
 
     // Flush all packets to the GPU
     GX2Flush();
 
+    // Transient memory of this frame can be reused once the GPU is done with it
+    transientBuffer.EndFrame(GX2GetLastSubmittedTimeStamp());
+    gpuTimer.EndFrame(GX2GetLastSubmittedTimeStamp());
+#ifdef DIAGNOSTICS
+    frameCapture.EndFrame(GX2GetLastSubmittedTimeStamp());
+    captureRequested = false;
+#endif
+
+    // Overdraw copies of this frame are ready with its last command buffer
+    for (OverdrawReadback& rb : overdrawReadbacks) {
+        if (rb.pending && !rb.fence) {
+            rb.fence = GX2GetLastSubmittedTimeStamp();
+        }
+    }
+
     // Enable TV and DRC on first frame rendered
     if (!displaysEnabled) {
         GX2SetTVEnable(TRUE);
@@ -365,6 +876,102 @@ void Gfx::SwapBuffers(void)
         waitCount++;
         GX2WaitForVsync();
     }
+    lastFlipTime = lastFlip;
+
+    // Finish the resume measurement once the first frame is on screen
+    foregroundMgr.OnFramePresented();
+
+    // Release transient memory of retired frames
+    transientBuffer.Reclaim();
+
+#ifdef DIAGNOSTICS
+    // Encode captures of retired frames
+    frameCapture.Dispatch();
+#endif
+
+    // Publish the counters of this frame
+    OSTime swapEnd = OSGetTime();
+    for (int i = 0; i < NUM_TARGETS; ++i) {
+        frameStats.drawCalls[i] = pendingStats.drawCalls[i];
+        frameStats.vertices[i] = pendingStats.vertices[i];
+    }
+    frameStats.shaderChanges = pendingStats.shaderChanges;
+    frameStats.blendChanges = pendingStats.blendChanges;
+    frameStats.cpuFrameMs = lastSwapEnd ? OSTicksToMicroseconds(swapStart - lastSwapEnd) / 1000.0f : 0.0f;
+    frameStats.swapWaitMs = OSTicksToMicroseconds(swapEnd - swapStart) / 1000.0f;
+    memset(&pendingStats, 0, sizeof(pendingStats));
+    lastSwapEnd = swapEnd;
+
+    // Pick up GPU timings of older frames which are done by now
+    ResolveGpuTimings();
+
+    if (overdrawEnabled) {
+        ResolveOverdraw();
+    }
+}
+
+void Gfx::ResolveGpuTimings()
+{
+    uint64_t samples[GpuTimer::MAX_SAMPLES];
+    uint32_t validMask;
+    if (!gpuTimer.Resolve(samples, &validMask)) {
+        return;
+    }
+
+    uint64_t frameStart = 0;
+    for (int i = 0; i < NUM_TARGETS; ++i) {
+        uint32_t targetMask = (1u << GPU_SAMPLE_TARGET_BEGIN(i)) | (1u << GPU_SAMPLE_TARGET_END(i));
+        if ((validMask & targetMask) != targetMask) {
+            // Target wasn't drawn this frame
+            frameStats.targetGpuMs[i] = 0.0f;
+            continue;
+        }
+
+        uint64_t begin = samples[GPU_SAMPLE_TARGET_BEGIN(i)];
+        frameStats.targetGpuMs[i] = GpuTimer::CyclesToMilliseconds(samples[GPU_SAMPLE_TARGET_END(i)] - begin);
+        if (!frameStart || begin < frameStart) {
+            frameStart = begin;
+        }
+    }
+
+    if (frameStart && (validMask & (1u << GPU_SAMPLE_SWAP))) {
+        frameStats.gpuFrameMs = GpuTimer::CyclesToMilliseconds(samples[GPU_SAMPLE_SWAP] - frameStart);
+    }
+}
+
+void* Gfx::AllocTransient(uint32_t size, uint32_t align)
+{
+    return transientBuffer.Alloc(size, align);
+}
+
+RingBuffer::Stats const& Gfx::GetTransientStats() const
+{
+    return transientBuffer.GetStats();
+}
+
+Gfx::FrameStats const& Gfx::GetFrameStats() const
+{
+    return frameStats;
+}
+
+// Linear RGBA8 surface with its size and alignment calculated
+static void InitTextureSurface(GX2Texture* texture, glm::uvec2 size)
+{
+    texture->surface.use = GX2_SURFACE_USE_TEXTURE;
+    texture->surface.dim = GX2_SURFACE_DIM_TEXTURE_2D;
+    texture->surface.width = size.x;
+    texture->surface.height = size.y;
+    texture->surface.depth = 1;
+    texture->surface.mipLevels = 1;
+    texture->surface.format = GX2_SURFACE_FORMAT_UNORM_R8_G8_B8_A8;
+    texture->surface.aa = GX2_AA_MODE1X;
+    texture->surface.tileMode = GX2_TILE_MODE_LINEAR_ALIGNED;
+    texture->viewFirstMip = 0;
+    texture->viewNumMips = 1;
+    texture->viewFirstSlice = 0;
+    texture->viewNumSlices = 1;
+    texture->compMap = GX2_COMP_MAP(GX2_SQ_SEL_R, GX2_SQ_SEL_G, GX2_SQ_SEL_B, GX2_SQ_SEL_A);
+    GX2CalcSurfaceSizeAndAlignment(&texture->surface);
 }
 
 Gfx::Texture* Gfx::NewTexture(glm::uvec2 size, void* rgba, bool clamp, bool linearFilter)
@@ -376,21 +983,7 @@ Gfx::Texture* Gfx::NewTexture(glm::uvec2 size, void* rgba, bool clamp, bool line
     }
 
     // Initialize texture
-    tex->texture.surface.use = GX2_SURFACE_USE_TEXTURE;
-    tex->texture.surface.dim = GX2_SURFACE_DIM_TEXTURE_2D;
-    tex->texture.surface.width = size.x;
-    tex->texture.surface.height = size.y;
-    tex->texture.surface.depth = 1;
-    tex->texture.surface.mipLevels = 1;
-    tex->texture.surface.format = GX2_SURFACE_FORMAT_UNORM_R8_G8_B8_A8;
-    tex->texture.surface.aa = GX2_AA_MODE1X;
-    tex->texture.surface.tileMode = GX2_TILE_MODE_LINEAR_ALIGNED;
-    tex->texture.viewFirstMip = 0;
-    tex->texture.viewNumMips = 1;
-    tex->texture.viewFirstSlice = 0;
-    tex->texture.viewNumSlices = 1;
-    tex->texture.compMap = GX2_COMP_MAP(GX2_SQ_SEL_R, GX2_SQ_SEL_G, GX2_SQ_SEL_B, GX2_SQ_SEL_A);
-    GX2CalcSurfaceSizeAndAlignment(&tex->texture.surface);
+    InitTextureSurface(&tex->texture, size);
     GX2InitTextureRegs(&tex->texture);
 
     // Allocate texture surface
@@ -419,10 +1012,100 @@ Gfx::Texture* Gfx::NewTexture(glm::uvec2 size, void* rgba, bool clamp, bool line
     tex->texCoordParams[1] = 0.0f;
     tex->texCoordParams[2] = 1.0f;
     tex->texCoordParams[3] = 1.0f;
+    tex->wrapped = false;
+    tex->foregroundMgr = nullptr;
+
+    return tex;
+}
+
+Gfx::Texture* Gfx::NewPreservedTexture(glm::uvec2 size, bool clamp, bool linearFilter)
+{
+    Texture* tex = new Texture();
+    if (!tex) {
+        return nullptr;
+    }
+
+    InitTextureSurface(&tex->texture, size);
+    GX2InitTextureRegs(&tex->texture);
+
+    // The image is allocated from MEM1 on every acquire and copied through MEM2 while in background
+    GX2Surface& surface = tex->texture.surface;
+    if (!foregroundMgr.Add(&surface.image, surface.imageSize, surface.alignment, ForegroundMgr::HEAP_MEM1,
+        GX2_INVALIDATE_MODE_TEXTURE, true)) {
+        delete tex;
+        return nullptr;
+    }
+
+    // Clear and invalidate texture
+    if (surface.image) {
+        memset(surface.image, 0, surface.imageSize);
+        GX2Invalidate(GX2_INVALIDATE_MODE_CPU_TEXTURE, surface.image, surface.imageSize);
+    }
+
+    GX2InitSampler(&tex->sampler,
+        clamp ? GX2_TEX_CLAMP_MODE_CLAMP : GX2_TEX_CLAMP_MODE_WRAP,
+        linearFilter ? GX2_TEX_XY_FILTER_MODE_LINEAR : GX2_TEX_XY_FILTER_MODE_POINT);
+
+    // No offset by default, 1x scaling
+    tex->texCoordParams[0] = 0.0f;
+    tex->texCoordParams[1] = 0.0f;
+    tex->texCoordParams[2] = 1.0f;
+    tex->texCoordParams[3] = 1.0f;
+    tex->wrapped = false;
+    tex->foregroundMgr = &foregroundMgr;
 
     return tex;
 }
 
+Gfx::Texture* Gfx::WrapTexture(glm::uvec2 size, uint32_t pitch, void* image, uint32_t imageSize)
+{
+    Texture* tex = new Texture();
+    if (!tex) {
+        return nullptr;
+    }
+
+    // The image has to be laid out exactly like GX2 expects it
+    InitTextureSurface(&tex->texture, size);
+    GX2Surface& surface = tex->texture.surface;
+    if (surface.pitch != pitch || surface.imageSize > imageSize || ((uintptr_t) image & (surface.alignment - 1)) != 0) {
+        delete tex;
+        return nullptr;
+    }
+
+    surface.image = image;
+    GX2InitTextureRegs(&tex->texture);
+
+    // Make sure the GPU doesn't read stale data, this only flushes the CPU cache
+    GX2Invalidate(GX2_INVALIDATE_MODE_CPU_TEXTURE, surface.image, surface.imageSize);
+
+    GX2InitSampler(&tex->sampler, GX2_TEX_CLAMP_MODE_WRAP, GX2_TEX_XY_FILTER_MODE_LINEAR);
+
+    // No offset by default, 1x scaling
+    tex->texCoordParams[0] = 0.0f;
+    tex->texCoordParams[1] = 0.0f;
+    tex->texCoordParams[2] = 1.0f;
+    tex->texCoordParams[3] = 1.0f;
+    tex->wrapped = true;
+    tex->foregroundMgr = nullptr;
+
+    return tex;
+}
+
+void* Gfx::AllocVertices(uint32_t size)
+{
+    return memalign(GX2_VERTEX_BUFFER_ALIGNMENT, size);
+}
+
+void Gfx::FlushVertices(void* vertices, uint32_t size)
+{
+    GX2Invalidate(GX2_INVALIDATE_MODE_CPU_ATTRIBUTE_BUFFER, vertices, size);
+}
+
+void Gfx::FreeVertices(void* vertices)
+{
+    free(vertices);
+}
+
 void Gfx::Texture::Update(void* rgba)
 {
     uint32_t pitch = GetPitch();
@@ -483,9 +1166,20 @@ void Gfx::Texture::Unlock()
     GX2Invalidate(GX2_INVALIDATE_MODE_CPU_TEXTURE, texture.surface.image, texture.surface.imageSize);
 }
 
+void Gfx::Texture::Unlock(uint32_t firstRow, uint32_t numRows)
+{
+    // Rows of linear textures are contiguous
+    uint32_t rowSize = texture.surface.pitch * 4;
+    GX2Invalidate(GX2_INVALIDATE_MODE_CPU_TEXTURE, (uint8_t*) texture.surface.image + firstRow * rowSize, numRows * rowSize);
+}
+
 void Gfx::Texture::Delete()
 {
     // Free surface data and delete the texture
-    free(texture.surface.image);
+    if (foregroundMgr) {
+        foregroundMgr->Remove(&texture.surface.image);
+    } else if (!wrapped) {
+        free(texture.surface.image);
+    }
     delete this;
 }
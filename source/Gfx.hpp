@@ -1,11 +1,24 @@
 #pragma once
 
 #include "Utils.hpp"
+#include "RingBuffer.hpp"
+#include "GpuTimer.hpp"
+#include "FrameCapture.hpp"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <string>
+#include <vector>
+
+#ifdef GFX_SOFTWARE
+// The software backend has no GX2 headers, keep the alignment used for vertex data
+#define GX2_VERTEX_BUFFER_ALIGNMENT 0x40
+#else
+#include "ForegroundMgr.hpp"
 #include <whb/gfx.h>
 #include <gx2/context.h>
+#include <coreinit/time.h>
+#endif
 
 class Gfx {
 public:
@@ -17,11 +30,58 @@ public:
         NUM_TARGETS,
     };
 
+    enum BlendMode {
+        // Straight alpha, depends on draw order
+        BLEND_ALPHA,
+        // Color is already multiplied by alpha
+        BLEND_PREMULTIPLIED,
+        // Order independent, used for glowing effects
+        BLEND_ADDITIVE,
+        // Adds premultiplied color, used to accumulate post processing passes
+        BLEND_ADDITIVE_PREMULTIPLIED,
+        // Overwrites the target, used together with the alpha test
+        BLEND_OPAQUE,
+
+        NUM_BLEND_MODES,
+    };
+
+    struct FrameStats {
+        // GPU time spent on each target, these lag a few frames behind
+        float targetGpuMs[NUM_TARGETS];
+        // GPU time from the first target until the swap was processed
+        float gpuFrameMs;
+        // CPU time between the end of the previous and the start of the current SwapBuffers
+        float cpuFrameMs;
+        // Time spent waiting for the flip
+        float swapWaitMs;
+
+        uint32_t drawCalls[NUM_TARGETS];
+        uint32_t vertices[NUM_TARGETS];
+        uint32_t shaderChanges;
+        uint32_t blendChanges;
+
+        // Fragments per pixel, only updated while the overdraw mode is enabled
+        float overdrawAverage[NUM_TARGETS];
+        uint32_t overdrawMax[NUM_TARGETS];
+    };
+
     struct Texture {
+#ifdef GFX_SOFTWARE
+        glm::uvec2 size;
+        uint32_t pitch;
+        uint8_t* image;
+        bool clamp;
+        bool linearFilter;
+#else
         GX2Texture texture;
         GX2Sampler sampler;
+        // Owns the image of textures from NewPreservedTexture
+        ForegroundMgr* foregroundMgr;
+#endif
         // xy: offset, zw: scale
         float texCoordParams[4];
+        // The image isn't owned by the texture, see WrapTexture
+        bool wrapped;
 
         uint32_t GetPitch();
 
@@ -41,6 +101,9 @@ public:
 
         void Unlock();
 
+        // Only make rows [firstRow, firstRow + numRows) visible to the GPU
+        void Unlock(uint32_t firstRow, uint32_t numRows);
+
         void Delete();
 
     private:
@@ -49,6 +112,14 @@ public:
         ~Texture() = default;
     };
 
+    // Sampling of a texture set per draw, so textures can be shared between sprites
+    struct SamplerState {
+        glm::vec2 uvOffset;
+        glm::vec2 uvScale;
+        bool clamp;
+        bool linearFilter;
+    };
+
     Gfx();
     virtual ~Gfx();
 
@@ -60,26 +131,105 @@ public:
 
     void SetView(glm::mat4& view);
 
+    void SetBlendMode(BlendMode mode);
+
+    // Discard fragments with an alpha below ref
+    void SetAlphaTest(bool enabled, float ref = 0.5f);
+
     void BeginDraw(Target target, glm::vec4 color = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
 
     void EndDraw();
 
-    void Draw(Texture* tex, const void* vertices, uint32_t numVertices, glm::vec4 color = glm::vec4(1.0f), bool quads = false);
+    // Redirect draws into the emissive layer of the current target, returns false if bloom is disabled
+    bool BeginEmissive();
+
+    void EndEmissive();
+
+    void SetBloomEnabled(bool enabled);
+
+    // Replace shading with a heatmap of how often each pixel is written
+    bool SetOverdrawMode(bool enabled);
+
+    bool IsOverdrawMode() const;
+
+    // The sampler state replaces the one of the texture if set
+    void Draw(Texture* tex, const void* vertices, uint32_t numVertices, glm::vec4 color = glm::vec4(1.0f), bool quads = false,
+        const SamplerState* sampler = nullptr);
 
     void SwapBuffers(void);
 
+    // Allocate GPU visible memory which is only valid until the end of the current frame
+    void* AllocTransient(uint32_t size, uint32_t align = GX2_VERTEX_BUFFER_ALIGNMENT);
+
+    RingBuffer::Stats const& GetTransientStats() const;
+
+    FrameStats const& GetFrameStats() const;
+
+#ifdef DIAGNOSTICS
+    // Write every target drawn until the next SwapBuffers to <prefix>_<number>_<target>.png in the background.
+    // The readback buffers are allocated on the first request.
+    bool RequestCapture(const char* prefix);
+
+    FrameCapture::Stats GetCaptureStats() const;
+#endif
+
     static Texture* NewTexture(glm::uvec2 size, void* rgba = nullptr, bool clamp = false, bool linearFilter = true);
 
+    // Empty texture in MEM1 which keeps its contents when the HOME Menu is opened, for textures which
+    // are expensive to fill again. The image is nullptr while in background.
+    Texture* NewPreservedTexture(glm::uvec2 size, bool clamp = false, bool linearFilter = true);
+
+    // Sample image in place, which has to be in the layout NewTexture uses and outlive the texture.
+    // Returns nullptr if the pitch, size or alignment of the image don't match.
+    static Texture* WrapTexture(glm::uvec2 size, uint32_t pitch, void* image, uint32_t imageSize);
+
+    // Allocate GPU visible vertex memory which stays valid until FreeVertices, call FlushVertices after writing it
+    static void* AllocVertices(uint32_t size);
+
+    static void FlushVertices(void* vertices, uint32_t size);
+
+    // The GPU must be done with the vertices, for example by freeing them after the frame was presented
+    static void FreeVertices(void* vertices);
+
+#ifdef GFX_SOFTWARE
+    // Write the last frame rendered to target as a PNG file
+    bool SaveTarget(Target target, const char* path);
+#else
+    // Add MEM1 resources which should survive the HOME Menu here, also reports the resume latency
+    ForegroundMgr& GetForegroundMgr();
+
+    // When the last frame was shown, 0 before the first one. Flips happen on a vsync, so the time
+    // between two frames is a multiple of the refresh interval.
+    OSTime GetLastFlipTime() const;
+#endif
+
     // virtual screen space used in projection
     static inline glm::vec2 screenSpace = glm::vec2(1280.0f, 720.0f);
 
 private:
+#ifdef GFX_SOFTWARE
+    class SoftRaster* raster;
+
+    glm::uvec2 targetSizes[NUM_TARGETS];
+    std::vector<uint8_t> targetPixels[NUM_TARGETS];
+
+    uint64_t frameCount;
+    int64_t lastSwapEndUs;
+    int64_t drawStartUs;
+#else
     static uint32_t ProcUiAcquired(void* arg);
     static uint32_t ProcUiReleased(void* arg);
     int OnForegroundAcquired();
     int OnForegroundReleased();
 
+    void SetRenderBuffer(GX2ColorBuffer* cb, glm::uvec2 size);
+    void DrawFullscreen(Texture* tex, glm::vec2 uvOffset, glm::vec2 uvScale, glm::vec4 color);
+    void ApplyBloom();
+    void ResolveGpuTimings();
+    void ResolveOverdraw();
+
     bool inForeground;
+    ForegroundMgr foregroundMgr;
     void* commandBufferPool;
 
     GX2TVRenderMode tvRenderMode;
@@ -94,16 +244,26 @@ private:
 
     GX2ColorBuffer colorBuffers[NUM_TARGETS];
 
+    // Half resolution ping-pong buffers for bloom, shared by all targets
+    GX2ColorBuffer bloomBuffers[2];
+    Texture bloomTextures[2];
+    bool emissiveUsed;
+
     GX2ContextState* contextState;
 
-    Target currentTarget;
+    GpuTimer gpuTimer;
+    OSTime lastSwapEnd;
+    OSTime lastFlipTime;
 
-    bool displaysEnabled;
+    // Linear copies of the overdraw counts which are read by the CPU
+    struct OverdrawReadback {
+        GX2Surface surface;
+        uint64_t fence;
+        bool pending;
+    };
+    OverdrawReadback overdrawReadbacks[NUM_TARGETS];
 
-    bool matrixUpdated;
-    glm::mat4 modelMatrix;
-    glm::mat4 viewMatrix;
-    glm::mat4 projectionMatrix;
+    bool displaysEnabled;
 
     enum Shader {
         SHADER_INVALID = -1,
@@ -116,4 +276,39 @@ private:
 
     WHBGfxShaderGroup shaderGroups[NUM_SHADERS];
     Shader currentShader;
+
+    // Samplers of per draw sampler states, indexed by clamp and linear filter
+    GX2Sampler samplers[2][2];
+#endif
+
+    RingBuffer transientBuffer;
+
+#ifdef DIAGNOSTICS
+    // Copy the current target into a capture buffer
+    void CaptureTarget();
+
+    FrameCapture frameCapture;
+    bool captureRequested;
+    uint32_t captureCount;
+    std::string capturePrefix;
+#endif
+
+    // Stats of the last finished frame and counters of the frame in progress
+    FrameStats frameStats;
+    FrameStats pendingStats;
+
+    bool bloomEnabled;
+    bool overdrawEnabled;
+
+    Target currentTarget;
+
+    BlendMode currentBlendMode;
+
+    bool alphaTestEnabled;
+    float alphaTestRef;
+
+    bool matrixUpdated;
+    glm::mat4 modelMatrix;
+    glm::mat4 viewMatrix;
+    glm::mat4 projectionMatrix;
 };
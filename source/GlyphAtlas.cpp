@@ -0,0 +1,267 @@
+#include "GlyphAtlas.hpp"
+#include "GlyphBlit.hpp"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_MODULE_H
+#include FT_ADVANCES_H
+
+#include <stdlib.h>
+#include <string.h>
+
+// Empty border around each glyph so linear filtering doesn't pick up the neighbours
+#define GLYPH_PADDING 1
+
+GlyphAtlas::GlyphAtlas() :
+    face(nullptr),
+    sdf(false),
+    rasterizer(nullptr),
+    texture(nullptr),
+    nextShelfY(0),
+    full(false),
+    generation(0),
+    revision(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    Finalize();
+}
+
+bool GlyphAtlas::Initialize(Gfx* gfx, FT_Face face, bool sdf, GlyphRasterizer* rasterizer)
+{
+    this->face = face;
+    this->sdf = sdf;
+    this->rasterizer = rasterizer;
+
+    // The spread is a property of the renderer, FT_RENDER_MODE_SDF needs FreeType 2.11
+    if (face && sdf) {
+        FT_UInt spread = SDF_SPREAD;
+        FT_Property_Set(face->glyph->library, "sdf", "spread", &spread);
+    }
+
+    texture = gfx->NewPreservedTexture(glm::uvec2(TEXTURE_SIZE), true, true);
+    if (!texture) {
+        return false;
+    }
+
+    return true;
+}
+
+void GlyphAtlas::Finalize()
+{
+    if (texture) {
+        texture->Delete();
+        texture = nullptr;
+    }
+
+    glyphs.clear();
+    shelves.clear();
+    nextShelfY = 0;
+    full = false;
+    face = nullptr;
+    rasterizer = nullptr;
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::GetGlyph(uint32_t codepoint, uint32_t pixelSize)
+{
+    uint64_t key = ((uint64_t) codepoint << 32) | pixelSize;
+    auto it = glyphs.find(key);
+    if (it != glyphs.end()) {
+        return &it->second;
+    }
+
+    if (!face || !texture) {
+        return nullptr;
+    }
+
+    Glyph glyph;
+    glyph.bearing = glm::ivec2(0, 0);
+    glyph.size = glm::uvec2(0, 0);
+    glyph.uvMin = glm::vec2(0.0f);
+    glyph.uvMax = glm::vec2(0.0f);
+    glyph.pending = false;
+
+    if (rasterizer) {
+        // Only the advance is needed for the layout, which is cheap compared to rendering
+        GlyphRasterizer::SetPixelSize(face, pixelSize);
+        FT_Fixed advance;
+        if (FT_Get_Advance(face, FT_Get_Char_Index(face, codepoint), FT_LOAD_DEFAULT, &advance) != 0) {
+            return nullptr;
+        }
+
+        glyph.advance = advance >> 16;
+        glyph.pending = true;
+        rasterizer->Submit({ codepoint, pixelSize, sdf });
+        return &(glyphs[key] = glyph);
+    }
+
+    FT_GlyphSlot slot = GlyphRasterizer::Render(face, codepoint, pixelSize, sdf);
+    if (!slot) {
+        return nullptr;
+    }
+
+    glyph.bearing = glm::ivec2(slot->bitmap_left, -slot->bitmap_top);
+    glyph.size = glm::uvec2(slot->bitmap.width, slot->bitmap.rows);
+    glyph.advance = slot->advance.x >> 6;
+
+    // Whitespace only has an advance
+    if (glyph.size.x && glyph.size.y) {
+        glm::uvec2 pos;
+        if (!Pack(glyph.size, &pos)) {
+            // Draws of this frame still use the texture, keep the metrics for the layout
+            // and add the glyph again after the eviction. Glyphs larger than the texture never fit.
+            if (glyph.size.x < TEXTURE_SIZE && glyph.size.y < TEXTURE_SIZE) {
+                full = true;
+            }
+            unpackedGlyph = glyph;
+            unpackedGlyph.size = glm::uvec2(0);
+            return &unpackedGlyph;
+        }
+
+        Blit(pos, glyph.size, slot->bitmap.buffer, slot->bitmap.pitch);
+        glyph.uvMin = glm::vec2(pos) / (float) TEXTURE_SIZE;
+        glyph.uvMax = glm::vec2(pos + glyph.size) / (float) TEXTURE_SIZE;
+    }
+
+    stats.rasterized++;
+    stats.glyphs++;
+    return &(glyphs[key] = glyph);
+}
+
+void GlyphAtlas::EndFrame()
+{
+    if (!full) {
+        return;
+    }
+
+    glyphs.clear();
+    shelves.clear();
+    nextShelfY = 0;
+    full = false;
+
+    // The GPU is done with the last frame, so the texture can be cleared
+    void* pixels = texture->Lock();
+    memset(pixels, 0, texture->GetSize().y * texture->GetPitch() * 4);
+    texture->Unlock();
+
+    generation++;
+    stats.glyphs = 0;
+    stats.evictions++;
+}
+
+void GlyphAtlas::AddGlyph(GlyphRasterizer::Result const& result)
+{
+    const GlyphRasterizer::Request& request = result.request;
+    uint64_t key = ((uint64_t) request.codepoint << 32) | request.pixelSize;
+
+    // The glyph was evicted while it was rendered, or requested twice
+    auto it = glyphs.find(key);
+    if (it == glyphs.end() || !it->second.pending) {
+        free(result.bitmap);
+        return;
+    }
+
+    Glyph& glyph = it->second;
+    if (result.size.x && result.size.y) {
+        glm::uvec2 pos;
+        if (!Pack(result.size, &pos)) {
+            // Stays pending and is requested again after the eviction, glyphs larger than the texture never fit
+            if (result.size.x < TEXTURE_SIZE && result.size.y < TEXTURE_SIZE) {
+                full = true;
+            } else {
+                glyph.pending = false;
+                revision++;
+            }
+            free(result.bitmap);
+            return;
+        }
+
+        Blit(pos, result.size, result.bitmap, result.size.x);
+        glyph.bearing = result.bearing;
+        glyph.size = result.size;
+        glyph.uvMin = glm::vec2(pos) / (float) TEXTURE_SIZE;
+        glyph.uvMax = glm::vec2(pos + result.size) / (float) TEXTURE_SIZE;
+    }
+    glyph.pending = false;
+    free(result.bitmap);
+
+    revision++;
+    stats.rasterized++;
+    stats.glyphs++;
+}
+
+GlyphAtlas::Metrics GlyphAtlas::GetMetrics(uint32_t pixelSize)
+{
+    Metrics metrics = {};
+    if (!face) {
+        return metrics;
+    }
+
+    GlyphRasterizer::SetPixelSize(face, pixelSize);
+
+    metrics.lineHeight = face->size->metrics.height >> 6;
+    metrics.maxGlyphHeight = (face->bbox.yMax - face->bbox.yMin) >> 6;
+    return metrics;
+}
+
+Gfx::Texture* GlyphAtlas::GetTexture() const
+{
+    return texture;
+}
+
+uint32_t GlyphAtlas::GetGeneration() const
+{
+    return generation;
+}
+
+uint32_t GlyphAtlas::GetRevision() const
+{
+    return revision;
+}
+
+GlyphAtlas::Stats const& GlyphAtlas::GetStats() const
+{
+    return stats;
+}
+
+bool GlyphAtlas::Pack(glm::uvec2 size, glm::uvec2* pos)
+{
+    glm::uvec2 padded = size + glm::uvec2(GLYPH_PADDING * 2);
+    if (padded.x > TEXTURE_SIZE || padded.y > TEXTURE_SIZE) {
+        return false;
+    }
+
+    // Use the lowest shelf the glyph fits into without wasting too much height
+    Shelf* best = nullptr;
+    for (Shelf& shelf : shelves) {
+        if (shelf.height >= padded.y && shelf.height <= padded.y + padded.y / 2 && shelf.x + padded.x <= TEXTURE_SIZE) {
+            if (!best || shelf.height < best->height) {
+                best = &shelf;
+            }
+        }
+    }
+
+    if (!best) {
+        if (nextShelfY + padded.y > TEXTURE_SIZE) {
+            return false;
+        }
+
+        shelves.push_back({ nextShelfY, padded.y, 0 });
+        nextShelfY += padded.y;
+        best = &shelves.back();
+    }
+
+    *pos = glm::uvec2(best->x, best->y) + glm::uvec2(GLYPH_PADDING);
+    best->x += padded.x;
+    return true;
+}
+
+void GlyphAtlas::Blit(glm::uvec2 pos, glm::uvec2 size, const uint8_t* bitmap, int32_t pitch)
+{
+    GlyphBlit::Surface surface = { (uint8_t*) texture->Lock(), texture->GetPitch(), texture->GetSize() };
+    GlyphBlit::Copy(surface, glm::ivec2(pos), { bitmap, pitch, size });
+    texture->Unlock(pos.y, size.y);
+}
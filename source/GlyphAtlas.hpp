@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Gfx.hpp"
+#include "GlyphRasterizer.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+typedef struct FT_FaceRec_* FT_Face;
+
+// Caches rendered glyphs of all text sizes in one texture.
+// A distance field atlas stores signed distances to the outline instead of coverage, 0.5 being
+// the edge. Those glyphs are rendered once and scaled freely with the alpha test.
+// Glyphs are rasterized by FreeType the first time they're requested and packed into shelves.
+// With a rasterizer new glyphs are only measured, they stay pending until the worker rendered
+// them and they were added at the end of a frame. The revision changes whenever that happened.
+// Once the texture is full new glyphs are only measured and everything is evicted at the end of
+// the frame, when no draw references the texture anymore. The generation changes on eviction so
+// users know to request their glyphs again.
+class GlyphAtlas {
+public:
+    static constexpr uint32_t TEXTURE_SIZE = 1024;
+
+    // Distance in pixels covered by a distance field from the edge to either end of the range
+    static constexpr uint32_t SDF_SPREAD = 8;
+
+    struct Glyph {
+        // Offset of the bitmap from the pen position on the baseline
+        glm::ivec2 bearing;
+        glm::uvec2 size;
+        glm::vec2 uvMin;
+        glm::vec2 uvMax;
+        int32_t advance;
+        // Still rendered in the background, only the advance is known
+        bool pending;
+    };
+
+    struct Metrics {
+        // Distance between two baselines
+        uint32_t lineHeight;
+        // Height of the bounding box of all glyphs
+        uint32_t maxGlyphHeight;
+    };
+
+    struct Stats {
+        uint32_t glyphs;
+        // Glyphs rasterized since startup
+        uint32_t rasterized;
+        // Number of times the texture was full
+        uint32_t evictions;
+    };
+
+    GlyphAtlas();
+    virtual ~GlyphAtlas();
+
+    // The face is only used by the calling thread, glyphs are rendered by rasterizer if set.
+    // The texture is preserved by gfx, so the glyphs survive the HOME Menu.
+    bool Initialize(Gfx* gfx, FT_Face face, bool sdf = false, GlyphRasterizer* rasterizer = nullptr);
+
+    void Finalize();
+
+    // Returns nullptr if the glyph doesn't exist, glyphs which didn't fit have no size
+    const Glyph* GetGlyph(uint32_t codepoint, uint32_t pixelSize);
+
+    // Evict all glyphs if the texture ran full, call once the frame was presented
+    void EndFrame();
+
+    // Add a glyph the rasterizer rendered, takes ownership of the bitmap
+    void AddGlyph(GlyphRasterizer::Result const& result);
+
+    Metrics GetMetrics(uint32_t pixelSize);
+
+    Gfx::Texture* GetTexture() const;
+
+    uint32_t GetGeneration() const;
+
+    uint32_t GetRevision() const;
+
+    Stats const& GetStats() const;
+
+private:
+    struct Shelf {
+        uint32_t y;
+        uint32_t height;
+        uint32_t x;
+    };
+
+    bool Pack(glm::uvec2 size, glm::uvec2* pos);
+
+    // Copy the coverage or distance into the alpha channel of white pixels
+    void Blit(glm::uvec2 pos, glm::uvec2 size, const uint8_t* bitmap, int32_t pitch);
+
+    FT_Face face;
+    bool sdf;
+    GlyphRasterizer* rasterizer;
+
+    Gfx::Texture* texture;
+
+    std::unordered_map<uint64_t, Glyph> glyphs;
+    std::vector<Shelf> shelves;
+    uint32_t nextShelfY;
+
+    // Metrics of the last glyph which didn't fit
+    Glyph unpackedGlyph;
+    bool full;
+
+    uint32_t generation;
+    uint32_t revision;
+    Stats stats;
+};
@@ -0,0 +1,262 @@
+#include "GlyphBlit.hpp"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// x / 255 rounded, exact for products of two bytes. Every path uses this so they match bit by bit.
+static inline uint32_t Div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// Div255 on the two 16-bit lanes of 0x00FF00FF masked values
+static inline uint32_t Div255Pairs(uint32_t x)
+{
+    x += 0x00800080;
+    return ((x + ((x >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+}
+
+static inline uint32_t Load32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline void Store32(uint8_t* p, uint32_t v)
+{
+    memcpy(p, &v, 4);
+}
+
+// White with the coverage in the alpha byte, which is the last one in memory
+static inline uint32_t WhiteWithAlpha(uint8_t alpha)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return 0xFFFFFF00u | alpha;
+#else
+    return 0x00FFFFFFu | ((uint32_t) alpha << 24);
+#endif
+}
+
+void GlyphBlit::Copy(Surface const& dst, glm::ivec2 pos, Bitmap const& glyph)
+{
+    Clip clip;
+    if (!ClipGlyph(dst, pos, glyph, &clip)) {
+        return;
+    }
+
+    for (uint32_t y = 0; y < clip.size.y; ++y) {
+        CopyRow(clip.dst + y * dst.pitch * 4, clip.src + y * glyph.pitch, clip.size.x);
+    }
+}
+
+void GlyphBlit::Blend(Surface const& dst, glm::ivec2 pos, Bitmap const& glyph, glm::u8vec4 color)
+{
+    Clip clip;
+    if (!ClipGlyph(dst, pos, glyph, &clip)) {
+        return;
+    }
+
+    // Premultiply once per glyph
+    glm::u8vec4 premultiplied = glm::u8vec4(Div255(color.r * color.a), Div255(color.g * color.a), Div255(color.b * color.a), color.a);
+
+    for (uint32_t y = 0; y < clip.size.y; ++y) {
+        BlendRow(clip.dst + y * dst.pitch * 4, clip.src + y * glyph.pitch, clip.size.x, premultiplied);
+    }
+}
+
+void GlyphBlit::BlendShadowed(Surface const& dst, glm::ivec2 pos, Bitmap const& glyph, glm::u8vec4 color,
+    glm::ivec2 offset, glm::u8vec4 shadowColor)
+{
+    Blend(dst, pos + offset, glyph, shadowColor);
+    Blend(dst, pos, glyph, color);
+}
+
+void GlyphBlit::BlendOutlined(Surface const& dst, glm::ivec2 pos, Bitmap const& glyph, glm::u8vec4 color,
+    uint32_t radius, glm::u8vec4 outlineColor)
+{
+    const glm::uvec2 size = glyph.size + glm::uvec2(radius * 2);
+
+    // Grow the coverage with a separable maximum, rows first into the upper half of the buffer
+    outlineBuffer.assign(size.x * size.y + size.x * glyph.size.y, 0);
+    uint8_t* grown = outlineBuffer.data();
+    uint8_t* rows = grown + size.x * size.y;
+
+    for (uint32_t y = 0; y < glyph.size.y; ++y) {
+        const uint8_t* src = glyph.coverage + y * glyph.pitch;
+        uint8_t* dstRow = rows + y * size.x;
+        for (uint32_t x = 0; x < glyph.size.x; ++x) {
+            // Pixel x of the glyph reaches x..x + 2 * radius of the grown row
+            uint8_t* out = dstRow + x;
+            for (uint32_t i = 0; i <= radius * 2; ++i) {
+                out[i] = glm::max(out[i], src[x]);
+            }
+        }
+    }
+
+    for (uint32_t y = 0; y < glyph.size.y; ++y) {
+        const uint8_t* src = rows + y * size.x;
+        for (uint32_t i = 0; i <= radius * 2; ++i) {
+            uint8_t* out = grown + (y + i) * size.x;
+            for (uint32_t x = 0; x < size.x; ++x) {
+                out[x] = glm::max(out[x], src[x]);
+            }
+        }
+    }
+
+    Bitmap outline = { grown, (int32_t) size.x, size };
+    Blend(dst, pos - glm::ivec2(radius), outline, outlineColor);
+    Blend(dst, pos, glyph, color);
+}
+
+void GlyphBlit::SetSimdEnabled(bool enabled)
+{
+    simdEnabled = enabled;
+}
+
+bool GlyphBlit::ClipGlyph(Surface const& dst, glm::ivec2 pos, Bitmap const& glyph, Clip* clip)
+{
+    glm::ivec2 start = glm::max(pos, glm::ivec2(0));
+    glm::ivec2 end = glm::min(pos + glm::ivec2(glyph.size), glm::ivec2(dst.size));
+    if (end.x <= start.x || end.y <= start.y) {
+        return false;
+    }
+
+    clip->dst = dst.pixels + (start.y * dst.pitch + start.x) * 4;
+    clip->src = glyph.coverage + (start.y - pos.y) * glyph.pitch + (start.x - pos.x);
+    clip->size = glm::uvec2(end - start);
+    return true;
+}
+
+void GlyphBlit::CopyRow(uint8_t* dst, const uint8_t* src, uint32_t width)
+{
+    uint32_t x = 0;
+
+    if (!simdEnabled) {
+        for (; x < width; ++x) {
+            dst[x * 4    ] = 255;
+            dst[x * 4 + 1] = 255;
+            dst[x * 4 + 2] = 255;
+            dst[x * 4 + 3] = src[x];
+        }
+        return;
+    }
+
+#if defined(__SSE2__)
+    const __m128i white = _mm_set1_epi8((char) 0xFF);
+    for (; x + 16 <= width; x += 16) {
+        __m128i coverage = _mm_loadu_si128((const __m128i*) (src + x));
+
+        // 0xFF, a interleaved, then 0xFFFF, (0xFF, a) interleaved gives 0xFF, 0xFF, 0xFF, a
+        __m128i lo = _mm_unpacklo_epi8(white, coverage);
+        __m128i hi = _mm_unpackhi_epi8(white, coverage);
+        _mm_storeu_si128((__m128i*) (dst + x * 4), _mm_unpacklo_epi16(white, lo));
+        _mm_storeu_si128((__m128i*) (dst + x * 4 + 16), _mm_unpackhi_epi16(white, lo));
+        _mm_storeu_si128((__m128i*) (dst + x * 4 + 32), _mm_unpacklo_epi16(white, hi));
+        _mm_storeu_si128((__m128i*) (dst + x * 4 + 48), _mm_unpackhi_epi16(white, hi));
+    }
+#elif defined(__ARM_NEON)
+    uint8x16x4_t pixels;
+    pixels.val[0] = vdupq_n_u8(0xFF);
+    pixels.val[1] = pixels.val[0];
+    pixels.val[2] = pixels.val[0];
+    for (; x + 16 <= width; x += 16) {
+        pixels.val[3] = vld1q_u8(src + x);
+        vst4q_u8(dst + x * 4, pixels);
+    }
+#endif
+
+    // One store per pixel
+    for (; x < width; ++x) {
+        Store32(dst + x * 4, WhiteWithAlpha(src[x]));
+    }
+}
+
+void GlyphBlit::BlendRow(uint8_t* dst, const uint8_t* src, uint32_t width, glm::u8vec4 color)
+{
+    uint32_t x = 0;
+
+    if (!simdEnabled) {
+        for (; x < width; ++x) {
+            uint32_t alpha = Div255(color.a * src[x]);
+            for (uint32_t c = 0; c < 4; ++c) {
+                dst[x * 4 + c] = Div255(color[c] * src[x]) + Div255(dst[x * 4 + c] * (255 - alpha));
+            }
+        }
+        return;
+    }
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i max = _mm_set1_epi16(255);
+    const __m128i color16 = _mm_setr_epi16(color.r, color.g, color.b, color.a, color.r, color.g, color.b, color.a);
+
+    auto div255 = [&](__m128i v) {
+        v = _mm_add_epi16(v, bias);
+        return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+    };
+
+    // Two pixels of 16-bit channels
+    auto blend = [&](__m128i pixels, __m128i coverage) {
+        __m128i source = div255(_mm_mullo_epi16(color16, coverage));
+        __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        return _mm_add_epi16(source, div255(_mm_mullo_epi16(pixels, _mm_sub_epi16(max, alpha))));
+    };
+
+    for (; x + 4 <= width; x += 4) {
+        // Spread the coverage of four pixels over their channels
+        __m128i coverage = _mm_unpacklo_epi8(_mm_cvtsi32_si128(Load32(src + x)), zero);
+        coverage = _mm_unpacklo_epi16(coverage, coverage);
+
+        __m128i pixels = _mm_loadu_si128((const __m128i*) (dst + x * 4));
+        __m128i lo = blend(_mm_unpacklo_epi8(pixels, zero), _mm_unpacklo_epi32(coverage, coverage));
+        __m128i hi = blend(_mm_unpackhi_epi8(pixels, zero), _mm_unpackhi_epi32(coverage, coverage));
+        _mm_storeu_si128((__m128i*) (dst + x * 4), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(__ARM_NEON)
+    // vraddhn(v, vrshr(v, 8)) is the same rounding as Div255
+    for (; x + 8 <= width; x += 8) {
+        uint8x8_t coverage = vld1_u8(src + x);
+        uint8x8x4_t pixels = vld4_u8(dst + x * 4);
+
+        uint8x8_t source[4];
+        for (int c = 0; c < 4; ++c) {
+            uint16x8_t product = vmull_u8(vdup_n_u8(color[c]), coverage);
+            source[c] = vraddhn_u16(product, vrshrq_n_u16(product, 8));
+        }
+
+        uint8x8_t inverse = vmvn_u8(source[3]);
+        for (int c = 0; c < 4; ++c) {
+            uint16x8_t product = vmull_u8(pixels.val[c], inverse);
+            pixels.val[c] = vadd_u8(source[c], vraddhn_u16(product, vrshrq_n_u16(product, 8)));
+        }
+        vst4_u8(dst + x * 4, pixels);
+    }
+#endif
+
+    // Two channels per multiply, the color is in memory order like the pixels
+    uint32_t colorWord;
+    memcpy(&colorWord, &color[0], 4);
+    const uint32_t colorRB = colorWord & 0x00FF00FF;
+    const uint32_t colorAG = (colorWord >> 8) & 0x00FF00FF;
+
+    for (; x < width; ++x) {
+        uint32_t coverage = src[x];
+        if (coverage == 0) {
+            continue;
+        }
+
+        uint32_t inverse = 255 - Div255(color.a * coverage);
+        uint32_t pixel = Load32(dst + x * 4);
+        uint32_t rb = Div255Pairs(colorRB * coverage) + Div255Pairs((pixel & 0x00FF00FF) * inverse);
+        uint32_t ag = Div255Pairs(colorAG * coverage) + Div255Pairs(((pixel >> 8) & 0x00FF00FF) * inverse);
+        Store32(dst + x * 4, rb | (ag << 8));
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Composites 8-bit glyph coverage into RGBA8 surfaces.
+// Glyphs are clipped against the surface once, rows are then written without per pixel checks.
+// The host uses SSE2 or NEON, the console writes whole 32-bit pixels and blends two channels
+// per multiply, as paired singles only operate on floats.
+// Blended surfaces hold premultiplied alpha.
+class GlyphBlit {
+public:
+    struct Surface {
+        uint8_t* pixels;
+        // In pixels
+        uint32_t pitch;
+        glm::uvec2 size;
+    };
+
+    struct Bitmap {
+        const uint8_t* coverage;
+        // In bytes
+        int32_t pitch;
+        glm::uvec2 size;
+    };
+
+    // Store white with the coverage as alpha, the color is applied when drawing
+    static void Copy(Surface const& dst, glm::ivec2 pos, Bitmap const& glyph);
+
+    // Blend color scaled by the coverage over the surface
+    static void Blend(Surface const& dst, glm::ivec2 pos, Bitmap const& glyph, glm::u8vec4 color);
+
+    // Blend the glyph over a copy of itself at offset
+    static void BlendShadowed(Surface const& dst, glm::ivec2 pos, Bitmap const& glyph, glm::u8vec4 color,
+        glm::ivec2 offset, glm::u8vec4 shadowColor);
+
+    // Blend the glyph over a copy of itself grown by radius pixels
+    static void BlendOutlined(Surface const& dst, glm::ivec2 pos, Bitmap const& glyph, glm::u8vec4 color,
+        uint32_t radius, glm::u8vec4 outlineColor);
+
+    // Use the plain loops, lets the benchmark compare against them
+    static void SetSimdEnabled(bool enabled);
+
+private:
+    // Visible part of a glyph placed at pos
+    struct Clip {
+        uint8_t* dst;
+        const uint8_t* src;
+        glm::uvec2 size;
+    };
+
+    static bool ClipGlyph(Surface const& dst, glm::ivec2 pos, Bitmap const& glyph, Clip* clip);
+
+    static void CopyRow(uint8_t* dst, const uint8_t* src, uint32_t width);
+
+    static void BlendRow(uint8_t* dst, const uint8_t* src, uint32_t width, glm::u8vec4 color);
+
+    static inline bool simdEnabled = true;
+
+    // Grown coverage of outlined glyphs
+    static inline std::vector<uint8_t> outlineBuffer;
+};
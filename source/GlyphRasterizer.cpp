@@ -0,0 +1,222 @@
+#include "GlyphRasterizer.hpp"
+#include "GlyphAtlas.hpp"
+
+#include <coreinit/time.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_MODULE_H
+
+#include <malloc.h>
+#include <string.h>
+
+#define WORKER_STACK_SIZE (128 * 1024)
+
+// Same as the render thread, glyphs are needed within a frame or two
+#define WORKER_PRIORITY 16
+
+GlyphRasterizer::GlyphRasterizer() :
+    font(nullptr),
+    fontSize(0),
+    thread(nullptr),
+    threadStack(nullptr),
+    quit(false),
+    rendered(0),
+    lastRenderMs(0.0f),
+    backlogged(0)
+{
+}
+
+GlyphRasterizer::~GlyphRasterizer()
+{
+    Finalize();
+}
+
+bool GlyphRasterizer::Initialize(const void* font, uint32_t size)
+{
+    this->font = font;
+    this->fontSize = size;
+    quit = false;
+
+    OSInitMessageQueue(&wakeQueue, &wakeMessage, 1);
+
+    thread = (OSThread*) memalign(16, sizeof(OSThread));
+    threadStack = memalign(16, WORKER_STACK_SIZE);
+    if (!thread || !threadStack) {
+        Finalize();
+        return false;
+    }
+
+    // Render on core 0, the render thread runs on core 1 and frame captures are encoded on core 2
+    if (!OSCreateThread(thread, WorkerThread, 0, (char*) this, (uint8_t*) threadStack + WORKER_STACK_SIZE,
+        WORKER_STACK_SIZE, WORKER_PRIORITY, OS_THREAD_ATTRIB_AFFINITY_CPU0)) {
+        Finalize();
+        return false;
+    }
+
+    OSSetThreadName(thread, "GlyphRasterizer");
+    OSResumeThread(thread);
+
+    return true;
+}
+
+void GlyphRasterizer::Finalize()
+{
+    if (thread && threadStack) {
+        // Requests still queued are dropped
+        quit = true;
+        Wake();
+        OSJoinThread(thread, nullptr);
+    }
+
+    free(thread);
+    thread = nullptr;
+    free(threadStack);
+    threadStack = nullptr;
+
+    Request request;
+    while (requests.Pop(&request)) {
+    }
+    backlog.clear();
+
+    Result result;
+    while (results.Pop(&result)) {
+        free(result.bitmap);
+    }
+}
+
+void GlyphRasterizer::Submit(Request const& request)
+{
+    // Keep the order of backlogged requests
+    if (backlog.empty() && requests.Push(request)) {
+        Wake();
+        return;
+    }
+
+    backlog.push_back(request);
+    backlogged++;
+}
+
+bool GlyphRasterizer::Receive(Result* result)
+{
+    Flush();
+    return results.Pop(result);
+}
+
+GlyphRasterizer::Stats GlyphRasterizer::GetStats() const
+{
+    Stats stats;
+    stats.rendered = rendered;
+    stats.backlogged = backlogged;
+    stats.lastRenderMs = lastRenderMs;
+    return stats;
+}
+
+FT_GlyphSlot GlyphRasterizer::Render(FT_Face face, uint32_t codepoint, uint32_t pixelSize, bool sdf)
+{
+    SetPixelSize(face, pixelSize);
+
+    if (FT_Load_Char(face, codepoint, FT_LOAD_DEFAULT) != 0) {
+        return nullptr;
+    }
+
+    // Glyphs without an outline can't be rendered as distance fields and keep an empty bitmap
+    FT_Render_Glyph(face->glyph, sdf ? FT_RENDER_MODE_SDF : FT_RENDER_MODE_NORMAL);
+    return face->glyph;
+}
+
+void GlyphRasterizer::SetPixelSize(FT_Face face, uint32_t pixelSize)
+{
+    if (face->size->metrics.y_ppem != pixelSize) {
+        FT_Set_Pixel_Sizes(face, 0, pixelSize);
+    }
+}
+
+void GlyphRasterizer::Flush()
+{
+    if (backlog.empty()) {
+        return;
+    }
+
+    uint32_t pushed = 0;
+    while (pushed < backlog.size() && requests.Push(backlog[pushed])) {
+        pushed++;
+    }
+    backlog.erase(backlog.begin(), backlog.begin() + pushed);
+
+    if (pushed) {
+        Wake();
+    }
+}
+
+void GlyphRasterizer::Wake()
+{
+    // Fails if the worker wasn't woken up yet, which is fine
+    OSMessage message = {};
+    OSSendMessage(&wakeQueue, &message, OS_MESSAGE_FLAGS_NONE);
+}
+
+int GlyphRasterizer::WorkerThread(int argc, const char** argv)
+{
+    GlyphRasterizer* rasterizer = (GlyphRasterizer*) argv;
+
+    // A library and face only used by this thread
+    FT_Library library = nullptr;
+    FT_Face face = nullptr;
+    if (FT_Init_FreeType(&library) == 0) {
+        FT_UInt spread = GlyphAtlas::SDF_SPREAD;
+        FT_Property_Set(library, "sdf", "spread", &spread);
+
+        if (FT_New_Memory_Face(library, (const FT_Byte*) rasterizer->font, rasterizer->fontSize, 0, &face) != 0) {
+            face = nullptr;
+        }
+    }
+
+    while (!rasterizer->quit) {
+        Request request;
+        if (!rasterizer->requests.Pop(&request)) {
+            OSMessage message;
+            OSReceiveMessage(&rasterizer->wakeQueue, &message, OS_MESSAGE_FLAGS_BLOCKING);
+            continue;
+        }
+
+        OSTime start = OSGetTime();
+
+        // Glyphs which couldn't be rendered come back empty, so they aren't requested again
+        Result result = {};
+        result.request = request;
+
+        FT_GlyphSlot slot = face ? Render(face, request.codepoint, request.pixelSize, request.sdf) : nullptr;
+        if (slot && slot->bitmap.width && slot->bitmap.rows) {
+            result.bitmap = (uint8_t*) malloc(slot->bitmap.width * slot->bitmap.rows);
+            if (result.bitmap) {
+                result.bearing = glm::ivec2(slot->bitmap_left, -slot->bitmap_top);
+                result.size = glm::uvec2(slot->bitmap.width, slot->bitmap.rows);
+                for (uint32_t y = 0; y < result.size.y; ++y) {
+                    memcpy(result.bitmap + y * result.size.x, slot->bitmap.buffer + y * slot->bitmap.pitch, result.size.x);
+                }
+            }
+        }
+
+        rasterizer->lastRenderMs = OSTicksToMicroseconds(OSGetTime() - start) / 1000.0f;
+        rasterizer->rendered++;
+
+        // The render thread empties the results every frame
+        while (!rasterizer->results.Push(result)) {
+            if (rasterizer->quit) {
+                free(result.bitmap);
+                break;
+            }
+            OSSleepTicks(OSMillisecondsToTicks(1));
+        }
+    }
+
+    if (face) {
+        FT_Done_Face(face);
+    }
+    if (library) {
+        FT_Done_FreeType(library);
+    }
+
+    return 0;
+}
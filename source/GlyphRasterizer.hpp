@@ -0,0 +1,101 @@
+#pragma once
+
+#include "SpscQueue.hpp"
+
+#include <glm/glm.hpp>
+
+#include <coreinit/thread.h>
+#include <coreinit/messagequeue.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+typedef struct FT_FaceRec_* FT_Face;
+typedef struct FT_GlyphSlotRec_* FT_GlyphSlot;
+typedef struct FT_LibraryRec_* FT_Library;
+
+// Renders glyph bitmaps with FreeType on a worker thread, so changing texts never stalls a frame.
+// FreeType objects may only be used by one thread at a time. The worker opens its own library
+// and face on the same font data, the face of the render thread is only used for metrics.
+// Requests and results are passed through queues without locks, the worker sleeps on a message
+// queue while there is nothing to do.
+class GlyphRasterizer {
+public:
+    static constexpr uint32_t QUEUE_SIZE = 256;
+
+    struct Request {
+        uint32_t codepoint;
+        uint32_t pixelSize;
+        bool sdf;
+    };
+
+    struct Result {
+        Request request;
+        // Offset of the bitmap from the pen position on the baseline
+        glm::ivec2 bearing;
+        glm::uvec2 size;
+        // size.x * size.y bytes of coverage or distance allocated with malloc, owned by the receiver
+        uint8_t* bitmap;
+    };
+
+    struct Stats {
+        uint32_t rendered;
+        // Requests which waited for space in the queue
+        uint32_t backlogged;
+        // Time the worker spent on the last glyph
+        float lastRenderMs;
+    };
+
+    GlyphRasterizer();
+    virtual ~GlyphRasterizer();
+
+    // Start the worker on font, which has to stay valid until Finalize
+    bool Initialize(const void* font, uint32_t size);
+
+    void Finalize();
+
+    // Render thread side, queue a glyph to be rendered
+    void Submit(Request const& request);
+
+    // Render thread side, returns false once no more results are ready
+    bool Receive(Result* result);
+
+    Stats GetStats() const;
+
+    // Render codepoint into the slot of face, returns nullptr if the glyph doesn't exist.
+    // Glyphs without an outline like whitespace have an empty bitmap.
+    static FT_GlyphSlot Render(FT_Face face, uint32_t codepoint, uint32_t pixelSize, bool sdf);
+
+    // Only changes the size of the shared face when needed, as that resets the scaler
+    static void SetPixelSize(FT_Face face, uint32_t pixelSize);
+
+private:
+    static int WorkerThread(int argc, const char** argv);
+
+    // Move backlogged requests into the queue
+    void Flush();
+
+    void Wake();
+
+    const void* font;
+    uint32_t fontSize;
+
+    OSThread* thread;
+    void* threadStack;
+    std::atomic<bool> quit;
+
+    SpscQueue<Request, QUEUE_SIZE> requests;
+    SpscQueue<Result, QUEUE_SIZE> results;
+
+    // Requests which didn't fit into the queue
+    std::vector<Request> backlog;
+
+    // Wakes the worker, one message is enough
+    OSMessageQueue wakeQueue;
+    OSMessage wakeMessage;
+
+    std::atomic<uint32_t> rendered;
+    std::atomic<float> lastRenderMs;
+    uint32_t backlogged;
+};
@@ -0,0 +1,138 @@
+#include "GpuTimer.hpp"
+
+#include <malloc.h>
+#include <string.h>
+
+#ifdef __WIIU__
+#include <gx2/event.h>
+#include <coreinit/cache.h>
+#endif
+
+// Timestamps are written by the GPU so keep every frame on its own cache lines
+#define SAMPLE_ALIGNMENT 0x40
+
+GpuTimer::GpuTimer() :
+    current(0),
+    sampleMemory(nullptr)
+{
+    memset(frames, 0, sizeof(frames));
+
+#ifndef __WIIU__
+    syntheticFrame = 0;
+#endif
+}
+
+GpuTimer::~GpuTimer()
+{
+    Finalize();
+}
+
+bool GpuTimer::Initialize()
+{
+    uint32_t size = MAX_FRAMES * MAX_SAMPLES * sizeof(uint64_t);
+    sampleMemory = (uint64_t*) memalign(SAMPLE_ALIGNMENT, size);
+    if (!sampleMemory) {
+        return false;
+    }
+
+    memset(sampleMemory, 0, size);
+#ifdef __WIIU__
+    DCFlushRange(sampleMemory, size);
+#endif
+
+    for (uint32_t i = 0; i < MAX_FRAMES; ++i) {
+        frames[i].samples = sampleMemory + i * MAX_SAMPLES;
+        frames[i].validMask = 0;
+        frames[i].fence = 0;
+        frames[i].pending = false;
+    }
+    current = 0;
+
+    return true;
+}
+
+void GpuTimer::Finalize()
+{
+    free(sampleMemory);
+    sampleMemory = nullptr;
+}
+
+void GpuTimer::Sample(uint32_t index)
+{
+    if (!sampleMemory || index >= MAX_SAMPLES) {
+        return;
+    }
+
+    Frame& frame = frames[current];
+
+#ifdef __WIIU__
+    GX2SampleBottomGPUCycle(&frame.samples[index]);
+#else
+    // Synthetic timings on the host: every slot is 1ms after the previous one, frames are 16.6ms apart
+    frame.samples[index] = syntheticFrame * (CLOCK_RATE / 60) + index * (CLOCK_RATE / 1000);
+#endif
+
+    frame.validMask |= 1u << index;
+}
+
+void GpuTimer::EndFrame(uint64_t fence)
+{
+    if (!sampleMemory) {
+        return;
+    }
+
+    Frame& frame = frames[current];
+    frame.fence = fence;
+    frame.pending = frame.validMask != 0;
+
+    // Move on to the next frame, results of a frame the GPU didn't finish yet are dropped
+    current = (current + 1) % MAX_FRAMES;
+    frames[current].pending = false;
+    frames[current].validMask = 0;
+
+#ifndef __WIIU__
+    syntheticFrame++;
+#endif
+}
+
+bool GpuTimer::Resolve(uint64_t* samples, uint32_t* validMask)
+{
+    if (!sampleMemory) {
+        return false;
+    }
+
+#ifdef __WIIU__
+    uint64_t retired = GX2GetRetiredTimeStamp();
+#endif
+
+    bool resolved = false;
+
+    // Walk from the oldest to the newest frame so the newest result wins
+    for (uint32_t i = 1; i <= MAX_FRAMES; ++i) {
+        Frame& frame = frames[(current + i) % MAX_FRAMES];
+        if (!frame.pending) {
+            continue;
+        }
+
+#ifdef __WIIU__
+        if (frame.fence > retired) {
+            continue;
+        }
+
+        // The GPU wrote the samples, make sure we don't read stale cache lines
+        DCInvalidateRange(frame.samples, MAX_SAMPLES * sizeof(uint64_t));
+#endif
+
+        memcpy(samples, frame.samples, MAX_SAMPLES * sizeof(uint64_t));
+        *validMask = frame.validMask;
+        frame.pending = false;
+        resolved = true;
+    }
+
+    return resolved;
+}
+
+float GpuTimer::CyclesToMilliseconds(uint64_t cycles)
+{
+    return (float) ((double) cycles * 1000.0 / CLOCK_RATE);
+}
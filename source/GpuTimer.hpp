@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+// Collects GPU timestamps written by the command processor and reads them back
+// once the frame retired, so querying never stalls the render thread.
+class GpuTimer {
+public:
+    static constexpr uint32_t MAX_SAMPLES = 8;
+
+    // GPU timestamps count at 27MHz
+    static constexpr uint64_t CLOCK_RATE = 27000000;
+
+    GpuTimer();
+    virtual ~GpuTimer();
+
+    bool Initialize();
+
+    void Finalize();
+
+    // Write a timestamp into sample slot index once the GPU reaches this point
+    void Sample(uint32_t index);
+
+    // Finish the current frame, fence is the GX2 timestamp of its last command buffer
+    void EndFrame(uint64_t fence);
+
+    // Copy the samples of the newest frame which retired since the last call
+    bool Resolve(uint64_t* samples, uint32_t* validMask);
+
+    static float CyclesToMilliseconds(uint64_t cycles);
+
+private:
+    // Frames which can be in flight before their results are dropped
+    static constexpr uint32_t MAX_FRAMES = 4;
+
+    struct Frame {
+        uint64_t* samples;
+        uint32_t validMask;
+        uint64_t fence;
+        bool pending;
+    };
+
+    Frame frames[MAX_FRAMES];
+    uint32_t current;
+
+    uint64_t* sampleMemory;
+
+#ifndef __WIIU__
+    uint64_t syntheticFrame;
+#endif
+};
@@ -0,0 +1,181 @@
+#include "Input.hpp"
+#include "InputLog.hpp"
+
+#include <coreinit/debug.h>
+
+#include <stdio.h>
+
+static VPADStatus samples[Input::NUM_CHANNELS];
+static bool connected[Input::NUM_CHANNELS];
+
+// What was read this frame, without edges of earlier frames
+static VPADStatus frameSamples[Input::NUM_CHANNELS];
+static bool frameConnected[Input::NUM_CHANNELS];
+
+static bool recording = false;
+static InputLog::Writer recorder;
+
+static bool replaying = false;
+static InputLog::Reader replay;
+static std::vector<uint8_t> replayData;
+
+void Input::Update()
+{
+    for (uint32_t i = 0; i < NUM_CHANNELS; ++i) {
+        VPADStatus status{};
+        VPADReadError error = VPAD_READ_SUCCESS;
+        VPADRead((VPADChan) i, &status, 1, &error);
+
+        // Keep the last sample until there is a new one, nothing was pressed or released since
+        if (error == VPAD_READ_NO_SAMPLES) {
+            frameSamples[i].trigger = 0;
+            frameSamples[i].release = 0;
+            continue;
+        }
+
+        connected[i] = error == VPAD_READ_SUCCESS;
+        frameConnected[i] = connected[i];
+        if (!connected[i]) {
+            samples[i] = {};
+            frameSamples[i] = {};
+            continue;
+        }
+
+        frameSamples[i] = status;
+
+        // Add up the edges until a step saw them
+        uint32_t trigger = samples[i].trigger | status.trigger;
+        uint32_t release = samples[i].release | status.release;
+        samples[i] = status;
+        samples[i].trigger = trigger;
+        samples[i].release = release;
+    }
+}
+
+bool Input::Read(VPADChan chan, VPADStatus* status)
+{
+    if ((uint32_t) chan >= NUM_CHANNELS) {
+        *status = {};
+        return false;
+    }
+
+    *status = samples[chan];
+    return connected[chan];
+}
+
+bool Input::ReadFrame(VPADChan chan, VPADStatus* status)
+{
+    if ((uint32_t) chan >= NUM_CHANNELS) {
+        *status = {};
+        return false;
+    }
+
+    *status = frameSamples[chan];
+    return frameConnected[chan];
+}
+
+void Input::BeginStep()
+{
+    InputLog::Sample logged[NUM_CHANNELS];
+
+    // The live GamePads take over once the replay ended
+    if (replaying && !replay.Next(logged)) {
+        OSReport("Replay ended after %u steps\n", replay.GetTick());
+        replaying = false;
+    }
+
+    if (replaying) {
+        for (uint32_t i = 0; i < NUM_CHANNELS; ++i) {
+            samples[i] = {};
+            connected[i] = logged[i].connected;
+            samples[i].hold = logged[i].hold;
+            samples[i].trigger = logged[i].trigger;
+            samples[i].release = logged[i].release;
+            samples[i].leftStick.x = InputLog::GetStickValue(logged[i].sticks[0]);
+            samples[i].leftStick.y = InputLog::GetStickValue(logged[i].sticks[1]);
+            samples[i].rightStick.x = InputLog::GetStickValue(logged[i].sticks[2]);
+            samples[i].rightStick.y = InputLog::GetStickValue(logged[i].sticks[3]);
+        }
+    }
+
+    if (!recording) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < NUM_CHANNELS; ++i) {
+        logged[i].connected = connected[i];
+        logged[i].hold = samples[i].hold;
+        logged[i].trigger = samples[i].trigger;
+        logged[i].release = samples[i].release;
+        logged[i].sticks[0] = InputLog::QuantizeStick(samples[i].leftStick.x);
+        logged[i].sticks[1] = InputLog::QuantizeStick(samples[i].leftStick.y);
+        logged[i].sticks[2] = InputLog::QuantizeStick(samples[i].rightStick.x);
+        logged[i].sticks[3] = InputLog::QuantizeStick(samples[i].rightStick.y);
+
+        // The step has to see what a replay will see
+        samples[i].leftStick.x = InputLog::GetStickValue(logged[i].sticks[0]);
+        samples[i].leftStick.y = InputLog::GetStickValue(logged[i].sticks[1]);
+        samples[i].rightStick.x = InputLog::GetStickValue(logged[i].sticks[2]);
+        samples[i].rightStick.y = InputLog::GetStickValue(logged[i].sticks[3]);
+    }
+
+    if (!recorder.Append(logged)) {
+        OSReport("Input log is full after %u steps\n", recorder.GetTickCount());
+        recording = false;
+    }
+}
+
+void Input::EndStep()
+{
+    for (VPADStatus& sample : samples) {
+        sample.trigger = 0;
+        sample.release = 0;
+    }
+}
+
+void Input::StartRecording(uint32_t seed, uint32_t stepRate)
+{
+    recorder.Begin(seed, stepRate, NUM_CHANNELS, MAX_LOG_SIZE);
+    recording = true;
+}
+
+bool Input::SaveRecording(const char* path)
+{
+    std::vector<uint8_t> const& data = recorder.Finish();
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+
+    bool written = fwrite(data.data(), 1, data.size(), f) == data.size();
+    return fclose(f) == 0 && written;
+}
+
+bool Input::StartReplay(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+
+    fseek(f, 0, SEEK_END);
+    replayData.resize(ftell(f));
+    fseek(f, 0, SEEK_SET);
+    bool read = fread(replayData.data(), 1, replayData.size(), f) == replayData.size();
+    fclose(f);
+
+    // A log with fewer channels would leave the others unset
+    replaying = read && replay.Open(replayData.data(), replayData.size()) && replay.GetNumChannels() == NUM_CHANNELS;
+    return replaying;
+}
+
+bool Input::IsReplaying()
+{
+    return replaying;
+}
+
+uint32_t Input::GetReplaySeed()
+{
+    return replay.GetSeed();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vpad/input.h>
+
+#include <cstdint>
+
+// Samples the GamePads once per frame for the fixed simulation steps.
+// Buttons triggered or released since the last step are kept until a step saw them, so
+// presses aren't lost on frames without a step or seen twice on frames with several.
+// What every step saw can be recorded into an InputLog and replayed in place of the GamePads,
+// together with the random seed that gives the same match again.
+class Input {
+public:
+    static constexpr uint32_t NUM_CHANNELS = 2;
+    // About an hour of play
+    static constexpr uint32_t MAX_LOG_SIZE = 1024 * 1024;
+
+    // Read all GamePads, call this once per frame before the steps
+    static void Update();
+
+    // The sample of the channel for the current step, returns false if the GamePad isn't connected
+    static bool Read(VPADChan chan, VPADStatus* status);
+
+    // The sample of the channel for this frame, for things which don't happen in steps like captures.
+    // Edges are only set on the frame they happened, whether a step ran or not.
+    static bool ReadFrame(VPADChan chan, VPADStatus* status);
+
+    // Replace the samples with the replayed ones and record them, call this before every step
+    static void BeginStep();
+
+    // The edges have been seen by a step
+    static void EndStep();
+
+    // Record every step from now on, sticks are rounded to what the log stores
+    static void StartRecording(uint32_t seed, uint32_t stepRate);
+
+    // Write what was recorded so far to path
+    static bool SaveRecording(const char* path);
+
+    // Feed the steps from a log until it ends, returns false if it can't be read
+    static bool StartReplay(const char* path);
+
+    static bool IsReplaying();
+
+    // Seed of the match in the replayed log
+    static uint32_t GetReplaySeed();
+};
@@ -0,0 +1,353 @@
+#include "InputLog.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Ticks start with a tag, below this it's a run of tag + 1 unchanged ticks,
+// otherwise the low bits are the channels which changed
+#define TAG_CHANGED 0x80
+#define MAX_RUN 0x80
+
+// Every changed channel has a byte with the fields which follow
+#define FIELD_CONNECTED (1 << 0)
+#define FIELD_HOLD (1 << 1)
+#define FIELD_TRIGGER (1 << 2)
+#define FIELD_RELEASE (1 << 3)
+#define FIELD_STICK(i) (1 << (4 + (i)))
+
+// Varints take at most 5 bytes for 32 bits, stick deltas fit into 3
+#define MAX_CHANNEL_SIZE (1 + 3 * 5 + 4 * 3)
+
+static void Put16(uint8_t* data, uint16_t value)
+{
+    data[0] = value;
+    data[1] = value >> 8;
+}
+
+static void Put32(uint8_t* data, uint32_t value)
+{
+    Put16(data, value);
+    Put16(data + 2, value >> 16);
+}
+
+static uint16_t Get16(const uint8_t* data)
+{
+    return data[0] | (data[1] << 8);
+}
+
+static uint32_t Get32(const uint8_t* data)
+{
+    return Get16(data) | ((uint32_t) Get16(data + 2) << 16);
+}
+
+static void PutVarint(std::vector<uint8_t>& data, uint32_t value)
+{
+    while (value >= 0x80) {
+        data.push_back(value | 0x80);
+        value >>= 7;
+    }
+    data.push_back(value);
+}
+
+// Small deltas in both directions become small unsigned values
+static uint32_t ZigZag(int32_t value)
+{
+    return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+}
+
+static int32_t UnZigZag(uint32_t value)
+{
+    return (int32_t) (value >> 1) ^ -(int32_t) (value & 1);
+}
+
+int16_t InputLog::QuantizeStick(float value)
+{
+    return (int16_t) std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+float InputLog::GetStickValue(int16_t value)
+{
+    return value / 32767.0f;
+}
+
+InputLog::Writer::Writer() :
+    numChannels(0),
+    maxSize(0),
+    tickCount(0),
+    run(0),
+    full(false),
+    last()
+{
+}
+
+void InputLog::Writer::Begin(uint32_t seed, uint32_t stepRate, uint32_t numChannels, uint32_t maxSize)
+{
+    this->numChannels = std::min(numChannels, MAX_CHANNELS);
+    this->maxSize = maxSize;
+    tickCount = 0;
+    run = 0;
+    full = false;
+    for (Sample& sample : last) {
+        sample = {};
+    }
+
+    data.clear();
+    data.reserve(std::min(maxSize, 64u * 1024u));
+    data.resize(HEADER_SIZE);
+    Put32(&data[0], MAGIC);
+    Put16(&data[4], VERSION);
+    data[6] = this->numChannels;
+    data[7] = 0;
+    Put32(&data[8], seed);
+    Put32(&data[12], stepRate);
+}
+
+bool InputLog::Writer::Append(const Sample* samples)
+{
+    if (full) {
+        return false;
+    }
+
+    uint8_t changed = 0;
+    uint8_t fields[MAX_CHANNELS] = {};
+    for (uint32_t i = 0; i < numChannels; ++i) {
+        Sample const& sample = samples[i];
+        Sample const& previous = last[i];
+
+        fields[i] |= sample.connected != previous.connected ? FIELD_CONNECTED : 0;
+        fields[i] |= sample.hold != previous.hold ? FIELD_HOLD : 0;
+        fields[i] |= sample.trigger != previous.trigger ? FIELD_TRIGGER : 0;
+        fields[i] |= sample.release != previous.release ? FIELD_RELEASE : 0;
+        for (uint32_t j = 0; j < 4; ++j) {
+            fields[i] |= sample.sticks[j] != previous.sticks[j] ? FIELD_STICK(j) : 0;
+        }
+
+        if (fields[i]) {
+            changed |= 1 << i;
+        }
+    }
+
+    // Unchanged ticks only cost a byte per run
+    if (!changed) {
+        if (data.size() + 1 > maxSize) {
+            full = true;
+            return false;
+        }
+
+        tickCount++;
+        if (++run == MAX_RUN) {
+            FlushRun();
+        }
+        return true;
+    }
+
+    if (data.size() + 2 + numChannels * MAX_CHANNEL_SIZE > maxSize) {
+        full = true;
+        return false;
+    }
+
+    FlushRun();
+    data.push_back(TAG_CHANGED | changed);
+    for (uint32_t i = 0; i < numChannels; ++i) {
+        if (!fields[i]) {
+            continue;
+        }
+
+        Sample const& sample = samples[i];
+        Sample const& previous = last[i];
+
+        // Held buttons change a few bits at a time, the edges are mostly zero
+        data.push_back(fields[i]);
+        if (fields[i] & FIELD_HOLD) {
+            PutVarint(data, sample.hold ^ previous.hold);
+        }
+        if (fields[i] & FIELD_TRIGGER) {
+            PutVarint(data, sample.trigger);
+        }
+        if (fields[i] & FIELD_RELEASE) {
+            PutVarint(data, sample.release);
+        }
+        for (uint32_t j = 0; j < 4; ++j) {
+            if (fields[i] & FIELD_STICK(j)) {
+                PutVarint(data, ZigZag(sample.sticks[j] - previous.sticks[j]));
+            }
+        }
+
+        last[i] = sample;
+    }
+
+    tickCount++;
+    return true;
+}
+
+std::vector<uint8_t> const& InputLog::Writer::Finish()
+{
+    FlushRun();
+    Put32(&data[16], tickCount);
+    Put32(&data[20], data.size() - HEADER_SIZE);
+    return data;
+}
+
+uint32_t InputLog::Writer::GetTickCount() const
+{
+    return tickCount;
+}
+
+void InputLog::Writer::FlushRun()
+{
+    if (run) {
+        data.push_back(run - 1);
+        run = 0;
+    }
+}
+
+InputLog::Reader::Reader() :
+    data(nullptr),
+    size(0),
+    offset(0),
+    seed(0),
+    stepRate(0),
+    numChannels(0),
+    tickCount(0),
+    tick(0),
+    run(0),
+    last()
+{
+}
+
+bool InputLog::Reader::Open(const void* data, uint32_t size)
+{
+    const uint8_t* bytes = (const uint8_t*) data;
+    if (size < HEADER_SIZE || Get32(bytes) != MAGIC || Get16(bytes + 4) != VERSION ||
+        bytes[6] > MAX_CHANNELS || Get32(bytes + 20) > size - HEADER_SIZE) {
+        return false;
+    }
+
+    this->data = bytes;
+    this->size = HEADER_SIZE + Get32(bytes + 20);
+    offset = HEADER_SIZE;
+    numChannels = bytes[6];
+    seed = Get32(bytes + 8);
+    stepRate = Get32(bytes + 12);
+    tickCount = Get32(bytes + 16);
+    tick = 0;
+    run = 0;
+    for (Sample& sample : last) {
+        sample = {};
+    }
+
+    return true;
+}
+
+uint32_t InputLog::Reader::GetSeed() const
+{
+    return seed;
+}
+
+uint32_t InputLog::Reader::GetStepRate() const
+{
+    return stepRate;
+}
+
+uint32_t InputLog::Reader::GetNumChannels() const
+{
+    return numChannels;
+}
+
+uint32_t InputLog::Reader::GetTickCount() const
+{
+    return tickCount;
+}
+
+uint32_t InputLog::Reader::GetTick() const
+{
+    return tick;
+}
+
+bool InputLog::Reader::Next(Sample* samples)
+{
+    if (tick >= tickCount) {
+        return false;
+    }
+
+    // Start the next run or change if the last one is used up
+    if (!run) {
+        if (offset >= size) {
+            return false;
+        }
+
+        uint8_t tag = data[offset++];
+        if (tag < TAG_CHANGED) {
+            run = tag + 1;
+        } else {
+            for (uint32_t i = 0; i < numChannels; ++i) {
+                if (!(tag & (1 << i))) {
+                    continue;
+                }
+
+                if (offset >= size) {
+                    return false;
+                }
+
+                Sample& sample = last[i];
+                uint8_t fields = data[offset++];
+                uint32_t value = 0;
+                if (fields & FIELD_CONNECTED) {
+                    sample.connected = !sample.connected;
+                }
+                if (fields & FIELD_HOLD) {
+                    if (!ReadVarint(&value)) {
+                        return false;
+                    }
+                    sample.hold ^= value;
+                }
+                if (fields & FIELD_TRIGGER) {
+                    if (!ReadVarint(&sample.trigger)) {
+                        return false;
+                    }
+                }
+                if (fields & FIELD_RELEASE) {
+                    if (!ReadVarint(&sample.release)) {
+                        return false;
+                    }
+                }
+                for (uint32_t j = 0; j < 4; ++j) {
+                    if (fields & FIELD_STICK(j)) {
+                        if (!ReadVarint(&value)) {
+                            return false;
+                        }
+                        sample.sticks[j] += UnZigZag(value);
+                    }
+                }
+            }
+            run = 1;
+        }
+    }
+
+    for (uint32_t i = 0; i < numChannels; ++i) {
+        samples[i] = last[i];
+    }
+
+    run--;
+    tick++;
+    return true;
+}
+
+bool InputLog::Reader::ReadVarint(uint32_t* value)
+{
+    uint32_t result = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7) {
+        if (offset >= size) {
+            return false;
+        }
+
+        uint8_t byte = data[offset++];
+        result |= (uint32_t) (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+
+    return false;
+}
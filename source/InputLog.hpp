@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Compact log of the GamePad samples every simulation step saw, enough to replay a match.
+// The log is a header followed by the ticks, each either a run of ticks without changes or the
+// fields which changed on some channels since the tick before. Integers are little endian, so a
+// log written on the console can be mapped and read in place on Linux.
+class InputLog {
+public:
+    static constexpr uint32_t MAGIC = 0x474c4e49; // "INLG"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t HEADER_SIZE = 24;
+    static constexpr uint32_t MAX_CHANNELS = 4;
+
+    // The part of a sample which is logged, sticks are 16-bit fixed point
+    struct Sample {
+        bool connected;
+        uint32_t hold;
+        uint32_t trigger;
+        uint32_t release;
+        // Left x and y, right x and y
+        int16_t sticks[4];
+    };
+
+    static int16_t QuantizeStick(float value);
+
+    static float GetStickValue(int16_t value);
+
+    class Writer {
+    public:
+        Writer();
+
+        // Start a new log, it stops growing at maxSize
+        void Begin(uint32_t seed, uint32_t stepRate, uint32_t numChannels, uint32_t maxSize);
+
+        // Add the samples of all channels for the next tick, returns false once the log is full
+        bool Append(const Sample* samples);
+
+        // The log with the header updated, valid until the next Begin
+        std::vector<uint8_t> const& Finish();
+
+        uint32_t GetTickCount() const;
+
+    private:
+        void FlushRun();
+
+        std::vector<uint8_t> data;
+        uint32_t numChannels;
+        uint32_t maxSize;
+        uint32_t tickCount;
+        // Unchanged ticks which haven't been written yet
+        uint32_t run;
+        // Nothing is added anymore once a tick didn't fit, so replays never skip a tick
+        bool full;
+        Sample last[MAX_CHANNELS];
+    };
+
+    class Reader {
+    public:
+        Reader();
+
+        // The data isn't copied, it has to stay valid while reading
+        bool Open(const void* data, uint32_t size);
+
+        uint32_t GetSeed() const;
+
+        uint32_t GetStepRate() const;
+
+        uint32_t GetNumChannels() const;
+
+        uint32_t GetTickCount() const;
+
+        // Ticks read so far
+        uint32_t GetTick() const;
+
+        // The samples of all channels for the next tick, returns false at the end or if the log is broken
+        bool Next(Sample* samples);
+
+    private:
+        bool ReadVarint(uint32_t* value);
+
+        const uint8_t* data;
+        uint32_t size;
+        uint32_t offset;
+        uint32_t seed;
+        uint32_t stepRate;
+        uint32_t numChannels;
+        uint32_t tickCount;
+        uint32_t tick;
+        // Unchanged ticks left from the last run
+        uint32_t run;
+        Sample last[MAX_CHANNELS];
+    };
+};
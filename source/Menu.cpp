@@ -1,14 +1,11 @@
 #include "Menu.hpp"
 #include "SceneMgr.hpp"
+#include "Input.hpp"
 
-#include <vpad/input.h>
 #include <whb/proc.h>
 #include <sysapp/launch.h>
 #include <gx2/display.h>
 
-#include "background_png.h"
-#include "controls_png.h"
-
 Menu::Menu(SceneMgr* sceneMgr) :
     sceneMgr(sceneMgr),
     frameCount(0),
@@ -26,7 +23,7 @@ Menu::Menu(SceneMgr* sceneMgr) :
     drc1Text("Waiting for host to start game...", 48)
 {
     // Load the background
-    background = Sprite::FromPNG(background_png, background_png_size);
+    background = Sprite::FromAsset("background");
     // Fill the entire screen
     background->SetSize(Gfx::screenSpace);
     // Adjust from 1:1 to 16:9
@@ -41,7 +38,7 @@ Menu::Menu(SceneMgr* sceneMgr) :
         Gfx::screenSpace.y - version.GetSize().y));
 
     // Setup controls image
-    controls = Sprite::FromPNG(controls_png, controls_png_size);
+    controls = Sprite::FromAsset("controls");
     controls->SetCentered(true);
     controls->SetSize(Gfx::screenSpace / 2.0f);
     controls->SetPosition(glm::vec2(Gfx::screenSpace.x / 2, (Gfx::screenSpace.y + controls->GetSize().y) / 2));
@@ -87,7 +84,7 @@ void Menu::Update()
 
     // Menu can only be controlled by the host (Gamepad 0)
     VPADStatus status{};
-    VPADRead(VPAD_CHAN_0, &status, 1, nullptr);
+    Input::Read(VPAD_CHAN_0, &status);
 
     // Handle the confirm prompt
     if (confirmPromptOpened) {
@@ -113,6 +110,13 @@ void Menu::Update()
         }
     }
 
+    // Build the scene behind the selected option before it's picked
+    if (selected == 0) {
+        sceneMgr->Prewarm(SceneMgr::SCENE_GAME);
+    } else if (selected == 1) {
+        sceneMgr->Prewarm(SceneMgr::SCENE_DRC_PAIRING);
+    }
+
     // Handle selection
     if (status.trigger & (VPAD_BUTTON_A | VPAD_BUTTON_PLUS)) {
         switch (selected) {
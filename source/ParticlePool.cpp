@@ -0,0 +1,146 @@
+#include "ParticlePool.hpp"
+
+#include <algorithm>
+
+ParticlePool::ParticlePool() :
+    count(0),
+    bucketCounts()
+{
+}
+
+ParticlePool::~ParticlePool()
+{
+}
+
+bool ParticlePool::Spawn(glm::vec2 position, glm::vec2 velocity, float angle, uint32_t bucket, uint32_t timeLeft)
+{
+    if (count == CAPACITY || timeLeft == 0) {
+        return false;
+    }
+
+    uint32_t i = count++;
+    positionX[i] = position.x;
+    positionY[i] = position.y;
+    previousX[i] = position.x;
+    previousY[i] = position.y;
+    velocityX[i] = velocity.x;
+    velocityY[i] = velocity.y;
+    rotationC[i] = cos(glm::radians(angle));
+    rotationS[i] = sin(glm::radians(angle));
+    this->timeLeft[i] = std::min<uint32_t>(timeLeft, UINT16_MAX);
+    buckets[i] = std::min(bucket, NUM_BUCKETS - 1);
+    bucketCounts[buckets[i]]++;
+    return true;
+}
+
+void ParticlePool::Update()
+{
+    // No dependencies between particles, so this vectorizes
+    for (uint32_t i = 0; i < count; ++i) {
+        previousX[i] = positionX[i];
+        previousY[i] = positionY[i];
+        positionX[i] += velocityX[i];
+        positionY[i] += velocityY[i];
+        timeLeft[i]--;
+    }
+
+    // The moved in particle has to be checked as well, so only advance if this one stays
+    for (uint32_t i = 0; i < count;) {
+        if (timeLeft[i] == 0) {
+            Remove(i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void ParticlePool::Clear()
+{
+    count = 0;
+    std::fill(bucketCounts, bucketCounts + NUM_BUCKETS, 0);
+}
+
+uint32_t ParticlePool::GetCount() const
+{
+    return count;
+}
+
+const glm::vec2* ParticlePool::BuildQuads(Gfx* gfx, float size, float alpha) const
+{
+    if (count == 0) {
+        return nullptr;
+    }
+
+    // Particles are drawn as quads in world space
+    glm::vec2* vertices = (glm::vec2*) gfx->AllocTransient(count * 4 * sizeof(glm::vec2));
+    if (!vertices) {
+        return nullptr;
+    }
+
+    uint32_t bucketOffsets[NUM_BUCKETS];
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < NUM_BUCKETS; ++i) {
+        bucketOffsets[i] = offset;
+        offset += bucketCounts[i] * 4;
+    }
+
+    // Write the rotated quads sorted by bucket, the position is the top left corner
+    float halfSize = size / 2.0f;
+    for (uint32_t i = 0; i < count; ++i) {
+        glm::vec2* quad = &vertices[bucketOffsets[buckets[i]]];
+        bucketOffsets[buckets[i]] += 4;
+
+        glm::vec2 position = glm::mix(glm::vec2(previousX[i], previousY[i]), glm::vec2(positionX[i], positionY[i]), alpha);
+        glm::vec2 center = position + halfSize;
+        glm::vec2 right = glm::vec2(rotationC[i], rotationS[i]) * halfSize;
+        glm::vec2 down = glm::vec2(-rotationS[i], rotationC[i]) * halfSize;
+
+        quad[0] = center - right - down;
+        quad[1] = center + right - down;
+        quad[2] = center + right + down;
+        quad[3] = center - right + down;
+    }
+
+    return vertices;
+}
+
+void ParticlePool::Draw(Gfx* gfx, const glm::vec2* quads, glm::vec4 const* bucketColors) const
+{
+    if (!quads) {
+        return;
+    }
+
+    // Additive blending is order independent, so draw one batch per color
+    gfx->SetBlendMode(Gfx::BLEND_ADDITIVE);
+
+    glm::mat4 model = glm::mat4(1.0f);
+    gfx->SetModel(model);
+
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < NUM_BUCKETS; ++i) {
+        if (bucketCounts[i] > 0) {
+            gfx->Draw(nullptr, &quads[offset], bucketCounts[i] * 4, bucketColors[i], true);
+        }
+        offset += bucketCounts[i] * 4;
+    }
+
+    gfx->SetBlendMode(Gfx::BLEND_ALPHA);
+}
+
+void ParticlePool::Remove(uint32_t index)
+{
+    bucketCounts[buckets[index]]--;
+
+    // Move the last particle into the gap
+    uint32_t last = --count;
+    positionX[index] = positionX[last];
+    positionY[index] = positionY[last];
+    previousX[index] = previousX[last];
+    previousY[index] = previousY[last];
+    velocityX[index] = velocityX[last];
+    velocityY[index] = velocityY[last];
+    rotationC[index] = rotationC[last];
+    rotationS[index] = rotationS[last];
+    timeLeft[index] = timeLeft[last];
+    buckets[index] = buckets[last];
+}
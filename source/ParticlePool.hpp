@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Gfx.hpp"
+
+#include <cstdint>
+
+// Fixed capacity pool of untextured, square particles stored as structure of arrays.
+// Expired particles are replaced with the last one, so removing is constant time and the
+// live particles stay packed at the front. Particles are grouped into color buckets which
+// are drawn as one batch each, the rotation is fixed when spawning.
+class ParticlePool {
+public:
+    static constexpr uint32_t CAPACITY = 8192;
+    static constexpr uint32_t NUM_BUCKETS = 8;
+
+    ParticlePool();
+    virtual ~ParticlePool();
+
+    // Returns false if the pool is full, angle is in degrees
+    bool Spawn(glm::vec2 position, glm::vec2 velocity, float angle, uint32_t bucket, uint32_t timeLeft);
+
+    // Move all particles and remove the expired ones
+    void Update();
+
+    void Clear();
+
+    uint32_t GetCount() const;
+
+    // Write quads of the given size into transient memory, sorted by bucket. Positions are interpolated
+    // between the last two updates by alpha. Returns nullptr if there is nothing to draw.
+    const glm::vec2* BuildQuads(Gfx* gfx, float size, float alpha = 1.0f) const;
+
+    // Draw the quads of BuildQuads with additive blending, one color per bucket.
+    // They can be drawn several times until the pool is updated or the frame ends.
+    void Draw(Gfx* gfx, const glm::vec2* quads, glm::vec4 const* bucketColors) const;
+
+private:
+    void Remove(uint32_t index);
+
+    uint32_t count;
+    uint32_t bucketCounts[NUM_BUCKETS];
+
+    alignas(16) float positionX[CAPACITY];
+    alignas(16) float positionY[CAPACITY];
+    // Positions before the last update, drawing interpolates between them
+    alignas(16) float previousX[CAPACITY];
+    alignas(16) float previousY[CAPACITY];
+    alignas(16) float velocityX[CAPACITY];
+    alignas(16) float velocityY[CAPACITY];
+    // Rotation as cos and sin
+    alignas(16) float rotationC[CAPACITY];
+    alignas(16) float rotationS[CAPACITY];
+    alignas(16) uint16_t timeLeft[CAPACITY];
+    alignas(16) uint8_t buckets[CAPACITY];
+};
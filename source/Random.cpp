@@ -0,0 +1,99 @@
+#include "Random.hpp"
+
+static uint32_t sharedSeed = 0;
+static Random sharedStreams[Random::NUM_STREAMS];
+
+static uint32_t RotateLeft(uint32_t value, int bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+void Random::SetSeed(uint32_t seed)
+{
+    sharedSeed = seed;
+    for (uint32_t i = 0; i < NUM_STREAMS; ++i) {
+        sharedStreams[i].Seed(seed, i);
+    }
+}
+
+uint32_t Random::GetSeed()
+{
+    return sharedSeed;
+}
+
+Random& Random::GetStream(Stream stream)
+{
+    return sharedStreams[stream];
+}
+
+Random::Random(uint32_t seed, uint32_t stream)
+{
+    Seed(seed, stream);
+}
+
+void Random::Seed(uint32_t seed, uint32_t stream)
+{
+    key = Hash(seed, stream);
+    counter = 0;
+
+    // Spread the key over the state, which must not be all zero
+    for (uint32_t i = 0; i < 4; ++i) {
+        state[i] = Hash(key, 0x80000000u + i);
+    }
+    if (!(state[0] | state[1] | state[2] | state[3])) {
+        state[0] = 1;
+    }
+}
+
+uint32_t Random::Next()
+{
+    // xoshiro128**
+    uint32_t result = RotateLeft(state[1] * 5, 7) * 9;
+    uint32_t t = state[1] << 9;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = RotateLeft(state[3], 11);
+
+    return result;
+}
+
+float Random::Float(float min, float max)
+{
+    return min + ToFloat(Next()) * (max - min);
+}
+
+uint32_t Random::Range(uint32_t min, uint32_t max)
+{
+    // Multiply instead of modulo, the bias is negligible for small ranges
+    return min + (uint32_t) (((uint64_t) Next() * (max - min)) >> 32);
+}
+
+void Random::Floats(float* values, uint32_t count, float min, float max)
+{
+    float scale = max - min;
+    for (uint32_t i = 0; i < count; ++i) {
+        values[i] = min + ToFloat(Hash(key, counter + i)) * scale;
+    }
+    counter += count;
+}
+
+uint32_t Random::Hash(uint32_t key, uint32_t counter)
+{
+    // Weyl sequence through a 32-bit integer hash with low bias
+    uint32_t x = key + counter * 0x9e3779b9u;
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float Random::ToFloat(uint32_t value)
+{
+    return (value >> 8) * (1.0f / 16777216.0f);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+// Small, fast random number generators which replace rand().
+// Every system draws from its own stream, so for example effects can change without changing
+// where players spawn, and all streams are derived from one seed, so the same seed and the same
+// inputs give the same match. A stream is an xoshiro128** generator for single values and a
+// counter based hash for batches, which doesn't carry state from one value to the next and
+// vectorizes. The shared streams belong to the render thread, other threads create their own.
+class Random {
+public:
+    enum Stream {
+        // Gameplay, like spawn positions
+        STREAM_GAME,
+        // Visual effects
+        STREAM_PARTICLES,
+
+        NUM_STREAMS,
+    };
+
+    // Reseed all shared streams
+    static void SetSeed(uint32_t seed);
+
+    static uint32_t GetSeed();
+
+    static Random& GetStream(Stream stream);
+
+    // Different stream numbers give independent sequences for the same seed
+    Random(uint32_t seed = 0, uint32_t stream = 0);
+
+    void Seed(uint32_t seed, uint32_t stream);
+
+    uint32_t Next();
+
+    // Uniform in [min, max)
+    float Float(float min = 0.0f, float max = 1.0f);
+
+    // Uniform in [min, max), max has to be larger than min
+    uint32_t Range(uint32_t min, uint32_t max);
+
+    // Fill values with floats uniform in [min, max)
+    void Floats(float* values, uint32_t count, float min = 0.0f, float max = 1.0f);
+
+    // Value number counter of the sequence key, the same arguments always give the same value
+    static uint32_t Hash(uint32_t key, uint32_t counter);
+
+private:
+    // Upper 24 bits as a float in [0, 1)
+    static float ToFloat(uint32_t value);
+
+    uint32_t state[4];
+
+    // Batches use the hash of key and an increasing counter
+    uint32_t key;
+    uint32_t counter;
+};
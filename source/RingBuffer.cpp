@@ -0,0 +1,202 @@
+#include "RingBuffer.hpp"
+
+#ifdef __WIIU__
+#include <gx2/event.h>
+#endif
+
+#include <malloc.h>
+#include <string.h>
+
+#define ALIGN_UP(x, align) (((x) + ((align) - 1)) & ~((align) - 1))
+
+// Base alignment of the buffer, this is the largest alignment Alloc supports
+#define BUFFER_ALIGNMENT 0x100
+
+RingBuffer::RingBuffer() :
+    buffer(nullptr),
+    policy(OVERFLOW_WAIT),
+    head(0),
+    tail(0),
+    frameBytes(0),
+    fenceStart(0),
+    fenceCount(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+RingBuffer::~RingBuffer()
+{
+    Finalize();
+}
+
+bool RingBuffer::Initialize(uint32_t capacity, OverflowPolicy policy)
+{
+    // Allocate from the default heap which is in MEM2
+    buffer = (uint8_t*) memalign(BUFFER_ALIGNMENT, capacity);
+    if (!buffer) {
+        return false;
+    }
+
+    this->policy = policy;
+
+    head = 0;
+    tail = 0;
+    frameBytes = 0;
+    fenceStart = 0;
+    fenceCount = 0;
+
+    memset(&stats, 0, sizeof(stats));
+    stats.capacity = capacity;
+
+    return true;
+}
+
+void RingBuffer::Finalize()
+{
+    free(buffer);
+    buffer = nullptr;
+}
+
+void* RingBuffer::Alloc(uint32_t size, uint32_t align)
+{
+    if (!buffer || size > stats.capacity || align > BUFFER_ALIGNMENT) {
+        return nullptr;
+    }
+
+    void* ptr = AllocContiguous(size, align);
+    if (ptr) {
+        return ptr;
+    }
+
+    stats.overflowCount++;
+    if (policy == OVERFLOW_FAIL) {
+        return nullptr;
+    }
+
+    // Wait for older frames to retire until there is enough space
+    while (!ptr) {
+        if (!WaitOldestFence()) {
+            // The current frame alone exceeds the capacity
+            return nullptr;
+        }
+
+        ptr = AllocContiguous(size, align);
+    }
+
+    return ptr;
+}
+
+void RingBuffer::EndFrame(uint64_t timestamp)
+{
+    stats.lastFrameBytes = frameBytes;
+
+    // Nothing to reclaim if the frame didn't allocate anything
+    if (frameBytes == 0) {
+        return;
+    }
+
+    // Make room if too many frames are still in flight
+    if (fenceCount == MAX_FENCES) {
+        WaitOldestFence();
+    }
+
+    Fence& fence = fences[(fenceStart + fenceCount) % MAX_FENCES];
+    fence.timestamp = timestamp;
+    fence.end = head;
+    fence.bytes = frameBytes;
+    fenceCount++;
+
+    frameBytes = 0;
+}
+
+void RingBuffer::Reclaim()
+{
+    if (fenceCount == 0) {
+        return;
+    }
+
+#ifdef __WIIU__
+    uint64_t retired = GX2GetRetiredTimeStamp();
+#else
+    // Host backends consume the data before the frame ends
+    uint64_t retired = UINT64_MAX;
+#endif
+    while (fenceCount > 0) {
+        Fence& fence = fences[fenceStart];
+        if (fence.timestamp > retired) {
+            break;
+        }
+
+        tail = fence.end;
+        stats.inUse -= fence.bytes;
+
+        fenceStart = (fenceStart + 1) % MAX_FENCES;
+        fenceCount--;
+    }
+}
+
+bool RingBuffer::Contains(const void* ptr) const
+{
+    return buffer && (const uint8_t*) ptr >= buffer && (const uint8_t*) ptr < buffer + stats.capacity;
+}
+
+RingBuffer::Stats const& RingBuffer::GetStats() const
+{
+    return stats;
+}
+
+void* RingBuffer::AllocContiguous(uint32_t size, uint32_t align)
+{
+    // Start from the beginning if everything has been reclaimed
+    if (stats.inUse == 0) {
+        head = 0;
+        tail = 0;
+    }
+
+    uint32_t offset = ALIGN_UP(head, align);
+    uint32_t used;
+
+    if (stats.inUse == 0 || head > tail) {
+        // Free space is between head and the end, and between the start and tail
+        if (offset + size <= stats.capacity) {
+            used = (offset - head) + size;
+        } else if (size <= tail) {
+            // Wrap around, the skipped space at the end belongs to this frame
+            used = (stats.capacity - head) + size;
+            offset = 0;
+        } else {
+            return nullptr;
+        }
+    } else {
+        // Free space is between head and tail
+        if (offset + size <= tail) {
+            used = (offset - head) + size;
+        } else {
+            return nullptr;
+        }
+    }
+
+    head = offset + size;
+    frameBytes += used;
+    stats.inUse += used;
+    if (stats.inUse > stats.highWaterMark) {
+        stats.highWaterMark = stats.inUse;
+    }
+
+    return buffer + offset;
+}
+
+bool RingBuffer::WaitOldestFence()
+{
+    if (fenceCount == 0) {
+        return false;
+    }
+
+    stats.waitCount++;
+#ifdef __WIIU__
+    GX2WaitTimeStamp(fences[fenceStart].timestamp);
+#endif
+    Reclaim();
+
+    return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+
+// GPU visible ring buffer in MEM2 for per-frame transient vertex and uniform data.
+// Memory handed out during a frame is reclaimed once the GPU retired the timestamp
+// which was recorded when that frame was submitted.
+class RingBuffer {
+public:
+    enum OverflowPolicy {
+        // Block until the GPU retired enough memory
+        OVERFLOW_WAIT,
+        // Return nullptr and let the caller skip the draw
+        OVERFLOW_FAIL,
+    };
+
+    struct Stats {
+        uint32_t capacity;
+        // Bytes currently owned by frames in flight
+        uint32_t inUse;
+        // Maximum of inUse since initialization
+        uint32_t highWaterMark;
+        // Bytes allocated during the last finished frame
+        uint32_t lastFrameBytes;
+        // Allocations which didn't fit without waiting for the GPU
+        uint32_t overflowCount;
+        // Times we had to block on a GPU timestamp
+        uint32_t waitCount;
+    };
+
+    RingBuffer();
+    virtual ~RingBuffer();
+
+    bool Initialize(uint32_t capacity, OverflowPolicy policy = OVERFLOW_WAIT);
+
+    void Finalize();
+
+    void* Alloc(uint32_t size, uint32_t align);
+
+    // Mark the end of the current frame, the memory is reclaimed once the GPU reaches timestamp
+    void EndFrame(uint64_t timestamp);
+
+    // Release all memory the GPU is done with
+    void Reclaim();
+
+    bool Contains(const void* ptr) const;
+
+    Stats const& GetStats() const;
+
+private:
+    void* AllocContiguous(uint32_t size, uint32_t align);
+
+    bool WaitOldestFence();
+
+    static constexpr uint32_t MAX_FENCES = 8;
+
+    struct Fence {
+        uint64_t timestamp;
+        uint32_t end;
+        uint32_t bytes;
+    };
+
+    uint8_t* buffer;
+    OverflowPolicy policy;
+
+    // Write offset and start of the oldest data which might still be used by the GPU
+    uint32_t head;
+    uint32_t tail;
+    uint32_t frameBytes;
+
+    Fence fences[MAX_FENCES];
+    uint32_t fenceStart;
+    uint32_t fenceCount;
+
+    Stats stats;
+};
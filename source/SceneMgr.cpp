@@ -3,32 +3,99 @@
 #include "Menu.hpp"
 #include "Game.hpp"
 #include "DrcPairing.hpp"
+#include "Input.hpp"
 
-SceneMgr::SceneMgr()
+SceneMgr::SceneMgr() :
+    menu(nullptr),
+    game(nullptr),
+    drcPairing(nullptr),
+    accumulator(0),
+    frameCount(0),
+    lastUsed(),
+    prewarm()
 {
-    // Create scenes
-    menu = new Menu(this);
-    game = new Game(this);
-    drcPairing = new DrcPairing(this);
-
-    // Start with the menu scene
+    // Start with the menu scene, the others are created once they're needed
     currentScene = SCENE_MENU;
+    Load(SCENE_MENU);
 }
 
 SceneMgr::~SceneMgr()
 {
-    delete drcPairing;
-    delete game;
-    delete menu;
+    Unload(SCENE_DRC_PAIRING);
+    Unload(SCENE_GAME);
+    Unload(SCENE_MENU);
 }
 
 void SceneMgr::SetScene(Scene scene)
 {
+    // This is called from the update of the current scene, which keeps running until it returns
+    Load(scene);
+    prewarm[scene] = false;
+    lastUsed[scene] = frameCount;
     currentScene = scene;
 }
 
+void SceneMgr::Prewarm(Scene scene)
+{
+    if (!IsLoaded(scene)) {
+        prewarm[scene] = true;
+    }
+
+    // Keep it around while it's still likely needed
+    lastUsed[scene] = frameCount;
+}
+
+bool SceneMgr::IsLoaded(Scene scene) const
+{
+    switch (scene) {
+    case SCENE_MENU:
+        return menu != nullptr;
+    case SCENE_GAME:
+        return game != nullptr;
+    case SCENE_DRC_PAIRING:
+        return drcPairing != nullptr;
+    default:
+        return false;
+    }
+}
+
+uint32_t SceneMgr::Advance(OSTime elapsed)
+{
+    OSTime step = OSSecondsToTicks(1) / STEP_RATE;
+    accumulator += elapsed;
+
+    uint32_t steps = 0;
+    while (accumulator >= step && steps < MAX_STEPS_PER_FRAME) {
+        Input::BeginStep();
+        Update();
+        Input::EndStep();
+        accumulator -= step;
+        steps++;
+    }
+
+    // Drop the steps which couldn't be caught up on
+    accumulator %= step;
+
+    // Only the game moves things which need to be interpolated
+    if (currentScene == SCENE_GAME) {
+        game->Interpolate((float) accumulator / step);
+    }
+
+    return steps;
+}
+
 void SceneMgr::Update()
 {
+    frameCount++;
+    lastUsed[currentScene] = frameCount;
+
+    // Release scenes which weren't used for a while, never the current one
+    for (int i = 0; i < NUM_SCENES; ++i) {
+        if (i != currentScene && IsLoaded((Scene) i) && frameCount - lastUsed[i] > RELEASE_STEPS) {
+            Unload((Scene) i);
+        }
+    }
+
     switch (currentScene) {
     case SCENE_MENU:
         menu->Update();
@@ -39,6 +106,19 @@ void SceneMgr::Update()
     case SCENE_DRC_PAIRING:
         drcPairing->Update();
         break;
+    default:
+        break;
+    }
+
+    // Build one prewarmed scene after the update. Scenes create text and textures, which is only
+    // safe on the render thread, so this spreads the work over frames instead of another core.
+    // The first frame is left alone so the first scene shows up right away.
+    for (int i = 0; i < NUM_SCENES && frameCount > 1; ++i) {
+        if (prewarm[i]) {
+            prewarm[i] = false;
+            Load((Scene) i);
+            break;
+        }
     }
 }
 
@@ -54,5 +134,50 @@ void SceneMgr::DrawScene(Gfx* gfx, Gfx::Target target)
     case SCENE_DRC_PAIRING:
         drcPairing->DrawScene(gfx, target);
         break;
+    default:
+        break;
+    }
+}
+
+void SceneMgr::Load(Scene scene)
+{
+    switch (scene) {
+    case SCENE_MENU:
+        if (!menu) {
+            menu = new Menu(this);
+        }
+        break;
+    case SCENE_GAME:
+        if (!game) {
+            game = new Game(this);
+        }
+        break;
+    case SCENE_DRC_PAIRING:
+        if (!drcPairing) {
+            drcPairing = new DrcPairing(this);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void SceneMgr::Unload(Scene scene)
+{
+    switch (scene) {
+    case SCENE_MENU:
+        delete menu;
+        menu = nullptr;
+        break;
+    case SCENE_GAME:
+        delete game;
+        game = nullptr;
+        break;
+    case SCENE_DRC_PAIRING:
+        delete drcPairing;
+        drcPairing = nullptr;
+        break;
+    default:
+        break;
     }
 }
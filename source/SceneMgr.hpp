@@ -2,27 +2,70 @@
 
 #include "Gfx.hpp"
 
+#include <coreinit/time.h>
+
+#include <cstdint>
+
+// Scenes are created the first time they're needed and released again after they haven't been
+// used for a while. Scenes which are likely needed next can be prewarmed, they're then built
+// between frames so switching to them doesn't stall.
+// Scenes are simulated in fixed steps, so the game runs at the same speed however long a
+// frame takes. Speeds, timers and lifetimes of the scenes are measured in steps.
 class SceneMgr {
 public:
     enum Scene {
         SCENE_MENU,
         SCENE_GAME,
         SCENE_DRC_PAIRING,
+
+        NUM_SCENES,
     };
 
+    // Simulation steps per second
+    static constexpr uint32_t STEP_RATE = 60;
+    // Steps one frame may catch up on, after longer stalls the game slows down instead
+    static constexpr uint32_t MAX_STEPS_PER_FRAME = 4;
+
+    // Unused scenes are released after about a minute
+    static constexpr uint32_t RELEASE_STEPS = STEP_RATE * 60;
+
     SceneMgr();
     virtual ~SceneMgr();
 
+    // Switches to the scene after the current update, it's created right away if it wasn't prewarmed
     void SetScene(Scene scene);
 
+    // Build the scene at the end of a later frame, one scene per frame
+    void Prewarm(Scene scene);
+
+    bool IsLoaded(Scene scene) const;
+
+    // Run the steps which fit into the time since the last frame, then place the scene between
+    // the last two steps for drawing. Returns the number of steps run.
+    uint32_t Advance(OSTime elapsed);
+
+    // A single step
     void Update();
 
     void DrawScene(Gfx* gfx, Gfx::Target target);
 
 protected:
+    void Load(Scene scene);
+
+    void Unload(Scene scene);
+
     Scene currentScene;
 
     class Menu* menu;
     class Game* game;
     class DrcPairing* drcPairing;
+
+    // Time which is left over for the next step
+    OSTime accumulator;
+
+    // Steps so far
+    uint32_t frameCount;
+    // Step each scene was last shown or prewarmed in
+    uint32_t lastUsed[NUM_SCENES];
+    bool prewarm[NUM_SCENES];
 };
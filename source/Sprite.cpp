@@ -1,6 +1,7 @@
 #include "Sprite.hpp"
+#include "BootProfiler.hpp"
 
-#include <png.h>
+#include <string.h>
 
 // Aligned vertex buffers which can be directly sent to the GPU
 static float colorVertices[][2] __attribute__ ((aligned (GX2_VERTEX_BUFFER_ALIGNMENT))) = {
@@ -21,79 +22,34 @@ static const float textureVertices[][4] __attribute__ ((aligned (GX2_VERTEX_BUFF
     { 1.0f, 0.0f, 1.0f, 0.0f, },
 };
 
-static void png_read_data(png_structp png_ptr, png_bytep outBytes, png_size_t byteCountToRead)
-{
-    void** data = (void**) png_get_io_ptr(png_ptr);
+// Cooked textures, owned by the pack
+static AssetPack assetPack;
 
-    memcpy(outBytes, *data, byteCountToRead);
-    *((uint8_t**) data) += byteCountToRead;
+bool Sprite::OpenAssets(const void* data, uint32_t size)
+{
+    return assetPack.Open(data, size);
 }
 
-Sprite* Sprite::FromPNG(const void* data, uint32_t size)
+void Sprite::CloseAssets()
 {
-    Sprite* s = new Sprite();
-
-    // Setup png read and info struct
-    png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-    if (!png_ptr) {
-        delete s;
-        return nullptr;
-    }
-
-    png_infop info_ptr = png_create_info_struct(png_ptr);
-    if (!info_ptr) {
-        png_destroy_read_struct(&png_ptr, nullptr, nullptr);
-        delete s;
-        return nullptr;
-    }
-
-    // Set read function and info
-    png_set_read_fn(png_ptr, (void *) &data, png_read_data);
-    png_read_info(png_ptr, info_ptr);
-
-    // Read the IHDR
-    png_uint_32 width = 0;
-    png_uint_32 height = 0;
-    int bitDepth = 0;
-    int colorType = -1;
-    if (png_get_IHDR(png_ptr, info_ptr, &width, &height, &bitDepth, &colorType, nullptr, nullptr, nullptr) != 1) {
-        png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
-        delete s;
-        return nullptr;
-    }
+    assetPack.Close();
+}
 
-    // convert RGB data to RGBA
-    if (colorType == PNG_COLOR_TYPE_RGB) {
-        png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
-    }
+Sprite* Sprite::FromAsset(const char* name)
+{
+    BootProfiler::Scope profile("FromAsset", name);
 
-    // Create the texture
-    Gfx::Texture* tex = Gfx::NewTexture(glm::uvec2(width, height));
+    Gfx::Texture* tex = assetPack.GetTexture(name);
     if (!tex) {
-        png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
-        delete s;
         return nullptr;
     }
 
-    s->SetTexture(tex, true);
-
-    // Read the png data into the texture
-    uint32_t pitch = tex->GetPitch();
-    uint8_t* textureData = (uint8_t*) tex->Lock();
-    for (png_uint_32 y = 0; y < height; y++) {
-        png_read_row(png_ptr, (png_bytep) textureData + (y * pitch * 4), nullptr);
-    }
-    tex->Unlock();
-
-    // Cleanup
-    png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
-
-    return s;
+    return new Sprite(tex);
 }
 
 Sprite::Sprite(glm::vec2 position, glm::vec2 size, float angle, glm::vec4 color) :
-    deleteTexture(false),
     texture(nullptr),
+    sampler{ glm::vec2(0.0f), glm::vec2(1.0f), false, true },
     position(position),
     size(size),
     scale(1.0f),
@@ -110,8 +66,8 @@ Sprite::Sprite(glm::vec2 position, glm::vec2 size, float angle, glm::vec4 color)
 }
 
 Sprite::Sprite(Gfx::Texture* texture, glm::vec2 position, float angle, glm::vec4 color) :
-    deleteTexture(false),
     texture(texture),
+    sampler{ glm::vec2(0.0f), glm::vec2(1.0f), false, true },
     position(position),
     scale(1.0f),
     angle(angle),
@@ -125,9 +81,6 @@ Sprite::Sprite(Gfx::Texture* texture, glm::vec2 position, float angle, glm::vec4
 
 Sprite::~Sprite()
 {
-    if (texture && deleteTexture) {
-        texture->Delete();
-    }
 }
 
 void Sprite::SetTexture(Gfx::Texture* texture, bool updateSize)
@@ -185,23 +138,22 @@ void Sprite::SetVisible(bool visible)
 
 void Sprite::SetUVOffset(glm::vec2 off)
 {
-    if (texture) {
-        texture->SetUVOffset(off);
-    }
+    sampler.uvOffset = off;
 }
 
 void Sprite::SetUVScale(glm::vec2 scale)
 {
-    if (texture) {
-        texture->SetUVScale(scale);
-    }
+    sampler.uvScale = scale;
 }
 
 void Sprite::SetLinearFilter(bool linear)
 {
-    if (texture) {
-        texture->SetLinearFilter(linear);
-    }
+    sampler.linearFilter = linear;
+}
+
+void Sprite::SetClamp(bool clamp)
+{
+    sampler.clamp = clamp;
 }
 
 glm::vec2 const& Sprite::GetPosition() const
@@ -249,7 +201,7 @@ void Sprite::Draw(Gfx* gfx)
 
     // draw the sprite
     if (texture) {
-        gfx->Draw(texture, textureVertices, 6, color);
+        gfx->Draw(texture, textureVertices, 6, color, false, &sampler);
     } else {
         gfx->Draw(nullptr, colorVertices, 6, color);
     }
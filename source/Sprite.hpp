@@ -1,10 +1,17 @@
 #pragma once
 
 #include "Gfx.hpp"
+#include "AssetPack.hpp"
 
 class Sprite {
 public:
-    static Sprite* FromPNG(const void* data, uint32_t size);
+    // Use the textures of a cooked asset pack, data has to stay valid until CloseAssets
+    static bool OpenAssets(const void* data, uint32_t size);
+
+    static void CloseAssets();
+
+    // Sprite with a texture from the asset pack, nullptr if there is no such asset
+    static Sprite* FromAsset(const char* name);
 
 public:
     Sprite(glm::vec2 position = glm::vec2(), glm::vec2 size = glm::vec2(), float angle = 0.0f, glm::vec4 color = glm::vec4(1.0f));
@@ -33,6 +40,8 @@ public:
 
     void SetLinearFilter(bool linear);
 
+    void SetClamp(bool clamp);
+
     glm::vec2 const& GetPosition() const;
 
     glm::vec2 const& GetSize() const;
@@ -50,9 +59,11 @@ public:
 protected:
     void UpdateModel();
 
-    bool deleteTexture;
     Gfx::Texture* texture;
 
+    // UV and filtering of this sprite, the texture might be shared
+    Gfx::SamplerState sampler;
+
     glm::mat4 model;
 
     glm::vec2 position;
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Fixed size queue between exactly one producer and one consumer thread without locks.
+// The producer only writes the tail and the consumer only the head, each publishes its
+// index with release ordering after touching the slot.
+template <typename T, uint32_t SIZE>
+class SpscQueue {
+    static_assert((SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+public:
+    SpscQueue() :
+        head(0),
+        tail(0)
+    {
+    }
+
+    // Producer side, returns false if the queue is full
+    bool Push(T const& item)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == SIZE) {
+            return false;
+        }
+
+        items[t & (SIZE - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, returns false if the queue is empty
+    bool Pop(T* item)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        *item = items[h & (SIZE - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T items[SIZE];
+
+    // Both sides write their own index only, keep them on separate cache lines
+    alignas(64) std::atomic<uint32_t> head;
+    alignas(64) std::atomic<uint32_t> tail;
+};
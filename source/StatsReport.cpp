@@ -0,0 +1,102 @@
+#include "StatsReport.hpp"
+#include "Text.hpp"
+
+#include <coreinit/debug.h>
+
+#include <algorithm>
+
+static uint32_t interval = 0;
+static uint32_t frames = 0;
+
+// Sums and maximums of the frames since the last report
+static float cpuMsSum = 0.0f;
+static float cpuMsMax = 0.0f;
+static float gpuMsSum = 0.0f;
+static float gpuMsMax = 0.0f;
+static float swapWaitMsSum = 0.0f;
+static float targetGpuMsSum[Gfx::NUM_TARGETS];
+
+static const char* const targetNames[] = { "tv", "drc0", "drc1" };
+
+void StatsReport::SetInterval(uint32_t frames)
+{
+    interval = frames;
+}
+
+void StatsReport::Update(Gfx* gfx, AssetLoader const* loader)
+{
+    if (!interval) {
+        return;
+    }
+
+    Gfx::FrameStats const& stats = gfx->GetFrameStats();
+    cpuMsSum += stats.cpuFrameMs;
+    cpuMsMax = std::max(cpuMsMax, stats.cpuFrameMs);
+    gpuMsSum += stats.gpuFrameMs;
+    gpuMsMax = std::max(gpuMsMax, stats.gpuFrameMs);
+    swapWaitMsSum += stats.swapWaitMs;
+    for (int i = 0; i < Gfx::NUM_TARGETS; ++i) {
+        targetGpuMsSum[i] += stats.targetGpuMs[i];
+    }
+
+    if (++frames < interval) {
+        return;
+    }
+
+    Report(gfx, loader);
+
+    frames = 0;
+    cpuMsSum = cpuMsMax = 0.0f;
+    gpuMsSum = gpuMsMax = 0.0f;
+    swapWaitMsSum = 0.0f;
+    for (float& ms : targetGpuMsSum) {
+        ms = 0.0f;
+    }
+}
+
+void StatsReport::Report(Gfx* gfx, AssetLoader const* loader)
+{
+    Gfx::FrameStats const& stats = gfx->GetFrameStats();
+    float cpuMs = cpuMsSum / frames;
+    float gpuMs = gpuMsSum / frames;
+
+    // The side which takes longer limits the frame rate
+    OSReport("frames: cpu %.2f ms (max %.2f), gpu %.2f ms (max %.2f), swap wait %.2f ms, %s bound\n",
+        cpuMs, cpuMsMax, gpuMs, gpuMsMax, swapWaitMsSum / frames, gpuMs > cpuMs ? "gpu" : "cpu");
+    for (int i = 0; i < Gfx::NUM_TARGETS; ++i) {
+        OSReport("  %-4s gpu %.2f ms, %u draws, %u vertices\n", targetNames[i], targetGpuMsSum[i] / frames,
+            stats.drawCalls[i], stats.vertices[i]);
+    }
+    OSReport("  %u shader changes, %u blend changes\n", stats.shaderChanges, stats.blendChanges);
+
+    // Fragments per pixel of the last counted frame
+    if (gfx->IsOverdrawMode()) {
+        for (int i = 0; i < Gfx::NUM_TARGETS; ++i) {
+            OSReport("  %-4s overdraw %.2f average, %u max\n", targetNames[i], stats.overdrawAverage[i], stats.overdrawMax[i]);
+        }
+    }
+
+    RingBuffer::Stats const& transient = gfx->GetTransientStats();
+    OSReport("transient: %u of %u bytes last frame, high water %u, %u overflows, %u waits\n", transient.lastFrameBytes,
+        transient.capacity, transient.highWaterMark, transient.overflowCount, transient.waitCount);
+
+#ifdef DIAGNOSTICS
+    FrameCapture::Stats capture = gfx->GetCaptureStats();
+    OSReport("captures: %u written, %u dropped, %u failed, last %.1f ms\n", capture.written, capture.dropped,
+        capture.failed, capture.lastEncodeMs);
+#endif
+
+    GlyphAtlas::Stats const& atlas = Text::GetAtlasStats(false);
+    GlyphAtlas::Stats const& sdfAtlas = Text::GetAtlasStats(true);
+    TextCache::Stats const& textCache = Text::GetCacheStats();
+    GlyphRasterizer::Stats rasterizer = Text::GetRasterizerStats();
+    OSReport("glyphs: %u (%u sdf), %u rasterized, %u evictions, worker %u rendered, %u backlogged, last %.2f ms\n",
+        atlas.glyphs, sdfAtlas.glyphs, atlas.rasterized + sdfAtlas.rasterized, atlas.evictions + sdfAtlas.evictions,
+        rasterizer.rendered, rasterizer.backlogged, rasterizer.lastRenderMs);
+    OSReport("texts: %u entries (%u unused), %u hits, %u misses, %u layouts\n", textCache.entries, textCache.unused,
+        textCache.hits, textCache.misses, textCache.layouts);
+
+    AssetLoader::Stats assets = loader->GetStats();
+    OSReport("assets: %u loaded, %u fallbacks, %u failed, %u canceled, %u bytes in %.1f ms, pool %u bytes\n", assets.loaded,
+        assets.fallbacks, assets.failed, assets.canceled, assets.bytesRead, assets.readMs, assets.poolBytes);
+}
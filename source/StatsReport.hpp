@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Gfx.hpp"
+#include "AssetLoader.hpp"
+
+#include <cstdint>
+
+// Prints the counters of the renderer, caches and loaders every few seconds with OSReport,
+// so it can be seen on hardware whether frames are CPU or GPU bound and how the caches behave.
+// Frame times are averaged over the interval, everything else is the state at the time of the report.
+class StatsReport {
+public:
+    // Report every frames frames, 0 disables the report
+    static void SetInterval(uint32_t frames);
+
+    // Call once per frame after SwapBuffers
+    static void Update(Gfx* gfx, AssetLoader const* loader);
+
+private:
+    static void Report(Gfx* gfx, AssetLoader const* loader);
+};
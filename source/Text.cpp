@@ -1,7 +1,5 @@
 #include "Text.hpp"
-
-#include <locale>
-#include <codecvt>
+#include "BootProfiler.hpp"
 
 #include <coreinit/memory.h>
 
@@ -11,7 +9,20 @@
 static FT_Library ft_lib = nullptr;
 static FT_Face ft_face = nullptr;
 
-void Text::InitializeFont()
+// Size distance field glyphs are rendered at, other sizes are scaled from it
+#define SDF_TEXT_SIZE 64
+
+// Glyphs of all texts
+static GlyphAtlas glyphAtlas;
+static GlyphAtlas sdfAtlas;
+
+// Layouts of all texts
+static TextCache textCache;
+
+// Renders new glyphs of both atlases on another core
+static GlyphRasterizer rasterizer;
+
+void Text::InitializeFont(Gfx* gfx)
 {
     // Initialize freetype
     FT_Init_FreeType(&ft_lib);
@@ -25,18 +36,50 @@ void Text::InitializeFont()
     if (font && size) {
         FT_New_Memory_Face(ft_lib, (FT_Byte*) font, size, 0, &ft_face);
     }
+
+    // Fall back to rendering on this thread without a worker
+    GlyphRasterizer* worker = nullptr;
+    if (ft_face && rasterizer.Initialize(font, size)) {
+        worker = &rasterizer;
+    }
+
+    glyphAtlas.Initialize(gfx, ft_face, false, worker);
+    sdfAtlas.Initialize(gfx, ft_face, true, worker);
 }
 
 void Text::DeinitializeFont()
 {
+    rasterizer.Finalize();
+    textCache.Finalize();
+    glyphAtlas.Finalize();
+    sdfAtlas.Finalize();
+
     // Finish face and lib
     FT_Done_Face(ft_face);
     FT_Done_FreeType(ft_lib);
 }
 
+void Text::EndFrame()
+{
+    textCache.EndFrame();
+    glyphAtlas.EndFrame();
+    sdfAtlas.EndFrame();
+
+    // The GPU is done with the atlas textures, so nothing draws from the rows written here
+    GlyphRasterizer::Result result;
+    while (rasterizer.Receive(&result)) {
+        GlyphAtlas& atlas = result.request.sdf ? sdfAtlas : glyphAtlas;
+        atlas.AddGlyph(result);
+    }
+}
+
 Text::Text(std::string text, uint32_t textSize, glm::vec2 pos, glm::vec2 scale, float angle, glm::vec4 color) :
     Sprite(pos, glm::vec2(), angle, color),
-    texture(nullptr)
+    entry(nullptr),
+    shownEntry(nullptr),
+    sdf(false),
+    outlineWidth(0.0f),
+    outlineColor(0.0f)
 {
     this->textSize = textSize;
     SetText(text);
@@ -44,128 +87,138 @@ Text::Text(std::string text, uint32_t textSize, glm::vec2 pos, glm::vec2 scale,
 
 Text::~Text()
 {
-    texture->Delete();
+    textCache.Release(entry);
+    textCache.Release(shownEntry);
 }
 
 void Text::SetText(std::string text)
 {
-    // Convert the multi-byte string to a wstring
-    static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-    std::wstring wtext = converter.from_bytes(text);
+    // Only update if the text actually changed
+    if (this->text != text || !entry) {
+        this->text = text;
 
-    // Only redraw if the text actually changed
-    if (this->text != wtext) {
-        this->text = wtext;
-
-        RedrawTexture();
+        UpdateEntry();
     }
 }
 
 void Text::SetTextSize(uint32_t textSize)
 {
-    // Only redraw if the textSize actually changed
+    // Only update if the textSize actually changed
     if (this->textSize != textSize) {
         this->textSize = textSize;
 
-        RedrawTexture();
+        UpdateEntry();
     }
 }
 
-void Text::RedrawTexture()
+void Text::SetSDF(bool sdf)
 {
-    // Set the wanted text size
-    FT_Set_Pixel_Sizes(ft_face, 0, textSize);
-
-    // Calculate the necessary size for the texture
-    const uint32_t face_height = ft_face->size->metrics.height >> 6;
-
-    uint32_t width = 0;
-    bounds = glm::uvec2(0, face_height);
-    FT_GlyphSlot slot = ft_face->glyph;
-    for (const wchar_t charcode : text) {
-        if (charcode == '\n') {
-            if (width > bounds.x) {
-                bounds.x = width;
-                width = 0;
-            }
-            bounds.y += face_height;
-            continue;
-        }
-
-        FT_Load_Glyph(ft_face, FT_Get_Char_Index(ft_face, charcode), FT_LOAD_BITMAP_METRICS_ONLY);
-
-        width += slot->advance.x >> 6;
+    if (this->sdf != sdf) {
+        this->sdf = sdf;
+
+        UpdateEntry();
     }
+}
 
-    if (width > bounds.x) {
-        bounds.x = width;
+void Text::SetOutline(float width, glm::vec4 color)
+{
+    outlineWidth = width;
+    outlineColor = color;
+}
+
+void Text::Draw(Gfx* gfx)
+{
+    // No need to draw if the text is not visible
+    if (!visible || !entry) {
+        return;
     }
 
-    // Add some extra height for the bottom bearing
-    bounds.y += (ft_face->bbox.yMax - ft_face->bbox.yMin) >> 6;
-
-    if (texture) {
-        if (texture->GetSize() != bounds) {
-            // Re-create the already existing texture if it doesn't match the wanted size
-            texture->Delete();
-            texture = Gfx::NewTexture(bounds);
-        } else {
-            // Clear the already existing texture
-            void* data = texture->Lock();
-            memset(data, 0, texture->GetSize().y * texture->GetPitch() * 4);
-            texture->Unlock();
-        }
-    } else {
-        // Allocate the texture
-        texture = Gfx::NewTexture(bounds);
+    // The glyphs were evicted from the atlas, didn't fit or were rendered in the meantime
+    textCache.Update(entry);
+    if (entry->complete && shownEntry) {
+        textCache.Release(shownEntry);
+        shownEntry = nullptr;
+    }
+
+    TextCache::Entry* drawn = entry;
+    glm::mat4 drawModel = model;
+    if (shownEntry) {
+        textCache.Update(shownEntry);
+        drawn = shownEntry;
+
+        // Positions are normalized to the bounds of the previous text, the sprite already has the new size
+        drawModel = glm::scale(model, glm::vec3(glm::vec2(shownEntry->bounds) / glm::vec2(entry->bounds), 1.0f));
     }
 
-    if (!texture) {
+    if (!drawn->numVertices) {
         return;
     }
 
-    // Get pitch and lock the texture
-    uint32_t pitch = texture->GetPitch();
-    uint8_t* pixels = (uint8_t*) texture->Lock();
-
-    // Render the glyphs into the texture
-    FT_Vector pen = { 0, 0 };
-    for (const wchar_t charcode : text) {
-        if (charcode == '\n') {
-            pen.x = 0;
-            pen.y += ft_face->size->metrics.height >> 6;
-            continue;
-        }
-
-        FT_Load_Glyph(ft_face, FT_Get_Char_Index(ft_face, charcode), FT_LOAD_DEFAULT);
-        FT_Render_Glyph(slot, FT_RENDER_MODE_NORMAL);
-
-        const FT_Int x = pen.x + slot->bitmap_left;
-        const FT_Int y = (pen.y - slot->bitmap_top) + face_height;
-        const FT_Int x_max = x + slot->bitmap.width;
-        const FT_Int y_max = y + slot->bitmap.rows;
-
-        for (FT_Int i = x, p = 0; i < x_max; ++i, ++p) {
-            for (FT_Int j = y, q = 0; j < y_max; ++j, ++q) {
-                if (i < 0 || j < 0 || i >= (FT_Int) bounds.x || j >= (FT_Int) bounds.y) {
-                    continue;
-                }
-
-                uint32_t offset = (j * pitch + i) * 4;
-                pixels[offset    ] = 255;
-                pixels[offset + 1] = 255;
-                pixels[offset + 2] = 255;
-                pixels[offset + 3] = slot->bitmap.buffer[q * slot->bitmap.pitch + p];
-            }
-        }
-
-        pen.x += slot->advance.x >> 6;
+    Gfx::Texture* texture = drawn->atlas->GetTexture();
+    const TextCache::Vertex* data = drawn->vertices;
+    const uint32_t numVertices = drawn->numVertices;
+
+    gfx->SetModel(drawModel);
+
+    // Draw all glyphs at once
+    if (drawn->atlas != &sdfAtlas) {
+        gfx->Draw(texture, data, numVertices, color, true);
+        return;
     }
 
-    // Unlock the finished texture
-    texture->Unlock();
+    // Distance fields are cut off at the edge by the alpha test, the remaining fragments are opaque.
+    // 0.5 is the edge and the range covers SDF_SPREAD pixels of the glyph size in either direction.
+    const float pixelsPerUnit = GlyphAtlas::SDF_SPREAD * 2.0f * textSize / SDF_TEXT_SIZE;
+    gfx->SetBlendMode(Gfx::BLEND_OPAQUE);
+
+    if (outlineWidth > 0.0f) {
+        float ref = glm::max(0.5f - outlineWidth / pixelsPerUnit, 1.0f / 255.0f);
+        gfx->SetAlphaTest(true, ref * outlineColor.a);
+        gfx->Draw(texture, data, numVertices, outlineColor, true);
+    }
+
+    gfx->SetAlphaTest(true, 0.5f * color.a);
+    gfx->Draw(texture, data, numVertices, color, true);
+
+    gfx->SetAlphaTest(false);
+    gfx->SetBlendMode(Gfx::BLEND_ALPHA);
+}
+
+GlyphAtlas::Stats const& Text::GetAtlasStats(bool sdf)
+{
+    return sdf ? sdfAtlas.GetStats() : glyphAtlas.GetStats();
+}
+
+TextCache::Stats const& Text::GetCacheStats()
+{
+    return textCache.GetStats();
+}
+
+GlyphRasterizer::Stats Text::GetRasterizerStats()
+{
+    return rasterizer.GetStats();
+}
+
+GlyphAtlas& Text::GetAtlas() const
+{
+    return sdf ? sdfAtlas : glyphAtlas;
+}
+
+void Text::UpdateEntry()
+{
+    BootProfiler::Scope profile("Text", text.c_str());
+
+    // Distance field glyphs only exist in one size and are scaled
+    TextCache::Entry* newEntry = textCache.Acquire(text, textSize, &GetAtlas(), sdf ? SDF_TEXT_SIZE : textSize);
+
+    // Keep drawing what is on screen until the glyphs of the new text are rendered
+    if (entry && entry->complete) {
+        textCache.Release(shownEntry);
+        shownEntry = entry;
+    } else {
+        textCache.Release(entry);
+    }
+    entry = newEntry;
 
-    // Set the texture and scale of the underlying sprite
-    SetTexture(texture, true);
-    SetScale(scale);
+    SetSize(entry ? entry->bounds : glm::uvec2(1));
 }
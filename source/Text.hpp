@@ -2,28 +2,62 @@
 
 #include "Gfx.hpp"
 #include "Sprite.hpp"
+#include "GlyphAtlas.hpp"
+#include "TextCache.hpp"
 
 #include <string>
 
 class Text : public Sprite {
 public:
-    static void InitializeFont();
+    static void InitializeFont(Gfx* gfx);
     static void DeinitializeFont();
 
+    // Call after every presented frame to maintain the glyph cache and add glyphs rendered in the background
+    static void EndFrame();
+
 public:
     Text(std::string text, uint32_t textSize = 24, glm::vec2 pos = glm::vec2(), glm::vec2 scale = glm::vec2(1.0f), float angle = 0.0f, glm::vec4 color = glm::vec4(1.0f));
     virtual ~Text();
 
+    // Texts share their cache entry, copies would release it twice
+    Text(const Text&) = delete;
+    Text& operator=(const Text&) = delete;
+
     void SetText(std::string text);
 
     void SetTextSize(uint32_t textSize);
 
+    // Draw from distance fields, the text stays sharp at any size, scale and angle without rendering glyphs again.
+    // The edges are alpha tested, so they are aliased and the alpha of the color doesn't fade the text.
+    void SetSDF(bool sdf);
+
+    // Outline of distance field text, width is in pixels at the text size
+    void SetOutline(float width, glm::vec4 color = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+    virtual void Draw(Gfx* gfx) override;
+
+    static GlyphAtlas::Stats const& GetAtlasStats(bool sdf = false);
+
+    static TextCache::Stats const& GetCacheStats();
+
+    static GlyphRasterizer::Stats GetRasterizerStats();
+
 private:
-    void RedrawTexture();
+    GlyphAtlas& GetAtlas() const;
+
+    // Switch to the cache entry of the current text, size and mode
+    void UpdateEntry();
 
-    glm::uvec2 bounds;
-    Gfx::Texture* texture;
+    // Laid out glyphs, shared with all texts showing the same
+    TextCache::Entry* entry;
 
-    std::wstring text;
+    // Previous entry which is drawn until all glyphs of the current one are rendered
+    TextCache::Entry* shownEntry;
+
+    std::string text;
     uint32_t textSize;
+
+    bool sdf;
+    float outlineWidth;
+    glm::vec4 outlineColor;
 };
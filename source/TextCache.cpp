@@ -0,0 +1,212 @@
+#include "TextCache.hpp"
+
+#include <locale>
+#include <codecvt>
+
+#include <math.h>
+#include <string.h>
+
+static std::wstring ToWide(std::string const& text)
+{
+    // Convert the multi-byte string to a wstring
+    static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+    return converter.from_bytes(text);
+}
+
+TextCache::TextCache() :
+    finalized(false)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+TextCache::~TextCache()
+{
+    Finalize();
+}
+
+TextCache::Entry* TextCache::Acquire(std::string const& text, uint32_t textSize, GlyphAtlas* atlas, uint32_t glyphSize)
+{
+    // The atlas stands for the font, sizes come first so the string can contain anything
+    std::string key;
+    key.append((const char*) &atlas, sizeof(atlas));
+    key.append((const char*) &textSize, sizeof(textSize));
+    key.append((const char*) &glyphSize, sizeof(glyphSize));
+    key.append(text);
+
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        Entry* entry = it->second;
+        if (entry->refs++ == 0) {
+            unused.erase(entry->unusedIt);
+            stats.unused--;
+        }
+
+        stats.hits++;
+        return entry;
+    }
+
+    Entry* entry = new Entry();
+    entry->bounds = glm::uvec2(1);
+    entry->vertices = nullptr;
+    entry->numVertices = 0;
+    entry->key = key;
+    entry->text = ToWide(text);
+    entry->textSize = textSize;
+    entry->atlas = atlas;
+    entry->glyphSize = glyphSize;
+    entry->complete = false;
+    entry->generation = 0;
+    entry->revision = 0;
+    entry->refs = 1;
+
+    // Every character gets a quad at most, the string of an entry never changes
+    uint32_t capacity = entry->text.size() * 4;
+    if (capacity) {
+        entry->vertices = (Vertex*) Gfx::AllocVertices(capacity * sizeof(Vertex));
+        if (!entry->vertices) {
+            delete entry;
+            return nullptr;
+        }
+    }
+
+    Layout(entry);
+    entries[key] = entry;
+
+    stats.misses++;
+    stats.entries++;
+    return entry;
+}
+
+void TextCache::Release(Entry* entry)
+{
+    if (!entry || --entry->refs != 0) {
+        return;
+    }
+
+    // Nothing draws anymore once finalized
+    if (finalized) {
+        entries.erase(entry->key);
+        Gfx::FreeVertices(entry->vertices);
+        delete entry;
+        stats.entries--;
+        return;
+    }
+
+    unused.push_front(entry);
+    entry->unusedIt = unused.begin();
+    stats.unused++;
+
+    while (unused.size() > MAX_UNUSED) {
+        Drop(unused.back());
+    }
+}
+
+void TextCache::Update(Entry* entry)
+{
+    // Evictions and new glyphs only happen between frames, so no draw of this frame used the vertices yet
+    if (entry->generation != entry->atlas->GetGeneration() ||
+        (!entry->complete && entry->revision != entry->atlas->GetRevision())) {
+        Layout(entry);
+    }
+}
+
+void TextCache::EndFrame()
+{
+    for (void* vertices : retiredVertices) {
+        Gfx::FreeVertices(vertices);
+    }
+    retiredVertices.clear();
+}
+
+void TextCache::Finalize()
+{
+    while (!unused.empty()) {
+        Drop(unused.back());
+    }
+    EndFrame();
+
+    finalized = true;
+}
+
+TextCache::Stats const& TextCache::GetStats() const
+{
+    return stats;
+}
+
+void TextCache::Layout(Entry* entry)
+{
+    GlyphAtlas* atlas = entry->atlas;
+    const GlyphAtlas::Metrics metrics = atlas->GetMetrics(entry->textSize);
+    const float glyphScale = (float) entry->textSize / entry->glyphSize;
+
+    entry->generation = atlas->GetGeneration();
+    entry->revision = atlas->GetRevision();
+    stats.layouts++;
+
+    bool complete = true;
+
+    Vertex* vertices = entry->vertices;
+    uint32_t numVertices = 0;
+    glm::uvec2 bounds = glm::uvec2(0, metrics.lineHeight);
+
+    glm::vec2 pen = glm::vec2(0.0f, 0.0f);
+    for (const wchar_t charcode : entry->text) {
+        if (charcode == '\n') {
+            pen.x = 0.0f;
+            pen.y += metrics.lineHeight;
+            bounds.y += metrics.lineHeight;
+            continue;
+        }
+
+        const GlyphAtlas::Glyph* glyph = atlas->GetGlyph(charcode, entry->glyphSize);
+        if (!glyph) {
+            continue;
+        }
+
+        if (glyph->pending) {
+            complete = false;
+        } else if (glyph->size.x && glyph->size.y) {
+            // The baseline is one line height below the top of the line
+            glm::vec2 min = pen + glm::vec2(glyph->bearing) * glyphScale + glm::vec2(0.0f, metrics.lineHeight);
+            glm::vec2 max = min + glm::vec2(glyph->size) * glyphScale;
+            vertices[numVertices++] = { glm::vec2(min.x, min.y), glm::vec2(glyph->uvMin.x, glyph->uvMin.y) };
+            vertices[numVertices++] = { glm::vec2(max.x, min.y), glm::vec2(glyph->uvMax.x, glyph->uvMin.y) };
+            vertices[numVertices++] = { glm::vec2(max.x, max.y), glm::vec2(glyph->uvMax.x, glyph->uvMax.y) };
+            vertices[numVertices++] = { glm::vec2(min.x, max.y), glm::vec2(glyph->uvMin.x, glyph->uvMax.y) };
+        }
+
+        pen.x += glyph->advance * glyphScale;
+        bounds.x = glm::max(bounds.x, (uint32_t) ceilf(pen.x));
+    }
+
+    // Add some extra height for the bottom bearing
+    bounds.y += metrics.maxGlyphHeight;
+    bounds = glm::max(bounds, glm::uvec2(1));
+
+    // Positions are relative to the size of the sprite
+    for (uint32_t i = 0; i < numVertices; ++i) {
+        vertices[i].position /= glm::vec2(bounds);
+    }
+
+    if (numVertices) {
+        Gfx::FlushVertices(vertices, numVertices * sizeof(Vertex));
+    }
+
+    entry->bounds = bounds;
+    entry->numVertices = numVertices;
+    entry->complete = complete;
+}
+
+void TextCache::Drop(Entry* entry)
+{
+    unused.erase(entry->unusedIt);
+    entries.erase(entry->key);
+
+    if (entry->vertices) {
+        retiredVertices.push_back(entry->vertices);
+    }
+    delete entry;
+
+    stats.unused--;
+    stats.entries--;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Gfx.hpp"
+#include "GlyphAtlas.hpp"
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+// Shares the laid out glyph quads of texts with the same string, size and atlas.
+// Entries are reference counted by the texts showing them and keep their quads in GPU memory,
+// so identical texts draw from one vertex buffer without copying anything per frame.
+// Entries are complete once all glyphs were rendered, incomplete ones are laid out again whenever
+// the atlas received new glyphs. Unreferenced entries stay around for reuse, once there are more than MAX_UNUSED the least
+// recently used ones are dropped. Vertex buffers of dropped entries are freed after the frame.
+class TextCache {
+public:
+    static constexpr uint32_t MAX_UNUSED = 32;
+
+    struct Vertex {
+        glm::vec2 position;
+        glm::vec2 texCoord;
+    };
+
+    struct Entry {
+        glm::uvec2 bounds;
+        // One quad per visible glyph, normalized to the bounds
+        Vertex* vertices;
+        uint32_t numVertices;
+        GlyphAtlas* atlas;
+        // False while glyphs are still rendered in the background, bounds are always final
+        bool complete;
+
+    private:
+        friend TextCache;
+
+        std::string key;
+        std::wstring text;
+        uint32_t textSize;
+        // Size of the glyphs in the atlas, distance field glyphs are scaled to the text size
+        uint32_t glyphSize;
+        uint32_t generation;
+        uint32_t revision;
+        uint32_t refs;
+        std::list<Entry*>::iterator unusedIt;
+    };
+
+    struct Stats {
+        uint32_t entries;
+        uint32_t unused;
+        // Acquires which found an existing entry
+        uint32_t hits;
+        uint32_t misses;
+        // Layouts done, also counts the ones after an atlas eviction
+        uint32_t layouts;
+    };
+
+    TextCache();
+    virtual ~TextCache();
+
+    // Returns the entry of text in UTF-8 with one more reference, nullptr if out of memory
+    Entry* Acquire(std::string const& text, uint32_t textSize, GlyphAtlas* atlas, uint32_t glyphSize);
+
+    void Release(Entry* entry);
+
+    // Lay the entry out again if its glyphs were evicted, didn't fit or were rendered, call before drawing it
+    void Update(Entry* entry);
+
+    // Free the vertices of dropped entries, call once the frame was presented
+    void EndFrame();
+
+    // Drop all unused entries, entries still referenced are deleted on release
+    void Finalize();
+
+    Stats const& GetStats() const;
+
+private:
+    void Layout(Entry* entry);
+
+    void Drop(Entry* entry);
+
+    std::unordered_map<std::string, Entry*> entries;
+
+    // Front is the most recently released
+    std::list<Entry*> unused;
+
+    // The GPU might still read these in the current frame
+    std::vector<void*> retiredVertices;
+
+    bool finalized;
+    Stats stats;
+};
@@ -1,6 +1,5 @@
 #include "Utils.hpp"
 
-#include <stdlib.h>
 #include <coreinit/title.h>
 
 #define HBL_TITLE_ID 0x0005000013374842
@@ -17,8 +16,3 @@ bool RunningFromHBL()
         titleID == MII_MAKER_USA_TITLE_ID ||
         titleID == MII_MAKER_EUR_TITLE_ID;
 }
-
-float frand(float min, float max)
-{
-    return min + (float) rand() / ((float) RAND_MAX / (max - min));
-}
@@ -6,5 +6,3 @@
 #define COUNTOF(x) (sizeof(x) / sizeof(x[0]))
 
 bool RunningFromHBL();
-
-float frand(float min = 0.0f, float max = 1.0f);
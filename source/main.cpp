@@ -1,14 +1,58 @@
 #include <whb/proc.h>
 
 #include <coreinit/time.h>
+#include <coreinit/debug.h>
 #include <sndcore2/core.h>
 #include <nsysccr/cdc.h>
 #include <proc_ui/procui.h>
 #include <gx2/display.h>
 
+#include <sys/stat.h>
+
 #include "Gfx.hpp"
 #include "Text.hpp"
+#include "Sprite.hpp"
 #include "SceneMgr.hpp"
+#include "AssetLoader.hpp"
+#include "BootProfiler.hpp"
+#include "Input.hpp"
+#include "Random.hpp"
+#include "StatsReport.hpp"
+
+#include "assets_pak.h"
+
+// Everything the demo writes goes into this directory, it is created on startup
+#ifndef OUTPUT_DIR
+#define OUTPUT_DIR "fs:/vol/external01/MultiDRCSpaceDemo"
+#endif
+
+// A pack on the SD card replaces the embedded one
+#ifndef ASSET_PATH
+#define ASSET_PATH OUTPUT_DIR "/assets.pak"
+#endif
+
+// Define DIAGNOSTICS to write the startup timings and the steps of every run, and to capture all
+// screens into <prefix>_<number>_<target>.png when MINUS is pressed
+#ifdef DIAGNOSTICS
+#ifndef CAPTURE_PREFIX
+#define CAPTURE_PREFIX OUTPUT_DIR "/capture"
+#endif
+#ifndef BOOT_PROFILE_PATH
+#define BOOT_PROFILE_PATH OUTPUT_DIR "/boot_profile.txt"
+#endif
+#ifndef INPUT_LOG_PATH
+#define INPUT_LOG_PATH OUTPUT_DIR "/input.log"
+#endif
+#endif
+
+// Frames between two reports of the renderer and cache counters, 0 disables them
+#ifndef STATS_REPORT_FRAMES
+#ifdef DIAGNOSTICS
+#define STATS_REPORT_FRAMES (60 * 10)
+#else
+#define STATS_REPORT_FRAMES 0
+#endif
+#endif
 
 static uint32_t OnForegroundAcquired(void* arg)
 {
@@ -32,11 +76,37 @@ static uint32_t OnForegroundReleased(void* arg)
 
 int main(int argc, char const* argv[])
 {
+    // Time everything until the first frame is shown
+    BootProfiler::Begin("Boot");
+
     // Initialize ProcUI
+    BootProfiler::Begin("WHBProcInit");
     WHBProcInit();
+    BootProfiler::End();
+
+    // Fails with EEXIST after the first run
+    mkdir(OUTPUT_DIR, 0777);
+
+    // Seed all random streams, a fixed seed makes matches repeatable
+#ifdef RANDOM_SEED
+    Random::SetSeed(RANDOM_SEED);
+#else
+    Random::SetSeed(OSGetTick());
+#endif
+
+    // Replay a recorded match instead of reading the GamePads, with the same seed
+#ifdef INPUT_REPLAY_PATH
+    if (Input::StartReplay(INPUT_REPLAY_PATH)) {
+        Random::SetSeed(Input::GetReplaySeed());
+    } else {
+        OSReport("Failed to open the replay\n");
+    }
+#endif
 
-    // Seed rand, used throughout the application
-    srand(OSGetTick());
+    // Record the steps so the match can be replayed
+#ifdef INPUT_LOG_PATH
+    Input::StartRecording(Random::GetSeed(), SceneMgr::STEP_RATE);
+#endif
 
     // We'll need to call the CCR* functions while still in foreground so setup callbacks
     ProcUIRegisterCallback(PROCUI_CALLBACK_ACQUIRE, OnForegroundAcquired, nullptr, 100);
@@ -46,21 +116,74 @@ int main(int argc, char const* argv[])
     OnForegroundAcquired(nullptr);
 
     // Initialize graphics
+    BootProfiler::Begin("Gfx::Initialize");
     Gfx gfx;
     gfx.Initialize();
+    BootProfiler::End();
 
     // Initialize AX to stop current sound from playing
+    BootProfiler::Begin("AXInit");
     AXInit();
+    BootProfiler::End();
+
+    // Stream assets from storage, falling back to the ones embedded into the executable
+    BootProfiler::Begin("Load assets");
+    AssetLoader assetLoader;
+    assetLoader.Initialize();
+
+    // The scenes need the textures right away
+    AssetLoader::Request* assetPack = assetLoader.Load(ASSET_PATH, AssetLoader::PRIORITY_HIGH, assets_pak, assets_pak_size);
+    assetLoader.Wait(assetPack);
+
+    // A pack from storage might be from an older build
+    if (!Sprite::OpenAssets(assetPack->GetData(), assetPack->GetSize()) && !Sprite::OpenAssets(assets_pak, assets_pak_size)) {
+        OSReport("Failed to open the asset pack\n");
+    }
+    BootProfiler::End();
 
     // Initialize font rendering
-    Text::InitializeFont();
+    BootProfiler::Begin("Text::InitializeFont");
+    Text::InitializeFont(&gfx);
+    BootProfiler::End();
 
     // Create the scene manager
+    BootProfiler::Begin("SceneMgr");
     SceneMgr sceneMgr;
+    BootProfiler::End();
+
+    BootProfiler::Begin("First frame");
 
+    StatsReport::SetInterval(STATS_REPORT_FRAMES);
+
+    OSTime lastFlip = 0;
     while (WHBProcIsRunning()) {
-        // Update scene
-        sceneMgr.Update();
+        // Sample the GamePads for the steps of this frame
+        Input::Update();
+
+#ifdef DIAGNOSTICS
+        VPADStatus status{};
+        Input::ReadFrame(VPAD_CHAN_0, &status);
+
+        // Capture all screens of this frame when MINUS is pressed, once even if no step runs this frame
+        if (status.trigger & VPAD_BUTTON_MINUS) {
+            if (!gfx.RequestCapture(CAPTURE_PREFIX)) {
+                OSReport("Failed to capture the frame\n");
+            }
+        }
+
+        // Toggle the overdraw heatmap when the right stick is pressed, it also aims the ship
+        if (status.trigger & VPAD_BUTTON_STICK_R) {
+            if (!gfx.SetOverdrawMode(!gfx.IsOverdrawMode())) {
+                OSReport("Failed to enable the overdraw mode\n");
+            }
+        }
+#endif
+
+        // Simulate the time between the last two frames, the first frames run a single step
+        OSTime flip = gfx.GetLastFlipTime();
+        OSTime elapsed = lastFlip ? flip - lastFlip : OSSecondsToTicks(1) / SceneMgr::STEP_RATE;
+        lastFlip = flip;
+        sceneMgr.Advance(elapsed);
 
         // Draw TV
         gfx.BeginDraw(Gfx::TARGET_TV);
@@ -81,11 +204,40 @@ int main(int argc, char const* argv[])
 
         // Swap buffers
         gfx.SwapBuffers();
+
+        // The first frame is on screen, boot is done
+        if (BootProfiler::IsRecording()) {
+            BootProfiler::Finish();
+            BootProfiler::Report();
+#ifdef BOOT_PROFILE_PATH
+            if (!BootProfiler::Save(BOOT_PROFILE_PATH)) {
+                OSReport("Failed to save the boot profile\n");
+            }
+#endif
+        }
+
+        // Print the counters every few seconds
+        StatsReport::Update(&gfx, &assetLoader);
+
+        // Evict cached glyphs once the frame using them is done
+        Text::EndFrame();
     }
 
+    // Save the steps of this run
+#ifdef INPUT_LOG_PATH
+    if (!Input::SaveRecording(INPUT_LOG_PATH)) {
+        OSReport("Failed to save the input log\n");
+    }
+#endif
+
     // Deinit font rendering
     Text::DeinitializeFont();
 
+    // Release the asset pack textures
+    Sprite::CloseAssets();
+    assetLoader.Release(assetPack);
+    assetLoader.Finalize();
+
     // Deinit AX
     AXQuit();
 